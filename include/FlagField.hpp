@@ -69,10 +69,13 @@
 // #define FLAGFIELD_DEBUG
 // #define FLAGFIELD_NO_VALIDATE
 
+#include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <array>
 #include <stdexcept>
 #include <ostream>
+#include <type_traits>
 
 #ifndef FLAGFIELD_DEBUG
 #define FF_DEBUG(msg)
@@ -80,19 +83,80 @@
 #define FF_DEBUG(msg) std::cout << "[FlagField]: " << msg << std::endl
 #endif
 
-#ifdef FLAGFIELD_NO_VALIDATE
-#define FF_VD(idx, ret)
-#elif !defined(FLAGFIELD_DEBUG)
-#define FF_VD(idx, ret)                         \
-if (idx >= MAX) { return ret; }
+#if defined(__GNUC__) || defined(__clang__)
+#define FF_LIKELY(x) __builtin_expect(!!(x), 1)
+#define FF_UNLIKELY(x) __builtin_expect(!!(x), 0)
 #else
-#define FF_VD(idx, ret)                         \
-if (idx >= MAX) { throw std::out_of_range(      \
-    "[FlagField] - ERROR: Index out of range!");\
-    return ret;                                 \
+#define FF_LIKELY(x) (x)
+#define FF_UNLIKELY(x) (x)
+#endif
+
+/// @brief Inlines a kernel the compiler would otherwise call, spilling its running sums.
+#if defined(__GNUC__) || defined(__clang__)
+#define FF_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FF_FORCE_INLINE __forceinline
+#else
+#define FF_FORCE_INLINE inline
+#endif
+
+/// @brief Validates an index with the FlagField's `Check` policy.
+#define FF_VD(idx, ret)                                 \
+if (FF_UNLIKELY(!Check::valid((size_t)(idx), MAX))) {   \
+    return ret;                                         \
 }
+
+#if defined(_MSC_VER) || \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define FF_LITTLE_ENDIAN
 #endif
 
+/// @brief Index validation policies for the `Check` parameter of a FlagField.
+/// @note Every policy has the same layout, so FlagFields only differing by
+/// policy convert with a byte copy, implicitly or with `as<Policy>()`.
+namespace FlagCheck {
+    /// @brief No validation. Out of range indices are undefined behavior.
+    struct Unchecked {
+        static constexpr bool valid(const size_t&, const size_t&) { return true; }
+    };
+
+    /// @brief Out of range indices are silently ignored.
+    struct Ignore {
+        static constexpr bool valid(const size_t& idx, const size_t& max) { return idx < max; }
+    };
+
+    /// @brief Out of range indices fail an `assert()`, unchecked when `NDEBUG` is defined.
+    struct Assert {
+        static bool valid(const size_t& idx, const size_t& max) {
+            assert(idx < max && "[FlagField] - ERROR: Index out of range!");
+            (void)idx; (void)max;
+            return true;
+        }
+    };
+
+    /// @brief Out of range indices throw `std::out_of_range`.
+    struct Throw {
+        static bool valid(const size_t& idx, const size_t& max) {
+            if (FF_UNLIKELY(idx >= max)) {
+                throw std::out_of_range("[FlagField] - ERROR: Index out of range!");
+            }
+            return true;
+        }
+    };
+
+    /// @brief The policy used when none is given.
+    /// @note Selected by `FLAGFIELD_NO_VALIDATE` (`Unchecked`), `FLAGFIELD_DEBUG` (`Throw`)
+    /// or neither (`Ignore`). Name a policy explicitly to avoid translation units
+    /// disagreeing on the default.
+#if defined(FLAGFIELD_NO_VALIDATE)
+    using Default = Unchecked;
+#elif defined(FLAGFIELD_DEBUG)
+    using Default = Throw;
+#else
+    using Default = Ignore;
+#endif
+}
+
 /// @brief A class to manage a field of flags.
 /// @note FlagFields can be created in reference to enums that define flag indices.
 /// @note Example usage: 
@@ -109,7 +173,8 @@ if (idx >= MAX) { throw std::out_of_range(      \
 /// ```
 /// @tparam MAX The maximum number of flags to manage. Default = `8`.
 /// @tparam E The enum to set as a reference. Default = `size_t`.
-template <size_t MAX = 8, class E = size_t>
+/// @tparam Check The index validation policy. Default = `FlagCheck::Default`.
+template <size_t MAX = 8, class E = size_t, class Check = FlagCheck::Default>
 class FlagField {
     static_assert(std::is_enum<E>::value || std::is_same<E, size_t>::value,
         "[FlagField] - ERROR: FlagField must use an enum or size_t type!");
@@ -118,13 +183,17 @@ class FlagField {
     static_assert(MAX > 0, "[FlagField] - ERROR: Number of managed flags must be > 0!");
 public:
 /// @section Constructors and Deconstructors
+#ifdef FLAGFIELD_DEBUG
     /// @brief Copy constructor. 
     FlagField(const FlagField& other) {
         FF_DEBUG("Creating FlagField from another FlagField both with size: " << size());
-        // Initialize flags array to zero
-        clear_();
-        set_(other);
+        std::memcpy(flags_, other.flags_, sizeof(flags_));
     }
+#else
+    /// @brief Copy constructor.
+    /// @note Trivial, so FlagFields can be copied and relocated with `memcpy`.
+    FlagField(const FlagField& other) = default;
+#endif
 
     /// @brief Explicit single flag constructor. 
     explicit FlagField(const size_t& idx) {
@@ -152,10 +221,22 @@ public:
         clear_(); 
     }
 
+    /// @brief Copy constructor from a FlagField with another validation policy.
+    template <class P>
+    FlagField(const FlagField<MAX, E, P>& other) {
+        FF_DEBUG("Creating FlagField from another FlagField with a different policy.");
+        std::memcpy(flags_, other.flags_, sizeof(flags_));
+    }
+
+#ifdef FLAGFIELD_DEBUG
     /// @brief Deconstructor.
     ~FlagField() { 
         FF_DEBUG("Deconstructing FlagField with size: " << size());
     }
+#else
+    /// @brief Deconstructor.
+    ~FlagField() = default;
+#endif
 
 /// @section Accessors
 
@@ -279,13 +360,7 @@ public:
     /// @brief Returns `true` if no flags match.
     bool isNSet(const FlagField& other) const {
         FF_DEBUG("Checking if no flags match.");
-        const uint8_t mask = (1 << size() % 8) - 1;
-        for (size_t i = 0; i < sizeBytes() - (size() % 8 > 0); i++) {
-            if ((flags_[i] & other.flags_[i]) != 0) return false;
-        }
-        return (flags_[sizeBytes() - 1] & 
-            other.flags_[sizeBytes() - 1] &
-            mask) == 0;
+        return isNSet_(other);
     }
 
     /// @brief Returns `true` if no flags at the given indices are set.
@@ -314,6 +389,89 @@ public:
         return count += countBits_(flags_[sizeBytes() - 1] & mask);
     }
 
+/// @subsection Validation Policy Functions
+
+    /// @brief Copies this FlagField under another validation policy.
+    /// @note Useful for validating indices once, then running a hot loop on `as<FlagCheck::Unchecked>()`.
+    /// The copy is a plain byte copy; the two types are distinct, so neither may alias the other.
+    template <class P>
+    FlagField<MAX, E, P> as() const {
+        return FlagField<MAX, E, P>(*this);
+    }
+
+    /// @brief Returns `true` if the index is in range.
+    static constexpr bool inRange(const size_t& idx) { return idx < MAX; }
+
+/// @subsection Word Access Functions
+
+    /// @brief Gets the number of 64 bit words spanned by the managed flags.
+    static constexpr size_t numWords() { return (MAX + 63) / 64; }
+
+    /// @brief Gets the 64 flags starting at index `64 * w` as a word.
+    /// @note Bits past the last managed flag are always returned as 0.
+    uint64_t word(const size_t& w) const {
+        FF_VD(w * 64, 0);
+        return getWord_(w);
+    }
+
+    /// @brief Sets the 64 flags starting at index `64 * w` from a word.
+    /// @note Bits past the last managed flag are ignored.
+    void setWord(const size_t& w, const uint64_t& bits) {
+        FF_VD(w * 64,);
+        FF_DEBUG("Set word at index: " << w);
+        setWord_(w, bits);
+    }
+
+/// @subsection Slicing and Resizing Functions
+
+    /// @brief Makes a new FlagField from `Len` flags starting at index `Offset`.
+    template <size_t Offset, size_t Len>
+    FlagField<Len, size_t, Check> slice() const {
+        static_assert(Len > 0 && Offset + Len <= MAX,
+            "[FlagField] - ERROR: Slice is out of range!");
+        FF_DEBUG("Slicing " << Len << " flags starting at index: " << Offset);
+        FlagField<Len, size_t, Check> x;
+        x.extract_(*this, Offset);
+        return x;
+    }
+
+    /// @brief Makes a new FlagField from `len` flags starting at index `offset`.
+    /// @note The sliced flags are moved to index 0, every other flag is cleared.
+    FlagField slice(const size_t& offset, const size_t& len) const {
+        FlagField x;
+        if (len == 0) return x;
+        FF_VD(offset + len - 1, x);
+        FF_DEBUG("Slicing " << len << " flags starting at index: " << offset);
+        x.extract_(*this, offset);
+        for (size_t w = len / 64; w < numWords(); w++) {
+            const size_t keep = (w == len / 64) ? len % 64 : 0;
+            x.setWord_(w, x.getWord_(w) & ((uint64_t(1) << keep) - 1));
+        }
+        return x;
+    }
+
+    /// @brief Makes a new FlagField with `N` flags and the same enum type.
+    /// @note Flags past `N` are dropped, new flags are cleared.
+    template <size_t N>
+    FlagField<N, E, Check> resize() const {
+        FF_DEBUG("Resizing from " << size() << " to " << N << " flags.");
+        FlagField<N, E, Check> x;
+        x.extract_(*this, 0);
+        return x;
+    }
+
+    /// @brief Overwrites the flags starting at index `offset` with another FlagField.
+    template <size_t M, class X, class P>
+    FlagField& insertAt(const size_t& offset, const FlagField<M, X, P>& other) {
+        FF_VD(offset + M - 1, *this);
+        FF_DEBUG("Inserting " << M << " flags at index: " << offset);
+        for (size_t w = 0; w < other.numWords(); w++) {
+            const size_t n = (M - w * 64 < 64) ? M - w * 64 : 64;
+            writeBits_(offset + w * 64, other.getWord_(w), n);
+        }
+        return *this;
+    }
+
 /// @section Operator Overloads
 
 /// @subsection Unary Operators
@@ -431,33 +589,33 @@ public:
         FF_DEBUG("!= " << idx);
         return isNSet_(idx); 
     }
-    /// @brief Returns `true` if every set flag in other is not set.
+    /// @brief Returns `true` if any set flag in other is not set.
     bool operator!=(const FlagField& other) const { 
         FF_DEBUG("!= other");
-        return isNSet_(other); 
+        return !isSet_(other); 
     }
 
     /// @brief Compares the number of set flags.
-    template <size_t M, class X> 
-    bool operator< (const FlagField<M, X>& other) const { 
+    template <size_t M, class X, class P> 
+    bool operator< (const FlagField<M, X, P>& other) const { 
         FF_DEBUG("< other");
         return numSetFlags() <  other.numSetFlags(); 
     }
     /// @brief Compares the number of set flags.
-    template <size_t M, class X> 
-    bool operator<=(const FlagField<M, X>& other) const { 
+    template <size_t M, class X, class P> 
+    bool operator<=(const FlagField<M, X, P>& other) const { 
         FF_DEBUG("<= other");
         return numSetFlags() <= other.numSetFlags(); 
     }
     /// @brief Compares the number of set flags.
-    template <size_t M, class X> 
-    bool operator> (const FlagField<M, X>& other) const { 
+    template <size_t M, class X, class P> 
+    bool operator> (const FlagField<M, X, P>& other) const { 
         FF_DEBUG("> other");
         return numSetFlags() > other.numSetFlags(); 
     }
     /// @brief Compares the number of set flags.
-    template <size_t M, class X> 
-    bool operator>=(const FlagField<M, X>& other) const { 
+    template <size_t M, class X, class P> 
+    bool operator>=(const FlagField<M, X, P>& other) const { 
         FF_DEBUG(">= other");
         return numSetFlags() >= other.numSetFlags(); 
     }
@@ -573,15 +731,18 @@ public:
         set_(idx);
         return *this;
     }
+#ifdef FLAGFIELD_DEBUG
     /// @brief Sets the flags from another FlagField.
     FlagField& operator=(const FlagField& other) {
         FF_DEBUG("= other");
-        if (this != &other) {
-            clear_();
-            set_(other);
-        }
+        std::memmove(flags_, other.flags_, sizeof(flags_));
         return *this;
     }
+#else
+    /// @brief Sets the flags from another FlagField.
+    /// @note Trivial, so FlagFields can be copied and relocated with `memcpy`.
+    FlagField& operator=(const FlagField& other) = default;
+#endif
 
     /// @brief Sets this FlagField from a bytefield.
     /// @note Only converts up to 8 flags.
@@ -751,9 +912,83 @@ public:
     
 /// @section Private Members
 private:
+    template <size_t, class, class> friend class FlagField;
+
     /// @brief An array of flags on the stack.
     uint8_t flags_[(MAX + 7) / 8];
 
+    /// @brief Gets a mask of the managed bits in word `w`.
+    static constexpr uint64_t wordMask_(const size_t& w) {
+        return (w + 1 < numWords() || MAX % 64 == 0) ? ~uint64_t(0) :
+            (uint64_t(1) << (MAX % 64)) - 1;
+    }
+
+    /// @brief Loads word `w` from the flag byte array.
+    uint64_t getWord_(const size_t& w) const {
+        const size_t first = w * 8;
+        uint64_t v = 0;
+#ifdef FF_LITTLE_ENDIAN
+        // FlagFields under 8 bytes never take the whole word path
+        if constexpr ((MAX + 7) / 8 >= 8) {
+            if (first + 8 <= sizeBytes()) {
+                std::memcpy(&v, &flags_[first], 8);
+                return v & wordMask_(w);
+            }
+        }
+#endif
+        for (size_t b = 0; b < 8 && first + b < sizeBytes(); b++) {
+            v |= uint64_t(flags_[first + b]) << (8 * b);
+        }
+        return v & wordMask_(w);
+    }
+
+    /// @brief Stores word `w` into the flag byte array.
+    void setWord_(const size_t& w, uint64_t v) {
+        const size_t first = w * 8;
+        v &= wordMask_(w);
+#ifdef FF_LITTLE_ENDIAN
+        if constexpr ((MAX + 7) / 8 >= 8) {
+            if (first + 8 <= sizeBytes()) {
+                std::memcpy(&flags_[first], &v, 8);
+                return;
+            }
+        }
+#endif
+        for (size_t b = 0; b < 8 && first + b < sizeBytes(); b++) {
+            flags_[first + b] = uint8_t(v >> (8 * b));
+        }
+    }
+
+    /// @brief Reads 64 flags starting at any index with a funnel shift.
+    /// @note Flags past the last managed flag are read as 0.
+    uint64_t readBits_(const size_t& pos) const {
+        const size_t w = pos / 64, s = pos % 64;
+        if (w >= numWords()) return 0;
+        uint64_t v = getWord_(w) >> s;
+        if (s != 0 && w + 1 < numWords()) v |= getWord_(w + 1) << (64 - s);
+        return v;
+    }
+
+    /// @brief Writes the low `n` bits of `v` to the flags starting at `pos`.
+    /// @warning `pos + n` must not exceed the number of managed flags.
+    void writeBits_(const size_t& pos, uint64_t v, const size_t& n) {
+        const uint64_t m = (n >= 64) ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+        const size_t w = pos / 64, s = pos % 64;
+        v &= m;
+        setWord_(w, (getWord_(w) & ~(m << s)) | (v << s));
+        if (s != 0 && s + n > 64) {
+            setWord_(w + 1, (getWord_(w + 1) & ~(m >> (64 - s))) | (v >> (64 - s)));
+        }
+    }
+
+    /// @brief Overwrites every flag with the flags of `src` starting at `offset`.
+    template <size_t M, class X, class P>
+    void extract_(const FlagField<M, X, P>& src, const size_t& offset) {
+        for (size_t w = 0; w < numWords(); w++) {
+            setWord_(w, src.readBits_(offset + w * 64));
+        }
+    }
+
     /// @brief Counts the number of 1s in a byte.
     int countBits_(uint8_t byte) const {
         int count = 0;
@@ -847,8 +1082,35 @@ private:
         }
         return true;
     }
+
+    /// @brief Checks if a flag is not set
+    bool isNSet_(const E& idx) const {
+        return !isSet_(idx);
+    }
+
+    /// @brief Checks if every set flag in other is not set in this
+    bool isNSet_(const FlagField& other) const {
+        const uint8_t mask = (1 << size() % 8) - 1;
+        for (size_t i = 0; i < sizeBytes() - (size() % 8 > 0); i++) {
+            if ((flags_[i] & other.flags_[i]) != 0) return false;
+        }
+        return (flags_[sizeBytes() - 1] & 
+            other.flags_[sizeBytes() - 1] &
+            mask) == 0;
+    }
 };
 
 /// @section FlagField Related Functions
 
+/// @brief Makes a new FlagField with the flags of `a` followed by the flags of `b`.
+template <size_t M1, class E1, class P1, size_t M2, class E2, class P2>
+FlagField<M1 + M2, size_t, P1> concat(const FlagField<M1, E1, P1>& a,
+                                      const FlagField<M2, E2, P2>& b) {
+    FF_DEBUG("Concatenating FlagFields with sizes: " << M1 << " and " << M2);
+    FlagField<M1 + M2, size_t, P1> x;
+    x.insertAt(0, a);
+    x.insertAt(M1, b);
+    return x;
+}
+
 #endif // FLAGFIELD_HPP
\ No newline at end of file
@@ -0,0 +1,199 @@
+/**
+ * @file FlagFieldBitmap.hpp
+ * @author Ray Richter
+ * @brief Word kernels shared by the vertical bitmap algorithms.
+ * @details The co-occurrence and itemset miners store one bitmap column per
+ * flag, with bit `r` of column `i` holding flag `i` of row `r`. This header
+ * has the kernels they share:
+ * - `transpose()` turns an array of FlagFields into columns, 64 rows at a
+ *   time with 64 x 64 bit transposes.
+ * - `andCount()` counts the bits set in both of two columns with a
+ *   Harley-Seal tree of carry-save adders, so only one popcount is needed
+ *   per 16 vectors. Vectors are AVX2 registers with `__AVX2__`, SSE2
+ *   registers with `__SSE2__` and words otherwise.
+ * - `harleySeal16()` is that adder tree on its own, for any vector `csa()`
+ *   takes. The histogram and vote counters build on it too.
+ */
+#pragma once
+#ifndef FLAGFIELDBITMAP_HPP
+#define FLAGFIELDBITMAP_HPP
+
+#include <FlagField.hpp>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/// @brief Static kernels over bitmap columns.
+struct FlagBitmap {
+/// @section Counting Functions
+
+    /// @brief Counts the bits set in a word.
+    static uint64_t popcount(uint64_t x) {
+#if defined(__POPCNT__) || ((defined(__GNUC__) || defined(__clang__)) && !defined(__x86_64__) && !defined(__i386__))
+        return uint64_t(__builtin_popcountll(x));
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (x * 0x0101010101010101ULL) >> 56;
+#endif
+    }
+
+    /// @brief Counts the bits set in both `a` and `b` over `words` words.
+    static uint64_t andCount(const uint64_t* a, const uint64_t* b, const size_t& words) {
+        V_ total = zero_(), ones = zero_(), twos = zero_(), fours = zero_(), eights = zero_();
+        size_t w = 0;
+        for (; w + 16 * step_ <= words; w += 16 * step_) {
+            auto in = [&](const size_t& k) { return and_(load_(a + w + k * step_), load_(b + w + k * step_)); };
+            total = add_(total, count_(harleySeal16(ones, twos, fours, eights, in)));
+        }
+        uint64_t c = 16 * sum_(total) + 8 * sum_(count_(eights)) + 4 * sum_(count_(fours)) +
+                     2 * sum_(count_(twos)) + sum_(count_(ones));
+        for (; w < words; w++) c += popcount(a[w] & b[w]);
+        return c;
+    }
+
+/// @section Adder Functions
+
+    /// @brief Carry-save adder: `high:low = a + b + c` bitwise.
+    FF_FORCE_INLINE static void csa(uint64_t& high, uint64_t& low, const uint64_t& a, const uint64_t& b, const uint64_t& c) {
+        const uint64_t u = a ^ b;
+        high = (a & b) | (u & c);
+        low = u ^ c;
+    }
+#if defined(__AVX2__) || defined(__SSE2__)
+    FF_FORCE_INLINE static void csa(__m128i& high, __m128i& low, const __m128i& a, const __m128i& b, const __m128i& c) {
+        const __m128i u = _mm_xor_si128(a, b);
+        high = _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(u, c));
+        low = _mm_xor_si128(u, c);
+    }
+#endif
+#ifdef __AVX2__
+    FF_FORCE_INLINE static void csa(__m256i& high, __m256i& low, const __m256i& a, const __m256i& b, const __m256i& c) {
+        const __m256i u = _mm256_xor_si256(a, b);
+        high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+        low = _mm256_xor_si256(u, c);
+    }
+#endif
+
+    /// @brief Adds 16 vectors into running `ones`, `twos`, `fours` and `eights` with a Harley-Seal
+    /// tree of carry-save adders.
+    /// @param in Gets input `k` of the 16.
+    /// @return The sixteens carried out of `eights`.
+    template <class V, class In>
+    FF_FORCE_INLINE static V harleySeal16(V& ones, V& twos, V& fours, V& eights, const In& in) {
+        V twosA, twosB, foursA, foursB, eightsA, eightsB, sixteens;
+        csa(twosA, ones, ones, in(0), in(1));
+        csa(twosB, ones, ones, in(2), in(3));
+        csa(foursA, twos, twos, twosA, twosB);
+        csa(twosA, ones, ones, in(4), in(5));
+        csa(twosB, ones, ones, in(6), in(7));
+        csa(foursB, twos, twos, twosA, twosB);
+        csa(eightsA, fours, fours, foursA, foursB);
+        csa(twosA, ones, ones, in(8), in(9));
+        csa(twosB, ones, ones, in(10), in(11));
+        csa(foursA, twos, twos, twosA, twosB);
+        csa(twosA, ones, ones, in(12), in(13));
+        csa(twosB, ones, ones, in(14), in(15));
+        csa(foursB, twos, twos, twosA, twosB);
+        csa(eightsB, fours, fours, foursA, foursB);
+        csa(sixteens, eights, eights, eightsA, eightsB);
+        return sixteens;
+    }
+
+/// @section Transposing Functions
+
+    /// @brief Transposes rows `[0, n)` into `MAX` columns `stride` words apart.
+    /// @note Writes `(n + 63) / 64` words per column. Bits past `n` are 0.
+    template <size_t MAX, class E, class P>
+    static void transpose(const FlagField<MAX, E, P>* rows, const size_t& n, uint64_t* columns,
+                          const size_t& stride) {
+        using Row = FlagField<MAX, E, P>;
+        uint64_t a[64];
+        for (size_t g = 0; g < (n + 63) / 64; g++) {
+            const size_t m = n - g * 64 < 64 ? n - g * 64 : 64;
+            for (size_t w = 0; w < Row::numWords(); w++) {
+                for (size_t r = 0; r < 64; r++) a[r] = r < m ? rows[g * 64 + r].word(w) : 0;
+                transpose64(a);
+                for (size_t c = 0; c < 64 && w * 64 + c < MAX; c++) columns[(w * 64 + c) * stride + g] = a[c];
+            }
+        }
+    }
+
+    /// @brief Transposes a 64 x 64 bit matrix in place: bit `c` of `a[r]` moves to bit `r` of `a[c]`.
+    static void transpose64(uint64_t* a) {
+        swapBlocks_<32>(a, 0x00000000FFFFFFFFULL);
+        swapBlocks_<16>(a, 0x0000FFFF0000FFFFULL);
+        swapBlocks_<8>(a, 0x00FF00FF00FF00FFULL);
+        swapBlocks_<4>(a, 0x0F0F0F0F0F0F0F0FULL);
+        swapBlocks_<2>(a, 0x3333333333333333ULL);
+        swapBlocks_<1>(a, 0x5555555555555555ULL);
+    }
+
+/// @section Private Members
+private:
+#ifdef __AVX2__
+    using V_ = __m256i;
+    static constexpr size_t step_ = 4;
+    static V_ load_(const uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const V_*>(p)); }
+    static V_ and_(const V_& a, const V_& b) { return _mm256_and_si256(a, b); }
+    static V_ zero_() { return _mm256_setzero_si256(); }
+    /// @brief Per 64 bit lane popcounts (nibble lookup and byte sums).
+    static V_ count_(const V_& v) {
+        const V_ table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const V_ low = _mm256_set1_epi8(0x0F);
+        const V_ c = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+                                     _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        return _mm256_sad_epu8(c, _mm256_setzero_si256());
+    }
+    static V_ add_(const V_& a, const V_& b) { return _mm256_add_epi64(a, b); }
+    static uint64_t sum_(const V_& v) {
+        alignas(32) uint64_t w[4];
+        _mm256_store_si256(reinterpret_cast<V_*>(w), v);
+        return w[0] + w[1] + w[2] + w[3];
+    }
+#elif defined(__SSE2__)
+    using V_ = __m128i;
+    static constexpr size_t step_ = 2;
+    static V_ load_(const uint64_t* p) { return _mm_loadu_si128(reinterpret_cast<const V_*>(p)); }
+    static V_ and_(const V_& a, const V_& b) { return _mm_and_si128(a, b); }
+    static V_ zero_() { return _mm_setzero_si128(); }
+    /// @brief Per 64 bit lane popcounts (SWAR bit sums and byte sums).
+    static V_ count_(V_ v) {
+        v = _mm_sub_epi64(v, _mm_and_si128(_mm_srli_epi64(v, 1), _mm_set1_epi8(0x55)));
+        v = _mm_add_epi64(_mm_and_si128(v, _mm_set1_epi8(0x33)),
+                          _mm_and_si128(_mm_srli_epi64(v, 2), _mm_set1_epi8(0x33)));
+        v = _mm_and_si128(_mm_add_epi64(v, _mm_srli_epi64(v, 4)), _mm_set1_epi8(0x0F));
+        return _mm_sad_epu8(v, _mm_setzero_si128());
+    }
+    static V_ add_(const V_& a, const V_& b) { return _mm_add_epi64(a, b); }
+    static uint64_t sum_(const V_& v) {
+        return uint64_t(_mm_cvtsi128_si64(v)) + uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v)));
+    }
+#else
+    using V_ = uint64_t;
+    static constexpr size_t step_ = 1;
+    static V_ load_(const uint64_t* p) { return *p; }
+    static V_ and_(const V_& a, const V_& b) { return a & b; }
+    static V_ zero_() { return 0; }
+    static V_ count_(const V_& v) { return popcount(v); }
+    static V_ add_(const V_& a, const V_& b) { return a + b; }
+    static uint64_t sum_(const V_& v) { return v; }
+#endif
+
+    /// @brief Swaps the off diagonal `J x J` blocks of every `2J x 2J` block.
+    template <size_t J>
+    static void swapBlocks_(uint64_t* a, const uint64_t& m) {
+        for (size_t k = 0; k < 64; k += 2 * J) {
+            for (size_t l = k; l < k + J; l++) {
+                const uint64_t t = ((a[l] >> J) ^ a[l + J]) & m;
+                a[l] ^= t << J;
+                a[l + J] ^= t;
+            }
+        }
+    }
+};
+
+#endif // FLAGFIELDBITMAP_HPP
@@ -0,0 +1,179 @@
+/**
+ * @file FlagFieldClosure.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagClosure class.
+ * @details A reachability matrix with a FlagField row per node, closed with a
+ * blocked bit-parallel Warshall (`if (row_i[k]) row_i |= row_k`).
+ *
+ * Nodes are processed in blocks of 64, one row word:
+ * - The block's own rows are closed first, so each of them already holds
+ *   everything reachable through the block.
+ * - Each group of 4 block rows is combined into a 16 entry table of ORs, so
+ *   any other row takes at most 16 row ORs per block instead of 64, and rows
+ *   that reach nothing in the block are skipped after a single word test.
+ * - Rows are updated a tile of columns at a time so the tables stay in cache,
+ *   and split across a FlagThreadPool.
+ */
+#pragma once
+#ifndef FLAGFIELDCLOSURE_HPP
+#define FLAGFIELDCLOSURE_HPP
+
+#include <FlagFieldVector.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <utility>
+#include <vector>
+
+/// @brief The transitive closure of a directed graph of up to `N` nodes.
+/// @note Example usage:
+/// ```
+/// FlagClosure<4096> deps(numTargets);
+/// deps.addEdge(app, lib);
+/// deps.addEdge(lib, zlib);
+/// deps.close();
+/// if (deps.reaches(app, zlib)) {}
+/// deps.addEdge(zlib, crc); // Keeps the closure up to date
+/// ```
+/// @tparam N The maximum number of nodes.
+template <size_t N>
+class FlagClosure {
+public:
+    using Row = FlagField<N, size_t, FlagCheck::Unchecked>;
+
+/// @section Constructors
+
+    /// @brief Constructs a graph of `numNodes` nodes and no edges.
+    explicit FlagClosure(const size_t& numNodes = N)
+        : n_(numNodes < N ? numNodes : N), rows_(n_) {}
+
+/// @section Graph Functions
+
+    /// @brief Adds an edge from `u` to `v`.
+    /// @note Once closed, the closure is updated for the new edge right away.
+    void addEdge(const size_t& u, const size_t& v) {
+        if (!closed_) {
+            rows_[u].set(v);
+            return;
+        }
+        if (rows_[u].isSet(v)) return;
+        // Everything reaching `u` now also reaches `v` and everything after it.
+        // Rows already reaching `v` hold all of it, and only nonzero words are ORed.
+        Row add = rows_[v];
+        add.set(v);
+        std::vector<size_t> words;
+        for (size_t w = 0; w < Row::numWords(); w++) if (add.word(w)) words.push_back(w);
+        forRows_([&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                Row& r = rows_[i];
+                if ((i != u && !r.isSet(u)) || r.isSet(v)) continue;
+                for (size_t w : words) r.setWord(w, r.word(w) | add.word(w));
+            }
+        });
+    }
+
+    /// @brief Computes the transitive closure of the edges added so far.
+    void close() {
+        const size_t blocks = (n_ + 63) / 64;
+        FlagFieldVector<N, size_t, FlagCheck::Unchecked> tables(16 * 16);
+        for (size_t kw = 0; kw < blocks; kw++) {
+            const size_t kb = kw * 64;
+            const size_t ke = kb + 64 < n_ ? kb + 64 : n_;
+            closeBlock_(kb, ke);
+            buildTables_(tables, kb, ke);
+            forRows_([&](size_t begin, size_t end) {
+                // Gather the rows reaching into the block once, then sweep them a tile at a time
+                std::vector<std::pair<size_t, uint64_t>> sel;
+                for (size_t i = begin; i < end; i++) {
+                    if (i >= kb && i < ke) continue;
+                    const uint64_t x = rows_[i].word(kw);
+                    if (x) sel.emplace_back(i, x);
+                }
+                for (size_t cb = 0; cb < Row::numWords(); cb += tile) {
+                    const size_t ce = cb + tile < Row::numWords() ? cb + tile : Row::numWords();
+                    for (const auto& r : sel) {
+                        for (size_t g = 0; g < 16; g++) {
+                            const size_t m = (r.second >> (4 * g)) & 15;
+                            if (m) orRow_(rows_[r.first], tables[g * 16 + m], cb, ce);
+                        }
+                    }
+                }
+            });
+        }
+        closed_ = true;
+    }
+
+/// @section Accessors
+
+    /// @brief Returns `true` if there is a path of at least one edge from `u` to `v`.
+    /// @note Only reflects paths once `close()` has run.
+    bool reaches(const size_t& u, const size_t& v) const { return rows_[u].isSet(v); }
+
+    /// @brief Gets the nodes reachable from `u`.
+    const Row& reachableFrom(const size_t& u) const { return rows_[u]; }
+
+    /// @brief Gets the number of nodes.
+    size_t numNodes() const { return n_; }
+
+    /// @brief Returns `true` once `close()` has run.
+    bool closed() const { return closed_; }
+
+    /// @brief Splits row updates across a pool.
+    void setThreadPool(FlagThreadPool* pool) { pool_ = pool; }
+
+    /// @brief The number of row words updated together per table pass.
+    static constexpr size_t tile = 64;
+
+/// @section Private Members
+private:
+    size_t n_;
+    FlagFieldVector<N, size_t, FlagCheck::Unchecked> rows_;
+    FlagThreadPool* pool_ = nullptr;
+    bool closed_ = false;
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    /// @brief `dst |= src` over words `[wb, we)`.
+    static void orRow_(Row& dst, const Row& src, const size_t& wb, const size_t& we) {
+        for (size_t w = wb; w < we; w++) dst.setWord(w, dst.word(w) | src.word(w));
+    }
+
+    /// @brief Runs `fn(begin, end)` over the rows, on the pool if there is one.
+    template <class Fn>
+    void forRows_(Fn&& fn) {
+        if (pool_) pool_->parallelFor(n_, fn);
+        else fn(size_t(0), n_);
+    }
+
+    /// @brief Plain Warshall over the rows and columns of nodes `[kb, ke)`.
+    void closeBlock_(const size_t& kb, const size_t& ke) {
+        for (size_t k = kb; k < ke; k++) {
+            for (size_t i = kb; i < ke; i++) {
+                if (rows_[i].isSet(k)) orRow_(rows_[i], rows_[k], 0, Row::numWords());
+            }
+        }
+    }
+
+    /// @brief Fills `tables[g * 16 + m]` with the OR of the rows of block nodes `kb + 4 * g + bit` for each bit of `m`.
+    void buildTables_(FlagFieldVector<N, size_t, FlagCheck::Unchecked>& tables,
+                      const size_t& kb, const size_t& ke) {
+        for (size_t g = 0; g < 16; g++) {
+            tables[g * 16].clear();
+            for (size_t m = 1; m < 16; m++) {
+                Row& t = tables[g * 16 + m];
+                t = tables[g * 16 + (m & (m - 1))];
+                const size_t k = kb + 4 * g + ctz_(m);
+                if (k < ke) orRow_(t, rows_[k], 0, Row::numWords());
+            }
+        }
+    }
+};
+
+#endif // FLAGFIELDCLOSURE_HPP
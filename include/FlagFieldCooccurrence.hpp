@@ -0,0 +1,145 @@
+/**
+ * @file FlagFieldCooccurrence.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagCooccurrence class.
+ * @details Counts how often each pair of flags is set together across arrays
+ * of FlagFields, and derives lift, pointwise mutual information and the phi
+ * coefficient from the counts.
+ *
+ * - Rows are processed `blockRows` at a time. Each block is transposed into
+ *   one bitmap column per flag (`FlagBitmap::transpose()`), so bit `r` of
+ *   column `i` is flag `i` of row `r`.
+ * - The count of each pair is then `popcount(column_i & column_j)` summed
+ *   over the block, with the Harley-Seal kernel `FlagBitmap::andCount()`.
+ * - With a FlagThreadPool, blocks are split across the workers, each
+ *   counting into its own matrix before the matrices are summed.
+ */
+#pragma once
+#ifndef FLAGFIELDCOOCCURRENCE_HPP
+#define FLAGFIELDCOOCCURRENCE_HPP
+
+#include <FlagFieldBitmap.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+/// @brief Pairwise flag co-occurrence counts over FlagFields of `MAX` flags.
+/// @note Example usage:
+/// ```
+/// FlagCooccurrence<MAX> co;
+/// co.add(rows.data(), rows.size(), &FlagThreadPool::global());
+/// uint64_t both = co.count(ERROR, SHOULD_CLOSE);
+/// double lift = co.lift(ERROR, SHOULD_CLOSE);
+/// ```
+/// @tparam MAX The number of flags.
+template <size_t MAX>
+class FlagCooccurrence {
+public:
+    /// @brief The number of rows transposed and counted together.
+    static constexpr size_t blockRows = 32768;
+
+/// @section Counting Functions
+
+    /// @brief Adds `n` FlagFields to the counts.
+    /// @param pool If not null, blocks of rows are split across the pool.
+    template <class E, class P>
+    void add(const FlagField<MAX, E, P>* rows, const size_t& n, FlagThreadPool* pool = nullptr) {
+        const size_t blocks = (n + blockRows - 1) / blockRows;
+        std::mutex lock;
+        auto part = [&](size_t begin, size_t end) {
+            FlagCooccurrence local;
+            std::vector<uint64_t> columns(MAX * stride_);
+            for (size_t b = begin; b < end; b++) {
+                const size_t first = b * blockRows;
+                const size_t count = n - first < blockRows ? n - first : blockRows;
+                local.addBlock_(rows + first, count, columns.data());
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            merge(local);
+        };
+        if (pool) pool->parallelFor(blocks, part);
+        else part(0, blocks);
+    }
+
+    /// @brief Adds the counts of another matrix.
+    void merge(const FlagCooccurrence& other) {
+        for (size_t i = 0; i < counts_.size(); i++) counts_[i] += other.counts_[i];
+        rows_ += other.rows_;
+    }
+
+    /// @brief Clears the counts.
+    void clear() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        rows_ = 0;
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the number of FlagFields counted.
+    uint64_t rows() const { return rows_; }
+
+    /// @brief Gets the number of FlagFields with flag `i` set.
+    uint64_t count(const size_t& i) const { return counts_[i * MAX + i]; }
+
+    /// @brief Gets the number of FlagFields with both flags `i` and `j` set.
+    uint64_t count(const size_t& i, const size_t& j) const {
+        return i <= j ? counts_[i * MAX + j] : counts_[j * MAX + i];
+    }
+
+/// @section Statistics
+
+    /// @brief Gets the fraction of FlagFields with both flags set.
+    double support(const size_t& i, const size_t& j) const {
+        return rows_ ? double(count(i, j)) / double(rows_) : 0.0;
+    }
+
+    /// @brief Gets `P(i and j) / (P(i) P(j))`, or 0 if either flag is never set.
+    double lift(const size_t& i, const size_t& j) const {
+        const double ci = double(count(i)), cj = double(count(j));
+        return ci && cj ? double(count(i, j)) * double(rows_) / (ci * cj) : 0.0;
+    }
+
+    /// @brief Gets the pointwise mutual information `log2(lift)`, or -infinity if the flags are never set together.
+    double pmi(const size_t& i, const size_t& j) const {
+        const double l = lift(i, j);
+        return l > 0 ? std::log2(l) : -std::numeric_limits<double>::infinity();
+    }
+
+    /// @brief Gets the phi coefficient (Pearson correlation of the two flags), or 0 if either flag is constant.
+    double phi(const size_t& i, const size_t& j) const {
+        const double n = double(rows_), ci = double(count(i)), cj = double(count(j));
+        const double d = ci * (n - ci) * cj * (n - cj);
+        return d > 0 ? (n * double(count(i, j)) - ci * cj) / std::sqrt(d) : 0.0;
+    }
+
+/// @section Private Members
+private:
+    static constexpr size_t blockWords_ = blockRows / 64;
+    /// @brief The distance between columns, padded so they do not alias in the cache.
+    static constexpr size_t stride_ = blockWords_ + 8;
+
+    /// @brief Upper triangle of the pair counts, with the per flag counts on the diagonal.
+    std::vector<uint64_t> counts_ = std::vector<uint64_t>(MAX * MAX, 0);
+    uint64_t rows_ = 0;
+
+    /// @brief Counts a block of at most `blockRows` rows, using `columns` as the transposed bitmaps.
+    template <class E, class P>
+    void addBlock_(const FlagField<MAX, E, P>* rows, const size_t& n, uint64_t* columns) {
+        const size_t words = (n + 63) / 64;
+        FlagBitmap::transpose(rows, n, columns, stride_);
+        for (size_t i = 0; i < MAX; i++) {
+            const uint64_t* ci = columns + i * stride_;
+            counts_[i * MAX + i] += FlagBitmap::andCount(ci, ci, words);
+            for (size_t j = i + 1; j < MAX; j++) {
+                counts_[i * MAX + j] += FlagBitmap::andCount(ci, columns + j * stride_, words);
+            }
+        }
+        rows_ += n;
+    }
+};
+
+#endif // FLAGFIELDCOOCCURRENCE_HPP
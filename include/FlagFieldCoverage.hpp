@@ -0,0 +1,350 @@
+/**
+ * @file FlagFieldCoverage.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagCoverageTrace and FlagCoverageVirgin classes.
+ * @details Fuzzer style edge coverage maps stored in FlagFields, one byte
+ * (eight flags) per edge:
+ * - A `FlagCoverageTrace` holds the hit counts of one run. `classify()`
+ *   turns each count into a one-hot bucket (1, 2, 3, 4-7, 8-15, 16-31,
+ *   32-127, 128+), so flag `8 * e + b` is set when edge `e` was hit within
+ *   bucket `b`. Buckets come from two 16 entry nibble tables looked up with
+ *   byte shuffles, or from a 256 entry byte table on the word path, and
+ *   all-zero vectors are skipped.
+ * - A `FlagCoverageVirgin` holds the (edge, bucket) flags not seen yet.
+ *   `hasNewBits()` finds the trace flags still virgin and clears them in the
+ *   same pass, touching only the vectors where they meet.
+ * - Virgin maps of several workers combine with a word AND in `merge()`.
+ *
+ * Vectors are AVX2 registers with `__AVX2__`, SSSE3 registers with
+ * `__SSSE3__` and words otherwise.
+ */
+#pragma once
+#ifndef FLAGFIELDCOVERAGE_HPP
+#define FLAGFIELDCOVERAGE_HPP
+
+#include <FlagField.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+/// @brief What a run added to a virgin map, in increasing order of interest.
+enum class FlagCoverageResult {
+    None,    ///< Nothing new.
+    NewHits, ///< A known edge hit within a new bucket.
+    NewEdges ///< An edge never hit before.
+};
+
+/// @brief Byte kernels shared by the coverage maps.
+struct FlagCoverageKernels {
+#ifdef __AVX2__
+    using V = __m256i;
+    static constexpr size_t step = 32;
+    static V load(const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const V*>(p)); }
+    static void store(uint8_t* p, const V& v) { _mm256_storeu_si256(reinterpret_cast<V*>(p), v); }
+    static bool none(const V& v) { return _mm256_testz_si256(v, v); }
+    static bool meet(const V& a, const V& b) { return !_mm256_testz_si256(a, b); }
+    static V andNot(const V& a, const V& b) { return _mm256_andnot_si256(a, b); }
+    static V and_(const V& a, const V& b) { return _mm256_and_si256(a, b); }
+    /// @brief Buckets 32 hit counts: the low nibble table below 16, the high nibble table above.
+    static V classify(const V& v) {
+        const V lowTable = _mm256_setr_epi8(0, 1, 2, 4, 8, 8, 8, 8, 16, 16, 16, 16, 16, 16, 16, 16,
+                                            0, 1, 2, 4, 8, 8, 8, 8, 16, 16, 16, 16, 16, 16, 16, 16);
+        const V highTable = _mm256_setr_epi8(0, 32, 64, 64, 64, 64, 64, 64, char(128), char(128), char(128),
+                                             char(128), char(128), char(128), char(128), char(128),
+                                             0, 32, 64, 64, 64, 64, 64, 64, char(128), char(128), char(128),
+                                             char(128), char(128), char(128), char(128), char(128));
+        const V nibble = _mm256_set1_epi8(0x0F);
+        const V high = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+        const V low = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(v, nibble));
+        return _mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi8(high, _mm256_setzero_si256()), low),
+                               _mm256_shuffle_epi8(highTable, high));
+    }
+    /// @brief Checks for a byte hit in `t` and wholly virgin in `v`.
+    static bool newEdge(const V& t, const V& v) {
+        const V hit = _mm256_cmpeq_epi8(t, _mm256_setzero_si256());
+        return _mm256_movemask_epi8(_mm256_andnot_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(-1)))) != 0;
+    }
+#elif defined(__SSSE3__)
+    using V = __m128i;
+    static constexpr size_t step = 16;
+    static V load(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const V*>(p)); }
+    static void store(uint8_t* p, const V& v) { _mm_storeu_si128(reinterpret_cast<V*>(p), v); }
+    static bool none(const V& v) { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF; }
+    static bool meet(const V& a, const V& b) { return !none(_mm_and_si128(a, b)); }
+    static V andNot(const V& a, const V& b) { return _mm_andnot_si128(a, b); }
+    static V and_(const V& a, const V& b) { return _mm_and_si128(a, b); }
+    /// @brief Buckets 16 hit counts: the low nibble table below 16, the high nibble table above.
+    static V classify(const V& v) {
+        const V lowTable = _mm_setr_epi8(0, 1, 2, 4, 8, 8, 8, 8, 16, 16, 16, 16, 16, 16, 16, 16);
+        const V highTable = _mm_setr_epi8(0, 32, 64, 64, 64, 64, 64, 64, char(128), char(128), char(128),
+                                          char(128), char(128), char(128), char(128), char(128));
+        const V nibble = _mm_set1_epi8(0x0F);
+        const V high = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+        const V low = _mm_shuffle_epi8(lowTable, _mm_and_si128(v, nibble));
+        return _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(high, _mm_setzero_si128()), low),
+                            _mm_shuffle_epi8(highTable, high));
+    }
+    /// @brief Checks for a byte hit in `t` and wholly virgin in `v`.
+    static bool newEdge(const V& t, const V& v) {
+        const V hit = _mm_cmpeq_epi8(t, _mm_setzero_si128());
+        return _mm_movemask_epi8(_mm_andnot_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8(-1)))) != 0;
+    }
+#else
+    using V = uint64_t;
+    static constexpr size_t step = 8;
+    static V load(const uint8_t* p) {
+        V v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    static void store(uint8_t* p, const V& v) { std::memcpy(p, &v, sizeof(v)); }
+    static bool none(const V& v) { return !v; }
+    static bool meet(const V& a, const V& b) { return (a & b) != 0; }
+    static V andNot(const V& a, const V& b) { return ~a & b; }
+    static V and_(const V& a, const V& b) { return a & b; }
+    /// @brief Buckets 8 hit counts, a byte at a time through the 256 entry table.
+    static V classify(const V& v) {
+        const uint8_t* t = table().data();
+        V out = 0;
+        for (size_t b = 0; b < 64; b += 8) out |= V(t[(v >> b) & 0xFF]) << b;
+        return out;
+    }
+    /// @brief Checks for a byte hit in `t` and wholly virgin in `v`.
+    static bool newEdge(const V& t, const V& v) {
+        for (size_t b = 0; b < 64; b += 8) {
+            if (((t >> b) & 0xFF) && ((v >> b) & 0xFF) == 0xFF) return true;
+        }
+        return false;
+    }
+#endif
+
+    /// @brief Gets the bucket flag of one hit count.
+    static uint8_t bucket(const uint64_t& count) {
+        static const uint8_t low[16] = {0, 1, 2, 4, 8, 8, 8, 8, 16, 16, 16, 16, 16, 16, 16, 16};
+        static const uint8_t high[16] = {0, 32, 64, 64, 64, 64, 64, 64, 128, 128, 128, 128, 128, 128, 128, 128};
+        return count < 16 ? low[count] : high[count >> 4];
+    }
+
+    /// @brief Gets the bucket flag of every byte count, built once from `bucket()`.
+    static const std::array<uint8_t, 256>& table() {
+        static const std::array<uint8_t, 256> t = [] {
+            std::array<uint8_t, 256> a{};
+            for (size_t c = 0; c < 256; c++) a[c] = bucket(c);
+            return a;
+        }();
+        return t;
+    }
+
+    /// @brief Counts the non-zero bytes of a word.
+    static size_t nonZeroBytes(uint64_t x) {
+        x |= x >> 4;
+        x |= x >> 2;
+        x |= x >> 1;
+        x &= 0x0101010101010101ULL;
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_popcountll(x));
+#else
+        return size_t((x * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+};
+
+/// @brief The edge hit counts of one run, `SIZE` edges of one byte each.
+/// @note Example usage:
+/// ```
+/// FlagCoverageTrace<> trace;                 // 64 KB
+/// // Instrumentation: trace.hit(edge), or trace.counts()[edge]++
+/// runTarget(input);
+/// trace.classify();
+/// if (virgin.hasNewBits(trace) != FlagCoverageResult::None) corpus.add(input);
+/// trace.resetTouched();
+/// ```
+/// @tparam SIZE The number of edges, a multiple of 64. Default = 65536.
+template <size_t SIZE = 65536>
+class FlagCoverageTrace {
+    static_assert(SIZE > 0 && SIZE % 64 == 0, "SIZE must be a positive multiple of 64");
+public:
+    /// @brief Flag `8 * e + b` is bucket `b` of edge `e`.
+    using Field = FlagField<SIZE * 8, size_t, FlagCheck::Unchecked>;
+    /// @brief Flag `k` is the 64 edge block `[64 * k, 64 * k + 64)`.
+    using Blocks = FlagField<SIZE / 64, size_t, FlagCheck::Unchecked>;
+
+/// @section Recording Functions
+
+    /// @brief Gets the hit count bytes, for instrumentation writing them directly.
+    uint8_t* counts() { return *field_; }
+
+    /// @brief Counts a hit of an edge, wrapping at 256, and marks its block touched.
+    void hit(const size_t& edge) {
+        counts()[edge]++;
+        touched_.set(edge / 64);
+    }
+
+    /// @brief Turns every hit count into its one-hot bucket flag, in place.
+    void classify() {
+        using K = FlagCoverageKernels;
+        uint8_t* p = counts();
+        for (size_t i = 0; i < SIZE; i += K::step) {
+            const K::V v = K::load(p + i);
+            if (!K::none(v)) K::store(p + i, K::classify(v));
+        }
+    }
+
+    /// @brief Zeroes every count with one `memset()`.
+    void reset() {
+        std::memset(counts(), 0, SIZE);
+        touched_.clear();
+    }
+
+    /// @brief Zeroes only the blocks `hit()` touched, found with count trailing zeros.
+    /// @note Counts written through `counts()` need `reset()` instead.
+    void resetTouched() {
+        uint8_t* p = counts();
+        for (size_t w = 0; w < touched_.numWords(); w++) {
+            for (uint64_t x = touched_.word(w); x; x &= x - 1) {
+                std::memset(p + (w * 64 + ctz_(x)) * 64, 0, 64);
+            }
+            touched_.setWord(w, 0);
+        }
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the number of edges hit.
+    size_t edges() const {
+        const uint8_t* p = bytes_();
+        size_t n = 0;
+        for (size_t i = 0; i < SIZE; i += 8) {
+            uint64_t x;
+            std::memcpy(&x, p + i, sizeof(x));
+            if (x) n += FlagCoverageKernels::nonZeroBytes(x);
+        }
+        return n;
+    }
+
+    /// @brief Gets the map as flags. Bucket flags after `classify()`, raw count bits before.
+    const Field& field() const { return field_; }
+
+    /// @brief Gets the blocks `hit()` touched since the last reset.
+    const Blocks& touched() const { return touched_; }
+
+/// @section Private Members
+private:
+    template <size_t> friend class FlagCoverageVirgin;
+
+    Field field_;
+    Blocks touched_;
+
+    /// @brief Gets the bytes of `field_`, whose byte access is not const.
+    const uint8_t* bytes_() const { return *const_cast<Field&>(field_); }
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+};
+
+/// @brief The (edge, bucket) flags no run has hit yet, over `SIZE` edges.
+/// @note Example usage:
+/// ```
+/// FlagCoverageVirgin<> virgin;               // every flag set
+/// FlagCoverageResult r = virgin.hasNewBits(trace);
+/// // Periodically, on one worker
+/// global.merge(virgin);
+/// ```
+/// @tparam SIZE The number of edges, a multiple of 64. Default = 65536.
+template <size_t SIZE = 65536>
+class FlagCoverageVirgin {
+    static_assert(SIZE > 0 && SIZE % 64 == 0, "SIZE must be a positive multiple of 64");
+public:
+    /// @brief Flag `8 * e + b` set while bucket `b` of edge `e` was never hit.
+    using Field = FlagField<SIZE * 8, size_t, FlagCheck::Unchecked>;
+
+/// @section Constructors
+
+    /// @brief Constructs a map with nothing seen.
+    FlagCoverageVirgin() { field_.set(); }
+
+/// @section Coverage Functions
+
+    /// @brief Finds the flags of a classified trace still virgin, and clears them in the same pass.
+    /// @return `NewEdges` if an edge was hit for the first time, `NewHits` if only new buckets were.
+    FlagCoverageResult hasNewBits(const FlagCoverageTrace<SIZE>& trace) {
+        using K = FlagCoverageKernels;
+        const uint8_t* t = trace.bytes_();
+        uint8_t* v = *field_;
+        FlagCoverageResult result = FlagCoverageResult::None;
+        for (size_t i = 0; i < SIZE; i += K::step) {
+            const K::V tv = K::load(t + i);
+            if (K::none(tv)) continue;
+            const K::V vv = K::load(v + i);
+            if (!K::meet(tv, vv)) continue;
+            if (result != FlagCoverageResult::NewEdges) {
+                result = K::newEdge(tv, vv) ? FlagCoverageResult::NewEdges : FlagCoverageResult::NewHits;
+            }
+            K::store(v + i, K::andNot(tv, vv));
+        }
+        return result;
+    }
+
+    /// @brief Marks everything another map has seen as seen here (a word AND).
+    /// @return True if this map changed.
+    bool merge(const FlagCoverageVirgin& other) {
+        using K = FlagCoverageKernels;
+        const uint8_t* o = other.bytes_();
+        uint8_t* v = *field_;
+        bool changed = false;
+        for (size_t i = 0; i < SIZE; i += K::step) {
+            const K::V ov = K::load(o + i), vv = K::load(v + i);
+            // Flags virgin here but seen there
+            if (K::none(K::andNot(ov, vv))) continue;
+            K::store(v + i, K::and_(ov, vv));
+            changed = true;
+        }
+        return changed;
+    }
+
+    /// @brief Forgets everything seen.
+    void reset() { field_.set(); }
+
+/// @section Accessors
+
+    /// @brief Gets the number of edges hit by any run.
+    size_t coveredEdges() const {
+        const uint8_t* p = bytes_();
+        size_t n = 0;
+        for (size_t i = 0; i < SIZE; i += 8) {
+            uint64_t x;
+            std::memcpy(&x, p + i, sizeof(x));
+            if (~x) n += FlagCoverageKernels::nonZeroBytes(~x);
+        }
+        return n;
+    }
+
+    /// @brief Gets the map as flags.
+    const Field& field() const { return field_; }
+
+/// @section Private Members
+private:
+    Field field_;
+
+    const uint8_t* bytes_() const { return *const_cast<Field&>(field_); }
+};
+
+/// @brief Finds the flags of a classified trace still virgin, and clears them in the same pass.
+template <size_t SIZE>
+FlagCoverageResult hasNewBits(const FlagCoverageTrace<SIZE>& trace, FlagCoverageVirgin<SIZE>& virgin) {
+    return virgin.hasNewBits(trace);
+}
+
+#endif // FLAGFIELDCOVERAGE_HPP
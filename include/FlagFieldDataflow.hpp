@@ -0,0 +1,224 @@
+/**
+ * @file FlagFieldDataflow.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagDataflow class.
+ * @details A bit-vector dataflow solver (liveness, reaching definitions,
+ * available expressions...) with a FlagField per basic block for the gen,
+ * kill, in and out sets.
+ *
+ * - Blocks are visited in reverse postorder of the flow direction, and only
+ *   blocks whose inputs changed are revisited.
+ * - The transfer function `out = gen | (in & ~kill)` runs in one word pass
+ *   straight into the result set, without temporaries.
+ * - Change detection compares words only until the first one differs.
+ * - `boundary()` flows into blocks with no predecessors (forward) or no
+ *   successors (backward), and into blocks marked with `addBoundary()`, such
+ *   as an entry block that heads a loop.
+ */
+#pragma once
+#ifndef FLAGFIELDDATAFLOW_HPP
+#define FLAGFIELDDATAFLOW_HPP
+
+#include <FlagFieldVector.hpp>
+
+#include <vector>
+
+/// @brief The direction information flows through the CFG.
+enum class FlagFlow {
+    Forward,    ///< `in` is the meet of predecessor `out`s (reaching definitions...)
+    Backward,   ///< `out` is the meet of successor `in`s (liveness...)
+};
+
+/// @brief Meets information with a union ("may" analyses).
+struct FlagMeetUnion {
+    static constexpr uint64_t top = 0;
+    static uint64_t meet(const uint64_t& a, const uint64_t& b) { return a | b; }
+};
+
+/// @brief Meets information with an intersection ("must" analyses).
+struct FlagMeetIntersect {
+    static constexpr uint64_t top = ~uint64_t(0);
+    static uint64_t meet(const uint64_t& a, const uint64_t& b) { return a & b; }
+};
+
+/// @brief A worklist dataflow solver over FlagField sets.
+/// @note Example usage (liveness):
+/// ```
+/// FlagDataflow<NUM_VARS, FlagFlow::Backward> live(numBlocks);
+/// live.addEdge(0, 1);
+/// live.gen(1).set(x);  // uses
+/// live.kill(1).set(y); // defs
+/// live.solve();
+/// if (live.in(1).isSet(x)) {}
+/// ```
+/// @tparam MAX The number of flags in each set.
+/// @tparam Dir The direction information flows.
+/// @tparam Meet The meet operator. Default = `FlagMeetUnion`.
+template <size_t MAX, FlagFlow Dir, class Meet = FlagMeetUnion>
+class FlagDataflow {
+public:
+    using Set = FlagField<MAX, size_t, FlagCheck::Unchecked>;
+
+/// @section Constructors
+
+    /// @brief Constructs a CFG of `numBlocks` blocks with no edges and empty sets.
+    explicit FlagDataflow(const size_t& numBlocks)
+        : gen_(numBlocks), kill_(numBlocks), before_(numBlocks), after_(numBlocks),
+          preds_(numBlocks), succs_(numBlocks), bounded_(numBlocks, 0) {}
+
+/// @section CFG Functions
+
+    /// @brief Adds a control flow edge.
+    void addEdge(const size_t& from, const size_t& to) {
+        succs_[from].push_back(to);
+        preds_[to].push_back(from);
+    }
+
+    /// @brief Marks an entry block (forward) or exit block (backward) that has CFG neighbors.
+    /// @note `boundary()` is met into its input together with the neighbors' values.
+    void addBoundary(const size_t& b) { bounded_[b] = 1; }
+
+    /// @brief Gets the number of blocks.
+    size_t size() const { return gen_.size(); }
+
+/// @section Set Accessors
+
+    /// @brief The flags generated by a block.
+    Set& gen(const size_t& b) { return gen_[b]; }
+    /// @brief The flags killed by a block.
+    Set& kill(const size_t& b) { return kill_[b]; }
+    /// @brief The value flowing into entry blocks (forward) or out of exit blocks (backward).
+    Set& boundary() { return boundary_; }
+
+    /// @brief The flags at the start of a block.
+    const Set& in(const size_t& b) const { return Dir == FlagFlow::Forward ? before_[b] : after_[b]; }
+    /// @brief The flags at the end of a block.
+    const Set& out(const size_t& b) const { return Dir == FlagFlow::Forward ? after_[b] : before_[b]; }
+
+/// @section Solver
+
+    /// @brief Runs the analysis to a fixed point.
+    /// @return The number of transfer functions evaluated.
+    size_t solve() {
+        const size_t n = size();
+        const std::vector<size_t> order = reversePostorder_();
+        std::vector<size_t> rank(n);
+        for (size_t i = 0; i < n; i++) rank[order[i]] = i;
+
+        // Start every block at the top of the lattice
+        for (size_t b = 0; b < n; b++) {
+            for (size_t w = 0; w < Set::numWords(); w++) after_[b].setWord(w, Meet::top);
+        }
+
+        // Pending blocks are flagged by their reverse postorder rank
+        std::vector<uint64_t> pending((n + 63) / 64, ~uint64_t(0));
+        if (n % 64) pending.back() = (uint64_t(1) << (n % 64)) - 1;
+
+        size_t evals = 0;
+        bool any = n > 0;
+        while (any) {
+            any = false;
+            // One sweep in rank order, picking up blocks re-flagged ahead of the cursor
+            for (size_t pw = 0; pw < pending.size(); pw++) {
+                while (pending[pw]) {
+                    const size_t r = pw * 64 + ctz_(pending[pw]);
+                    pending[pw] &= pending[pw] - 1;
+                    const size_t b = order[r];
+                    evals++;
+                    if (!transfer_(b)) continue;
+                    for (size_t s : (Dir == FlagFlow::Forward ? succs_[b] : preds_[b])) {
+                        pending[rank[s] / 64] |= uint64_t(1) << (rank[s] % 64);
+                        if (rank[s] <= r) any = true;
+                    }
+                }
+            }
+        }
+        return evals;
+    }
+
+/// @section Private Members
+private:
+    FlagFieldVector<MAX, size_t, FlagCheck::Unchecked> gen_, kill_;
+    /// @brief Meet of the neighbors (`in` forward, `out` backward).
+    FlagFieldVector<MAX, size_t, FlagCheck::Unchecked> before_;
+    /// @brief Result of the transfer function (`out` forward, `in` backward).
+    FlagFieldVector<MAX, size_t, FlagCheck::Unchecked> after_;
+    std::vector<std::vector<size_t>> preds_, succs_;
+    /// @brief Blocks marked with `addBoundary()`.
+    std::vector<uint8_t> bounded_;
+    Set boundary_;
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    /// @brief Meets the neighbors of `b` into `before`, then applies the fused transfer function.
+    /// @return `true` if the result changed.
+    bool transfer_(const size_t& b) {
+        const auto& sources = Dir == FlagFlow::Forward ? preds_[b] : succs_[b];
+        Set& before = before_[b];
+        Set& after = after_[b];
+        const Set& gen = gen_[b];
+        const Set& kill = kill_[b];
+        constexpr size_t W = Set::numWords();
+
+        size_t i = 0;
+        if (sources.empty() || bounded_[b]) {
+            before = boundary_;
+        } else {
+            before = after_[sources[i++]];
+        }
+        for (; i < sources.size(); i++) {
+            const Set& s = after_[sources[i]];
+            for (size_t w = 0; w < W; w++) before.setWord(w, Meet::meet(before.word(w), s.word(w)));
+        }
+
+        // after = gen | (before & ~kill), comparing only until the first word differs
+        size_t w = 0;
+        for (; w < W; w++) {
+            const uint64_t x = gen.word(w) | (before.word(w) & ~kill.word(w));
+            if (x != after.word(w)) break;
+        }
+        if (w == W) return false;
+        for (; w < W; w++) after.setWord(w, gen.word(w) | (before.word(w) & ~kill.word(w)));
+        return true;
+    }
+
+    /// @brief Orders blocks in reverse postorder of the flow direction.
+    /// @note Searches from entry blocks first, then from unreached blocks in index order.
+    std::vector<size_t> reversePostorder_() const {
+        const size_t n = size();
+        const auto& next = Dir == FlagFlow::Forward ? succs_ : preds_;
+        const auto& prev = Dir == FlagFlow::Forward ? preds_ : succs_;
+        std::vector<size_t> post;
+        std::vector<uint8_t> seen(n, 0);
+        std::vector<std::pair<size_t, size_t>> stack;
+        post.reserve(n);
+        auto dfs = [&](size_t root) {
+            seen[root] = 1;
+            stack.emplace_back(root, 0);
+            while (!stack.empty()) {
+                auto& top = stack.back();
+                if (top.second < next[top.first].size()) {
+                    const size_t s = next[top.first][top.second++];
+                    if (!seen[s]) { seen[s] = 1; stack.emplace_back(s, 0); }
+                } else {
+                    post.push_back(top.first);
+                    stack.pop_back();
+                }
+            }
+        };
+        for (size_t b = 0; b < n; b++) if ((prev[b].empty() || bounded_[b]) && !seen[b]) dfs(b);
+        for (size_t b = 0; b < n; b++) if (!seen[b]) dfs(b);
+        std::vector<size_t> order(post.rbegin(), post.rend());
+        return order;
+    }
+};
+
+#endif // FLAGFIELDDATAFLOW_HPP
@@ -0,0 +1,401 @@
+/**
+ * @file FlagFieldDirty.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagDirtyPages class.
+ * @details Dirty page tracking for incremental checkpoints of a memory
+ * region, one bit per 4 KB page in atomic words laid out like a FlagField.
+ * Pages are marked dirty in one of three ways:
+ * - `Barrier`: the program calls `markDirty()` after each write.
+ * - `Protect`: the region is write protected with `mprotect()`; the first
+ *   write to a page faults, and a process wide SIGSEGV handler makes the
+ *   page writable again and sets its bit.
+ * - `Userfault`: the same with userfaultfd write protection (Linux), the
+ *   faults being served by a thread instead of a signal handler.
+ *
+ * `checkpoint()` takes the bits with `exchange(0)` a word at a time, finds
+ * the runs of dirty pages with count trailing zeros, write protects each run
+ * again and copies it with one `memcpy()`. A page written during the
+ * checkpoint is either copied or marked for the next one, never lost.
+ */
+#pragma once
+#ifndef FLAGFIELDDIRTY_HPP
+#define FLAGFIELDDIRTY_HPP
+
+#include <FlagField.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/userfaultfd.h>)
+#include <linux/userfaultfd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <poll.h>
+#ifdef UFFD_FEATURE_PAGEFAULT_FLAG_WP
+#define FLAGFIELD_USERFAULTFD 1
+#endif
+#endif
+#endif
+
+/// @brief How a FlagDirtyPages learns of writes.
+enum class FlagDirtyMode {
+    Barrier,  ///< Explicit `markDirty()` calls.
+    Protect,  ///< `mprotect()` and SIGSEGV write faults.
+    Userfault ///< userfaultfd write protection, served by a thread (Linux 5.7+).
+};
+
+/// @brief Tracks the dirty 4 KB pages of `[base, base + bytes)` and copies only those on checkpoint.
+/// @note Example usage:
+/// ```
+/// FlagDirtyPages tracker(state, stateBytes, FlagDirtyMode::Protect);
+/// memcpy(snapshot, state, stateBytes);
+/// // ... the program writes to state ...
+/// tracker.checkpoint(snapshot); // copies only the pages written since
+/// ```
+class FlagDirtyPages {
+public:
+    /// @brief The bytes per dirty bit.
+    static constexpr size_t pageSize = 4096;
+
+/// @section Constructors and Deconstructors
+
+    /// @brief Starts tracking a region with no page dirty.
+    /// @note `Protect` and `Userfault` need a region of whole 4 KB pages of one mapping, on a 4 KB system page.
+    /// `Userfault` needs anonymous private (or shmem) memory, with every page touched first on kernels
+    /// before 6.6, whose write protection skips unpopulated pages.
+    FlagDirtyPages(void* base, const size_t& bytes, const FlagDirtyMode& mode = FlagDirtyMode::Barrier)
+        : base_(static_cast<char*>(base)), bytes_(bytes), pages_((bytes + pageSize - 1) / pageSize),
+          words_((pages_ + 63) / 64), mode_(mode), bits_(new std::atomic<uint64_t>[words_]) {
+        for (size_t w = 0; w < words_; w++) bits_[w].store(0, std::memory_order_relaxed);
+        if (mode_ == FlagDirtyMode::Barrier) return;
+        if (reinterpret_cast<uintptr_t>(base) % pageSize || sysconf(_SC_PAGESIZE) != long(pageSize)) {
+            throw std::invalid_argument("[FlagDirtyPages] - ERROR: Region is not 4 KB page aligned!");
+        }
+        if (mode_ == FlagDirtyMode::Protect) register_();
+        else startUserfault_();
+        protect_(0, pages_);
+    }
+
+    FlagDirtyPages(const FlagDirtyPages&) = delete;
+    FlagDirtyPages& operator=(const FlagDirtyPages&) = delete;
+
+    /// @brief Deconstructor. Makes the whole region writable again and stops tracking.
+    /// @note No thread may be writing to the region.
+    ~FlagDirtyPages() {
+        if (mode_ == FlagDirtyMode::Protect) {
+            mprotect(base_, bytes_, PROT_READ | PROT_WRITE);
+            unregister_();
+        }
+#ifdef FLAGFIELD_USERFAULTFD
+        if (mode_ == FlagDirtyMode::Userfault) {
+            const uint64_t one = 1;
+            if (write(stopFd_, &one, sizeof(one)) < 0) {}
+            server_.join();
+            uffdio_range range = {uintptr_t(base_), pages_ * pageSize};
+            ioctl(uffd_, UFFDIO_UNREGISTER, &range);
+            close(uffd_);
+            close(stopFd_);
+        }
+#endif
+    }
+
+/// @section Tracking Functions
+
+    /// @brief Marks the pages of `[p, p + bytes)` dirty. The write barrier: call it after writing.
+    /// @note Safe to call from any thread, in every mode.
+    void markDirty(const void* p, const size_t& bytes = 1) {
+        if (!bytes) return;
+        const size_t first = page(p), last = page(static_cast<const char*>(p) + bytes - 1);
+        for (size_t w = first / 64; w <= last / 64; w++) {
+            uint64_t mask = ~uint64_t(0);
+            if (w == first / 64) mask &= ~uint64_t(0) << (first % 64);
+            if (w == last / 64) mask &= ~uint64_t(0) >> (63 - last % 64);
+            if ((bits_[w].load(std::memory_order_relaxed) & mask) != mask) {
+                bits_[w].fetch_or(mask, std::memory_order_release);
+            }
+        }
+    }
+
+/// @section Checkpoint Functions
+
+    /// @brief Takes the dirty pages, write protects them again, and calls `fn(offset, bytes)` for each run of them.
+    /// @note Only one thread may take the dirty pages at a time; writers may keep running.
+    /// @return The number of bytes in the runs.
+    template <class Fn>
+    size_t collect(Fn&& fn) {
+        static constexpr size_t none = ~size_t(0);
+        size_t total = 0, start = none;
+        auto emit = [&](const size_t& first, const size_t& end) {
+            protect_(first, end);
+            const size_t offset = first * pageSize;
+            const size_t n = (end * pageSize < bytes_ ? end * pageSize : bytes_) - offset;
+            fn(offset, n);
+            total += n;
+        };
+        for (size_t w = 0; w < words_; w++) {
+            // A clean word is only read, so a mostly clean region costs no atomic writes
+            const uint64_t x = bits_[w].load(std::memory_order_relaxed)
+                ? bits_[w].exchange(0, std::memory_order_acq_rel) : 0;
+            for (size_t pos = 0; pos < 64;) {
+                const uint64_t rest = (start == none ? x : ~x) >> pos;
+                if (!rest) break;
+                pos += ctz_(rest);
+                if (start == none) start = w * 64 + pos;
+                else {
+                    emit(start, w * 64 + pos);
+                    start = none;
+                }
+            }
+        }
+        if (start != none) emit(start, pages_);
+        return total;
+    }
+
+    /// @brief Copies the dirty pages into the same offsets of `dst`, and starts tracking anew.
+    /// @return The number of bytes copied.
+    size_t checkpoint(void* dst) {
+        char* out = static_cast<char*>(dst);
+        return collect([&](const size_t& offset, const size_t& n) { std::memcpy(out + offset, base_ + offset, n); });
+    }
+
+    /// @brief Forgets every dirty page, write protecting them again.
+    void clear() {
+        collect([](const size_t&, const size_t&) {});
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the page index of an address.
+    size_t page(const void* p) const { return size_t(static_cast<const char*>(p) - base_) / pageSize; }
+
+    /// @brief Gets the number of pages.
+    size_t pages() const { return pages_; }
+
+    /// @brief Gets the tracking mode.
+    FlagDirtyMode mode() const { return mode_; }
+
+    /// @brief Checks if the page holding `p` is dirty.
+    bool isDirty(const void* p) const {
+        const size_t i = page(p);
+        return (bits_[i / 64].load(std::memory_order_acquire) >> (i % 64)) & 1;
+    }
+
+    /// @brief Gets the number of dirty pages.
+    size_t dirtyPages() const {
+        size_t n = 0;
+        for (size_t w = 0; w < words_; w++) n += popcount_(bits_[w].load(std::memory_order_acquire));
+        return n;
+    }
+
+    /// @brief Copies the dirty bits of pages `[first, first + MAX)` into a FlagField.
+    template <size_t MAX, class E, class P>
+    void copyTo(const size_t& first, FlagField<MAX, E, P>& out) const {
+        for (size_t k = 0; k < out.numWords(); k++) {
+            const size_t i = first + k * 64, w = i / 64, o = i % 64;
+            uint64_t x = w < words_ ? bits_[w].load(std::memory_order_acquire) >> o : 0;
+            if (o && w + 1 < words_) x |= bits_[w + 1].load(std::memory_order_acquire) << (64 - o);
+            out.setWord(k, x);
+        }
+    }
+
+/// @section Private Members
+private:
+    static constexpr size_t maxProtected_ = 64;
+
+    char* const base_;
+    const size_t bytes_, pages_, words_;
+    const FlagDirtyMode mode_;
+    std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+#ifdef FLAGFIELD_USERFAULTFD
+    int uffd_ = -1, stopFd_ = -1;
+    std::thread server_;
+#endif
+
+    /// @brief Sets the bit of a page. Async-signal-safe.
+    void mark_(const size_t& i) { bits_[i / 64].fetch_or(uint64_t(1) << (i % 64), std::memory_order_release); }
+
+    /// @brief Write protects pages `[first, end)`, in the modes that fault.
+    void protect_(const size_t& first, const size_t& end) {
+        if (mode_ == FlagDirtyMode::Protect) {
+            mprotect(base_ + first * pageSize, (end - first) * pageSize, PROT_READ);
+        }
+#ifdef FLAGFIELD_USERFAULTFD
+        else if (mode_ == FlagDirtyMode::Userfault) {
+            uffdio_writeprotect wp = {{uintptr_t(base_ + first * pageSize), (end - first) * pageSize},
+                                      UFFDIO_WRITEPROTECT_MODE_WP};
+            while (ioctl(uffd_, UFFDIO_WRITEPROTECT, &wp) < 0 && errno == EAGAIN) {}
+        }
+#endif
+    }
+
+/// @section Protect Mode
+
+    /// @brief The trackers the SIGSEGV handler looks faults up in.
+    static std::atomic<FlagDirtyPages*>* protected_() {
+        static std::atomic<FlagDirtyPages*> trackers[maxProtected_] = {};
+        return trackers;
+    }
+
+    static std::mutex& registryMutex_() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /// @brief The SIGSEGV action in place before the first tracker, chained to for other faults.
+    static struct sigaction& previous_() {
+        static struct sigaction previous = {};
+        return previous;
+    }
+
+    static size_t& registered_() {
+        static size_t registered = 0;
+        return registered;
+    }
+
+    void register_() {
+        std::lock_guard<std::mutex> lock(registryMutex_());
+        size_t slot = 0;
+        while (slot < maxProtected_ && protected_()[slot].load()) slot++;
+        if (slot == maxProtected_) throw std::runtime_error("[FlagDirtyPages] - ERROR: Too many protected regions!");
+        if (registered_() == 0) {
+            struct sigaction action = {};
+            action.sa_sigaction = &FlagDirtyPages::onFault_;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_SIGINFO | SA_RESTART;
+            if (sigaction(SIGSEGV, &action, &previous_()) < 0) {
+                throw std::runtime_error("[FlagDirtyPages] - ERROR: sigaction failed!");
+            }
+        }
+        registered_()++;
+        protected_()[slot].store(this);
+    }
+
+    void unregister_() {
+        std::lock_guard<std::mutex> lock(registryMutex_());
+        for (size_t slot = 0; slot < maxProtected_; slot++) {
+            if (protected_()[slot].load() == this) protected_()[slot].store(nullptr);
+        }
+        if (--registered_() == 0) sigaction(SIGSEGV, &previous_(), nullptr);
+    }
+
+    /// @brief The SIGSEGV handler. Makes a tracked page writable, then marks it.
+    /// @note Unprotecting before marking means a checkpoint between the two either
+    /// copies the write or leaves the page marked. `mprotect()` is a plain system call on
+    /// the platforms this runs on, though POSIX does not list it as async-signal-safe.
+    static void onFault_(int sig, siginfo_t* info, void* context) {
+        const int saved = errno;
+        const char* addr = static_cast<const char*>(info->si_addr);
+        for (size_t slot = 0; slot < maxProtected_; slot++) {
+            FlagDirtyPages* t = protected_()[slot].load(std::memory_order_acquire);
+            if (!t || addr < t->base_ || size_t(addr - t->base_) >= t->pages_ * pageSize) continue;
+            const size_t i = t->page(addr);
+            mprotect(t->base_ + i * pageSize, pageSize, PROT_READ | PROT_WRITE);
+            t->mark_(i);
+            errno = saved;
+            return;
+        }
+        // Not a tracked page: hand it to the previous action, or fault again with the default one
+        const struct sigaction& previous = previous_();
+        if ((previous.sa_flags & SA_SIGINFO) && previous.sa_sigaction) previous.sa_sigaction(sig, info, context);
+        else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) previous.sa_handler(sig);
+        else signal(sig, SIG_DFL);
+        errno = saved;
+    }
+
+/// @section Userfault Mode
+
+    void startUserfault_() {
+#ifdef FLAGFIELD_USERFAULTFD
+        uint64_t features = UFFD_FEATURE_PAGEFAULT_FLAG_WP;
+#ifdef UFFD_FEATURE_WP_UNPOPULATED
+        // Also fault on pages never touched, where the kernel supports it
+        features |= UFFD_FEATURE_WP_UNPOPULATED;
+#endif
+        uffd_ = openUserfault_(features);
+        if (uffd_ < 0 && features != UFFD_FEATURE_PAGEFAULT_FLAG_WP) {
+            uffd_ = openUserfault_(UFFD_FEATURE_PAGEFAULT_FLAG_WP);
+        }
+        if (uffd_ < 0) throw std::runtime_error("[FlagDirtyPages] - ERROR: userfaultfd write protection unavailable!");
+        uffdio_register reg = {{uintptr_t(base_), pages_ * pageSize}, UFFDIO_REGISTER_MODE_WP, 0};
+        if (ioctl(uffd_, UFFDIO_REGISTER, &reg) < 0) {
+            close(uffd_);
+            throw std::runtime_error("[FlagDirtyPages] - ERROR: userfaultfd register failed!");
+        }
+        stopFd_ = eventfd(0, EFD_CLOEXEC);
+        if (stopFd_ < 0) {
+            close(uffd_);
+            throw std::runtime_error("[FlagDirtyPages] - ERROR: eventfd failed!");
+        }
+        server_ = std::thread([this] { serve_(); });
+#else
+        throw std::runtime_error("[FlagDirtyPages] - ERROR: userfaultfd is not supported on this platform!");
+#endif
+    }
+
+#ifdef FLAGFIELD_USERFAULTFD
+    static int openUserfault_(const uint64_t& features) {
+        const int fd = int(syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK));
+        if (fd < 0) return -1;
+        uffdio_api api = {UFFD_API, features, 0};
+        if (ioctl(fd, UFFDIO_API, &api) < 0 || (api.features & features) != features) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /// @brief The fault thread: makes each faulting page writable, then marks it.
+    void serve_() {
+        pollfd fds[2] = {{uffd_, POLLIN, 0}, {stopFd_, POLLIN, 0}};
+        for (;;) {
+            if (poll(fds, 2, -1) < 0) continue;
+            if (fds[1].revents) return;
+            uffd_msg msg;
+            while (read(uffd_, &msg, sizeof(msg)) == ssize_t(sizeof(msg))) {
+                if (msg.event != UFFD_EVENT_PAGEFAULT || !(msg.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP)) continue;
+                const size_t i = page(reinterpret_cast<const void*>(uintptr_t(msg.arg.pagefault.address)));
+                // Unprotect, mark, and only then let the faulting thread write
+                uffdio_writeprotect wp = {{uintptr_t(base_ + i * pageSize), pageSize}, UFFDIO_WRITEPROTECT_MODE_DONTWAKE};
+                while (ioctl(uffd_, UFFDIO_WRITEPROTECT, &wp) < 0 && errno == EAGAIN) {}
+                mark_(i);
+                ioctl(uffd_, UFFDIO_WAKE, &wp.range);
+            }
+        }
+    }
+#endif
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    static size_t popcount_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_popcountll(x));
+#else
+        size_t n = 0;
+        for (; x; x &= x - 1) n++;
+        return n;
+#endif
+    }
+};
+
+#endif // FLAGFIELDDIRTY_HPP
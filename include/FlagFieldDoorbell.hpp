@@ -0,0 +1,197 @@
+/**
+ * @file FlagFieldDoorbell.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagDoorbell class.
+ * @details An atomic ready-set of `MAX` event sources, rung by any number of
+ * producer threads and drained by one consumer:
+ * - `ring(i)` is one `fetch_or` of source `i`'s bit. Only the producer that
+ *   finds both its word and the summary of non-empty words clear wakes the
+ *   consumer, so a burst of events costs one wake-up.
+ * - `drain()` takes the summary and then each word it names with
+ *   `exchange(0)`, and dispatches the set bits in index order with count
+ *   trailing zeros. A source rung many times before a drain is dispatched
+ *   once.
+ * - On Linux the consumer is woken through an eventfd, which `fd()` exposes
+ *   for epoll. Elsewhere a condition variable stands in.
+ */
+#pragma once
+#ifndef FLAGFIELDDOORBELL_HPP
+#define FLAGFIELDDOORBELL_HPP
+
+#include <FlagField.hpp>
+
+#include <atomic>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <stdexcept>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/// @brief An atomic ready-set of event sources with a wake-up for its consumer.
+/// @note Example usage:
+/// ```
+/// FlagDoorbell<1024> bell;
+/// // Producers, on any thread
+/// bell.ring(source);
+/// // The event loop
+/// for (;;) {
+///     bell.wait();
+///     bell.drain([&](size_t source) { handle(source); });
+/// }
+/// ```
+/// @tparam MAX The number of event sources, at most 4096. Default = 64.
+template <size_t MAX = 64>
+class FlagDoorbell {
+    static_assert(MAX > 0 && MAX <= 4096, "MAX must be between 1 and 4096");
+public:
+    using Sources = FlagField<MAX, size_t, FlagCheck::Unchecked>;
+
+/// @section Constructors and Deconstructors
+
+    /// @brief Constructs a doorbell with no source ready.
+    FlagDoorbell() {
+#ifdef __linux__
+        fd_ = eventfd(0, EFD_CLOEXEC);
+        if (fd_ < 0) throw std::runtime_error("[FlagDoorbell] - ERROR: eventfd failed!");
+#endif
+    }
+
+    FlagDoorbell(const FlagDoorbell&) = delete;
+    FlagDoorbell& operator=(const FlagDoorbell&) = delete;
+
+    /// @brief Deconstructor. Closes the eventfd.
+    ~FlagDoorbell() {
+#ifdef __linux__
+        close(fd_);
+#endif
+    }
+
+/// @section Producer Functions
+
+    /// @brief Marks a source ready. Safe to call from any thread.
+    /// @return True if this call woke the consumer.
+    bool ring(const size_t& source) {
+        const size_t w = source / 64;
+        if (words_[w].fetch_or(uint64_t(1) << (source % 64))) return false;
+        if (summary_.fetch_or(uint64_t(1) << w)) return false;
+        wake_();
+        return true;
+    }
+
+/// @section Consumer Functions
+
+    /// @brief Blocks until the doorbell is rung. A ring before the call returns at once.
+    /// @note May return with nothing to drain, after a drain already took the sources of the ring.
+    void wait() {
+#ifdef __linux__
+        uint64_t count;
+        while (read(fd_, &count, sizeof(count)) < 0 && errno == EINTR) {}
+#else
+        std::unique_lock<std::mutex> lock(mutex_);
+        rung_.wait(lock, [this] { return pending_; });
+        pending_ = false;
+#endif
+    }
+
+    /// @brief Takes every ready source, calling `fn(source)` for each in index order.
+    /// @return The number of sources dispatched.
+    template <class Fn>
+    size_t drain(Fn&& fn) {
+        size_t n = 0;
+        for (uint64_t s = summary_.exchange(0); s; s &= s - 1) {
+            const size_t w = ctz_(s);
+            for (uint64_t x = words_[w].exchange(0); x; x &= x - 1) {
+                fn(w * 64 + ctz_(x));
+                n++;
+            }
+        }
+        return n;
+    }
+
+    /// @brief Takes every ready source into `out`.
+    /// @return The number of sources taken.
+    size_t drain(Sources& out) {
+        size_t n = 0;
+        for (size_t w = 0; w < wordCount_; w++) out.setWord(w, 0);
+        for (uint64_t s = summary_.exchange(0); s; s &= s - 1) {
+            const size_t w = ctz_(s);
+            const uint64_t x = words_[w].exchange(0);
+            out.setWord(w, x);
+            n += popcount_(x);
+        }
+        return n;
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the eventfd to poll for rings, or -1 where there is none.
+    int fd() const {
+#ifdef __linux__
+        return fd_;
+#else
+        return -1;
+#endif
+    }
+
+    /// @brief Gets a snapshot of the ready sources without taking them.
+    Sources ready() const {
+        Sources out;
+        for (size_t w = 0; w < wordCount_; w++) out.setWord(w, words_[w].load());
+        return out;
+    }
+
+/// @section Private Members
+private:
+    static constexpr size_t wordCount_ = (MAX + 63) / 64;
+
+    /// @brief Bit `w` set while word `w` may have ready sources.
+    alignas(64) std::atomic<uint64_t> summary_{0};
+    alignas(64) std::atomic<uint64_t> words_[wordCount_] = {};
+#ifdef __linux__
+    int fd_ = -1;
+#else
+    std::mutex mutex_;
+    std::condition_variable rung_;
+    bool pending_ = false;
+#endif
+
+    void wake_() {
+#ifdef __linux__
+        const uint64_t one = 1;
+        while (write(fd_, &one, sizeof(one)) < 0 && errno == EINTR) {}
+#else
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = true;
+        }
+        rung_.notify_one();
+#endif
+    }
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    static size_t popcount_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_popcountll(x));
+#else
+        size_t n = 0;
+        for (; x; x &= x - 1) n++;
+        return n;
+#endif
+    }
+};
+
+#endif // FLAGFIELDDOORBELL_HPP
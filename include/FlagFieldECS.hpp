@@ -0,0 +1,207 @@
+/**
+ * @file FlagFieldECS.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagArchetypes class.
+ * @details An entity-component-system archetype registry keyed by FlagField
+ * component signatures.
+ *
+ * - Entities with identical signatures share an archetype, which stores its
+ *   entities in one contiguous array.
+ * - A query (required and excluded components) is matched against the
+ *   archetypes once, with word tests, and its list of matching archetypes is
+ *   cached. New archetypes are tested against the cached queries as they
+ *   appear, so queries never rescan.
+ * - Iterating a query walks its cached archetypes and yields each one's
+ *   entity array as a chunk.
+ */
+#pragma once
+#ifndef FLAGFIELDECS_HPP
+#define FLAGFIELDECS_HPP
+
+#include <FlagField.hpp>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief A registry grouping entities by their component signature.
+/// @note Example usage:
+/// ```
+/// FlagArchetypes<MAX, Component> world;
+/// world.add(entity, FlagField<MAX, Component>(Position, Velocity));
+/// const size_t movers = world.query(FlagField<MAX, Component>(Position, Velocity),
+///                                   FlagField<MAX, Component>(Frozen));
+/// world.forEach(movers, [&](const size_t* entities, size_t count, size_t archetype) {});
+/// ```
+/// @tparam MAX The number of component types.
+/// @tparam E The enum of component types. Default = `size_t`.
+template <size_t MAX, class E = size_t>
+class FlagArchetypes {
+public:
+    using Signature = FlagField<MAX, E, FlagCheck::Unchecked>;
+
+    /// @brief The archetype of entities not in the registry.
+    static constexpr size_t none = ~size_t(0);
+
+/// @section Entity Functions
+
+    /// @brief Adds an entity with a signature, or moves it to a new signature.
+    /// @return The entity's archetype.
+    template <class P>
+    size_t add(const size_t& entity, const FlagField<MAX, E, P>& signature) {
+        Signature sig;
+        for (size_t w = 0; w < Signature::numWords(); w++) sig.setWord(w, signature.word(w));
+        const size_t a = archetype_(sig);
+        if (entity >= where_.size()) where_.resize(entity + 1, {none, 0});
+        if (where_[entity].first == a) return a;
+        if (where_[entity].first != none) remove(entity);
+        where_[entity] = {a, archetypes_[a].entities.size()};
+        archetypes_[a].entities.push_back(entity);
+        return a;
+    }
+
+    /// @brief Removes an entity.
+    void remove(const size_t& entity) {
+        if (entity >= where_.size() || where_[entity].first == none) return;
+        // Swap the last entity of the archetype into the hole
+        std::vector<size_t>& list = archetypes_[where_[entity].first].entities;
+        const size_t row = where_[entity].second;
+        list[row] = list.back();
+        where_[list[row]].second = row;
+        list.pop_back();
+        where_[entity] = {none, 0};
+    }
+
+    /// @brief Gets an entity's archetype, or `none`.
+    size_t archetypeOf(const size_t& entity) const {
+        return entity < where_.size() ? where_[entity].first : none;
+    }
+
+/// @section Archetype Accessors
+
+    /// @brief Gets the number of archetypes.
+    size_t numArchetypes() const { return archetypes_.size(); }
+
+    /// @brief Gets the signature of an archetype.
+    const Signature& signature(const size_t& archetype) const { return archetypes_[archetype].signature; }
+
+    /// @brief Gets the entities of an archetype, contiguous.
+    const std::vector<size_t>& entities(const size_t& archetype) const { return archetypes_[archetype].entities; }
+
+/// @section Query Functions
+
+    /// @brief Registers a query for entities with every `required` and no `excluded` component.
+    /// @note Registering the same query again returns the same id.
+    /// @return The query id.
+    template <class P1, class P2>
+    size_t query(const FlagField<MAX, E, P1>& required, const FlagField<MAX, E, P2>& excluded) {
+        Query_ q;
+        for (size_t w = 0; w < Signature::numWords(); w++) {
+            q.required.setWord(w, required.word(w));
+            q.excluded.setWord(w, excluded.word(w));
+        }
+        const Key_ key{q.required, q.excluded};
+        const auto it = queryIds_.find(key);
+        if (it != queryIds_.end()) return it->second;
+        for (size_t a = 0; a < archetypes_.size(); a++) {
+            if (matches_(q, archetypes_[a].signature)) q.archetypes.push_back(a);
+        }
+        queries_.push_back(q);
+        queryIds_.emplace(key, queries_.size() - 1);
+        return queries_.size() - 1;
+    }
+
+    /// @brief Registers a query for entities with every `required` component.
+    template <class P>
+    size_t query(const FlagField<MAX, E, P>& required) { return query(required, Signature()); }
+
+    /// @brief Gets the archetypes matching a query.
+    const std::vector<size_t>& archetypes(const size_t& query) const { return queries_[query].archetypes; }
+
+    /// @brief Calls `fn(entities, count, archetype)` for each non-empty archetype matching a query.
+    template <class Fn>
+    void forEach(const size_t& query, Fn&& fn) const {
+        for (size_t a : queries_[query].archetypes) {
+            const std::vector<size_t>& list = archetypes_[a].entities;
+            if (!list.empty()) fn(list.data(), list.size(), a);
+        }
+    }
+
+    /// @brief Counts the entities matching a query.
+    size_t count(const size_t& query) const {
+        size_t c = 0;
+        for (size_t a : queries_[query].archetypes) c += archetypes_[a].entities.size();
+        return c;
+    }
+
+/// @section Private Members
+private:
+    struct Archetype_ {
+        Signature signature;
+        std::vector<size_t> entities;
+    };
+
+    struct Query_ {
+        Signature required, excluded;
+        std::vector<size_t> archetypes;
+    };
+
+    using Key_ = std::pair<Signature, Signature>;
+
+    /// @brief Word equality and hashing for signatures (FlagField's `==` is a subset test).
+    struct Hash_ {
+        static size_t hash(const Signature& s, size_t h) {
+            for (size_t w = 0; w < Signature::numWords(); w++) {
+                h ^= s.word(w);
+                h *= 0x9E3779B97F4A7C15ULL;
+                h ^= h >> 29;
+            }
+            return h;
+        }
+        size_t operator()(const Signature& s) const { return hash(s, 0); }
+        size_t operator()(const Key_& k) const { return hash(k.second, hash(k.first, 0)); }
+    };
+
+    struct Equal_ {
+        static bool same(const Signature& a, const Signature& b) {
+            for (size_t w = 0; w < Signature::numWords(); w++) {
+                if (a.word(w) != b.word(w)) return false;
+            }
+            return true;
+        }
+        bool operator()(const Signature& a, const Signature& b) const { return same(a, b); }
+        bool operator()(const Key_& a, const Key_& b) const {
+            return same(a.first, b.first) && same(a.second, b.second);
+        }
+    };
+
+    std::vector<Archetype_> archetypes_;
+    std::unordered_map<Signature, size_t, Hash_, Equal_> archetypeIds_;
+    std::vector<Query_> queries_;
+    std::unordered_map<Key_, size_t, Hash_, Equal_> queryIds_;
+    /// @brief (archetype, row) of each entity.
+    std::vector<std::pair<size_t, size_t>> where_;
+
+    static bool matches_(const Query_& q, const Signature& s) {
+        for (size_t w = 0; w < Signature::numWords(); w++) {
+            const uint64_t x = s.word(w);
+            if ((x & q.required.word(w)) != q.required.word(w) || (x & q.excluded.word(w))) return false;
+        }
+        return true;
+    }
+
+    /// @brief Finds or creates the archetype of a signature, adding new archetypes to the matching queries.
+    size_t archetype_(const Signature& sig) {
+        const auto it = archetypeIds_.find(sig);
+        if (it != archetypeIds_.end()) return it->second;
+        const size_t a = archetypes_.size();
+        archetypes_.push_back({sig, {}});
+        archetypeIds_.emplace(sig, a);
+        for (Query_& q : queries_) {
+            if (matches_(q, sig)) q.archetypes.push_back(a);
+        }
+        return a;
+    }
+};
+
+#endif // FLAGFIELDECS_HPP
@@ -0,0 +1,281 @@
+/**
+ * @file FlagFieldEclat.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagEclat class.
+ * @details Frequent flag combination (itemset) mining with the Eclat
+ * algorithm over vertical bitmaps.
+ *
+ * - The FlagFields are transposed once into one bitmap column (tidset) per
+ *   flag, so bit `r` of column `i` is flag `i` of row `r`.
+ * - The supports of all pairs of frequent flags are counted first, a tile
+ *   of `tileWords` words of every column at a time so the columns are read
+ *   from memory once rather than once per pair.
+ * - The search is then depth first: the support of a prefix extended by a
+ *   flag is `popcount(tidset(prefix) & column(flag))`, counted in one fused
+ *   pass without storing the intersection. Flags whose pair with the last
+ *   flag of the prefix is infrequent are skipped without counting. Only
+ *   extensions reaching the minimum support have their tidset stored, and
+ *   only their later siblings are tried as further extensions.
+ * - Tidsets are stored as whole bitmaps while dense, and as lists of
+ *   (word index, word) pairs once they cover under half the words, so deep
+ *   and rare itemsets only touch the words that still have rows.
+ * - With a FlagThreadPool, the pair tiles are split across the workers, and
+ *   the top level branches (one per frequent flag) are claimed by the
+ *   workers one at a time.
+ */
+#pragma once
+#ifndef FLAGFIELDECLAT_HPP
+#define FLAGFIELDECLAT_HPP
+
+#include <FlagFieldBitmap.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/// @brief A frequent itemset miner over FlagFields of `MAX` flags.
+/// @note Example usage:
+/// ```
+/// FlagEclat<MAX> miner(snapshots.data(), snapshots.size());
+/// for (const auto& s : miner.mine(snapshots.size() / 100)) {
+///     // s.items is a FlagField of flags set together in s.support snapshots
+/// }
+/// ```
+/// @tparam MAX The number of flags.
+template <size_t MAX>
+class FlagEclat {
+public:
+    using Items = FlagField<MAX, size_t, FlagCheck::Unchecked>;
+
+    /// @brief A set of flags and the number of rows with all of them set.
+    struct Itemset {
+        Items items;
+        uint64_t support;
+    };
+
+/// @section Constructors
+
+    /// @brief Transposes `n` FlagFields into per flag tidsets.
+    template <class E, class P>
+    FlagEclat(const FlagField<MAX, E, P>* rows, const size_t& n)
+        : rows_(n), words_((n + 63) / 64), stride_(words_ + 8), columns_(MAX * stride_) {
+        FlagBitmap::transpose(rows, n, columns_.data(), stride_);
+        for (size_t i = 0; i < MAX; i++) supports_[i] = FlagBitmap::andCount(column_(i), column_(i), words_);
+    }
+
+    /// @brief The number of words of each column counted together when counting pairs.
+    static constexpr size_t tileWords = 512;
+
+/// @section Accessors
+
+    /// @brief Gets the number of rows.
+    size_t rows() const { return rows_; }
+
+    /// @brief Gets the number of rows with a flag set.
+    uint64_t support(const size_t& flag) const { return supports_[flag]; }
+
+    /// @brief Gets the number of rows with every flag of `items` set.
+    template <class E, class P>
+    uint64_t support(const FlagField<MAX, E, P>& items) const {
+        std::vector<uint64_t> t(words_, ~uint64_t(0));
+        if (rows_ % 64) t.back() = (uint64_t(1) << (rows_ % 64)) - 1;
+        for (size_t w = 0; w < Items::numWords(); w++) {
+            for (uint64_t x = items.word(w); x; x &= x - 1) {
+                const uint64_t* c = column_(w * 64 + ctz_(x));
+                for (size_t i = 0; i < words_; i++) t[i] &= c[i];
+            }
+        }
+        uint64_t s = 0;
+        for (uint64_t x : t) s += FlagBitmap::popcount(x);
+        return s;
+    }
+
+/// @section Mining Functions
+
+    /// @brief Finds every itemset of at most `maxLength` flags set together in at least `minSupport` rows.
+    /// @param pool If not null, the top level branches are split across the pool.
+    /// @return The itemsets, most frequent first (ties smallest first, then in flag order).
+    std::vector<Itemset> mine(const uint64_t& minSupport, const size_t& maxLength = MAX,
+                              FlagThreadPool* pool = nullptr) const {
+        std::vector<size_t> frequent;
+        for (size_t i = 0; i < MAX; i++) {
+            if (supports_[i] >= minSupport && supports_[i] > 0) frequent.push_back(i);
+        }
+        std::vector<Itemset> out;
+        if (maxLength == 0) return out;
+        std::mutex lock;
+        const std::vector<uint64_t> pairs = maxLength > 1 ? pairSupports_(frequent, pool) : std::vector<uint64_t>();
+        std::atomic<size_t> next(0);
+        auto worker = [&](size_t, size_t) {
+            Search_ s{*this, minSupport, maxLength, pairs, {}, std::vector<Tidset_>(maxLength)};
+            Items prefix;
+            for (size_t b; (b = next.fetch_add(1)) < frequent.size();) {
+                prefix.set(frequent[b]);
+                s.out.push_back({prefix, supports_[frequent[b]]});
+                Tidset_ root;
+                root.dense = column_(frequent[b]);
+                s.extend(root, prefix, frequent[b], frequent.data() + b + 1, frequent.size() - b - 1, 1);
+                prefix.clear(frequent[b]);
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            out.insert(out.end(), s.out.begin(), s.out.end());
+        };
+        if (pool) pool->parallelFor(pool->size(), worker);
+        else worker(0, 1);
+        std::sort(out.begin(), out.end(), [](const Itemset& a, const Itemset& b) {
+            if (a.support != b.support) return a.support > b.support;
+            const size_t na = size_(a.items), nb = size_(b.items);
+            if (na != nb) return na < nb;
+            for (size_t w = 0; w < Items::numWords(); w++) {
+                if (a.items.word(w) != b.items.word(w)) return lowFirst_(a.items.word(w), b.items.word(w));
+            }
+            return false;
+        });
+        return out;
+    }
+
+/// @section Private Members
+private:
+    size_t rows_, words_, stride_;
+    std::vector<uint64_t> columns_;
+    uint64_t supports_[MAX] = {};
+
+    /// @brief The rows of an itemset: a whole bitmap, or (word index, word) pairs of its nonzero words.
+    struct Tidset_ {
+        const uint64_t* dense = nullptr;
+        std::vector<uint64_t> buffer;
+        std::vector<uint32_t> index;
+        std::vector<uint64_t> bits;
+    };
+
+    /// @brief The state of one worker's depth first search.
+    struct Search_ {
+        const FlagEclat& miner;
+        uint64_t minSupport;
+        size_t maxLength;
+        /// @brief The support of each pair of frequent flags.
+        const std::vector<uint64_t>& pairs;
+        std::vector<Itemset> out;
+        /// @brief The tidset of the prefix of each length.
+        std::vector<Tidset_> levels;
+
+        /// @brief Counts the rows of `t` with flag `f` set.
+        uint64_t count(const Tidset_& t, const size_t& f) const {
+            const uint64_t* c = miner.column_(f);
+            if (t.dense) return FlagBitmap::andCount(t.dense, c, miner.words_);
+            uint64_t s = 0;
+            for (size_t i = 0; i < t.index.size(); i++) s += FlagBitmap::popcount(t.bits[i] & c[t.index[i]]);
+            return s;
+        }
+
+        /// @brief Stores `t & column(f)` in `child`, whole if at least half its words may be nonzero.
+        void intersect(Tidset_& child, const Tidset_& t, const size_t& f, const uint64_t& support) const {
+            const uint64_t* c = miner.column_(f);
+            const size_t words = miner.words_;
+            child.index.clear();
+            child.bits.clear();
+            child.dense = nullptr;
+            if (t.dense && support >= words / 2) {
+                child.buffer.resize(words);
+                for (size_t w = 0; w < words; w++) child.buffer[w] = t.dense[w] & c[w];
+                child.dense = child.buffer.data();
+            } else if (t.dense) {
+                for (size_t w = 0; w < words; w++) {
+                    const uint64_t x = t.dense[w] & c[w];
+                    if (x) {
+                        child.index.push_back(uint32_t(w));
+                        child.bits.push_back(x);
+                    }
+                }
+            } else {
+                for (size_t i = 0; i < t.index.size(); i++) {
+                    const uint64_t x = t.bits[i] & c[t.index[i]];
+                    if (x) {
+                        child.index.push_back(t.index[i]);
+                        child.bits.push_back(x);
+                    }
+                }
+            }
+        }
+
+        /// @brief Extends `prefix` (of `length` flags ending with `last`, rows `t`) by each of `n` candidate flags.
+        void extend(const Tidset_& t, Items& prefix, const size_t& last, const size_t* candidates,
+                    const size_t& n, const size_t& length) {
+            if (length >= maxLength || n == 0) return;
+            std::vector<size_t> kept;
+            std::vector<uint64_t> supports;
+            for (size_t i = 0; i < n; i++) {
+                const uint64_t pair = pairs[last * MAX + candidates[i]];
+                if (pair < minSupport || pair == 0) continue;
+                const uint64_t s = length == 1 ? pair : count(t, candidates[i]);
+                if (s >= minSupport && s > 0) {
+                    kept.push_back(candidates[i]);
+                    supports.push_back(s);
+                }
+            }
+            for (size_t i = 0; i < kept.size(); i++) {
+                prefix.set(kept[i]);
+                out.push_back({prefix, supports[i]});
+                if (length + 1 < maxLength && i + 1 < kept.size()) {
+                    Tidset_& child = levels[length];
+                    intersect(child, t, kept[i], supports[i]);
+                    extend(child, prefix, kept[i], kept.data() + i + 1, kept.size() - i - 1, length + 1);
+                }
+                prefix.clear(kept[i]);
+            }
+        }
+    };
+
+    const uint64_t* column_(const size_t& i) const { return columns_.data() + i * stride_; }
+
+    /// @brief Counts the support of every pair of `flags`, a tile of words at a time.
+    std::vector<uint64_t> pairSupports_(const std::vector<size_t>& flags, FlagThreadPool* pool) const {
+        std::vector<uint64_t> pairs(MAX * MAX, 0);
+        std::mutex lock;
+        const size_t tiles = (words_ + tileWords - 1) / tileWords;
+        auto part = [&](size_t begin, size_t end) {
+            std::vector<uint64_t> local(MAX * MAX, 0);
+            for (size_t tile = begin; tile < end; tile++) {
+                const size_t w = tile * tileWords;
+                const size_t len = words_ - w < tileWords ? words_ - w : tileWords;
+                for (size_t a = 0; a < flags.size(); a++) {
+                    const uint64_t* ca = column_(flags[a]) + w;
+                    for (size_t b = a + 1; b < flags.size(); b++) {
+                        local[flags[a] * MAX + flags[b]] += FlagBitmap::andCount(ca, column_(flags[b]) + w, len);
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            for (size_t i = 0; i < pairs.size(); i++) pairs[i] += local[i];
+        };
+        if (pool) pool->parallelFor(tiles, part);
+        else part(0, tiles);
+        return pairs;
+    }
+
+    static size_t ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_ctzll(x));
+#else
+        size_t n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    static size_t size_(const Items& items) {
+        size_t n = 0;
+        for (size_t w = 0; w < Items::numWords(); w++) n += size_t(FlagBitmap::popcount(items.word(w)));
+        return n;
+    }
+
+    /// @brief Orders words so the one with the lowest differing bit set comes first.
+    static bool lowFirst_(const uint64_t& a, const uint64_t& b) {
+        const uint64_t d = a ^ b;
+        return (a & d & (0 - d)) != 0;
+    }
+};
+
+#endif // FLAGFIELDECLAT_HPP
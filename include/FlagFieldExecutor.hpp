@@ -0,0 +1,247 @@
+/**
+ * @file FlagFieldExecutor.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagExecutor class.
+ * @details A work-stealing executor scheduled by two atomic FlagField masks:
+ * the workers parked idle, and the workers with a non-empty deque.
+ *
+ * - Spawning wakes exactly one idle worker, the lowest one found with count
+ *   trailing zeros over the idle mask, claimed by clearing its bit. Nothing
+ *   is broadcast, so there is no thundering herd.
+ * - A worker runs its own deque newest first. When it is empty, it steals
+ *   the oldest task of the next worker set in the non-empty mask after it,
+ *   instead of probing random victims.
+ * - A worker parks only after publishing its idle bit and seeing the
+ *   non-empty mask clear, so a spawn can never be missed between the two.
+ */
+#pragma once
+#ifndef FLAGFIELDEXECUTOR_HPP
+#define FLAGFIELDEXECUTOR_HPP
+
+#include <FlagField.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief A work-stealing executor of up to `MAX` worker threads.
+/// @note Example usage:
+/// ```
+/// FlagExecutor<> executor(8);
+/// executor.spawn([&] { handle(request); });
+/// executor.wait();
+/// ```
+/// @tparam MAX The most workers. Default = 64.
+template <size_t MAX = 64>
+class FlagExecutor {
+public:
+    using Workers = FlagField<MAX, size_t, FlagCheck::Unchecked>;
+
+/// @section Constructors and Deconstructors
+
+    /// @brief Starts `workers` worker threads, at most `MAX`.
+    /// @note `0` uses one worker per hardware thread.
+    explicit FlagExecutor(size_t workers = 0) {
+        if (workers == 0) workers = std::thread::hardware_concurrency();
+        if (workers == 0) workers = 1;
+        size_ = workers < MAX ? workers : MAX;
+        workers_.reset(new Worker_[size_]);
+        for (size_t i = 0; i < size_; i++) workers_[i].thread = std::thread([this, i] { work_(i); });
+    }
+
+    FlagExecutor(const FlagExecutor&) = delete;
+    FlagExecutor& operator=(const FlagExecutor&) = delete;
+
+    /// @brief Deconstructor. Runs the tasks left, then joins every worker.
+    ~FlagExecutor() {
+        wait();
+        stop_.store(true);
+        for (size_t i = 0; i < size_; i++) unpark_(i);
+        for (size_t i = 0; i < size_; i++) workers_[i].thread.join();
+    }
+
+/// @section Task Functions
+
+    /// @brief Queues a task and wakes one idle worker. From a worker, it goes on the worker's own deque.
+    template <class Fn>
+    void spawn(Fn&& fn) {
+        pending_.fetch_add(1);
+        const size_t self = current_();
+        push_(self != none_ ? self : next_.fetch_add(1) % size_, std::function<void()>(std::forward<Fn>(fn)));
+        // Claimed after the push, so a worker going idle either sees the task or is seen idle here
+        const size_t idle = claimIdle_();
+        if (idle != none_) unpark_(idle);
+    }
+
+    /// @brief Blocks until every task spawned so far, and every task they spawn, has run.
+    /// @note Must not be called from a task.
+    void wait() {
+        std::unique_lock<std::mutex> lock(doneMutex_);
+        done_.wait(lock, [this] { return pending_.load() == 0; });
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the number of workers.
+    size_t size() const { return size_; }
+
+    /// @brief Gets a snapshot of the parked workers.
+    Workers idleWorkers() const { return snapshot_(idle_); }
+
+    /// @brief Gets a snapshot of the workers with queued tasks.
+    Workers busyWorkers() const { return snapshot_(nonEmpty_); }
+
+/// @section Private Members
+private:
+    static constexpr size_t words_ = (MAX + 63) / 64;
+    static constexpr size_t none_ = ~size_t(0);
+
+    struct alignas(64) Worker_ {
+        std::thread thread;
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+        /// @brief Parking: set by a waker, cleared by the worker.
+        std::mutex parkMutex;
+        std::condition_variable parkWake;
+        bool permit = false;
+    };
+
+    size_t size_;
+    std::unique_ptr<Worker_[]> workers_;
+    std::atomic<uint64_t> idle_[words_] = {};
+    std::atomic<uint64_t> nonEmpty_[words_] = {};
+    std::atomic<size_t> next_{0};
+    std::atomic<size_t> pending_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex doneMutex_;
+    std::condition_variable done_;
+
+    /// @brief Gets the index of the calling worker of this executor, or `none_`.
+    size_t current_() const {
+        const auto& who = who_();
+        return who.first == this ? who.second : none_;
+    }
+
+    static std::pair<const void*, size_t>& who_() {
+        static thread_local std::pair<const void*, size_t> who(nullptr, none_);
+        return who;
+    }
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    static Workers snapshot_(const std::atomic<uint64_t>* mask) {
+        Workers out;
+        for (size_t w = 0; w < words_; w++) out.setWord(w, mask[w].load());
+        return out;
+    }
+
+    /// @brief Claims the lowest idle worker by clearing its bit, or returns `none_`.
+    size_t claimIdle_() {
+        for (size_t w = 0; w < words_; w++) {
+            uint64_t x = idle_[w].load();
+            while (x) {
+                const uint64_t bit = x & (~x + 1);
+                if (idle_[w].fetch_and(~bit) & bit) return w * 64 + ctz_(bit);
+                x = idle_[w].load();
+            }
+        }
+        return none_;
+    }
+
+    void unpark_(const size_t& i) {
+        Worker_& worker = workers_[i];
+        {
+            std::lock_guard<std::mutex> lock(worker.parkMutex);
+            worker.permit = true;
+        }
+        worker.parkWake.notify_one();
+    }
+
+    void push_(const size_t& i, std::function<void()>&& task) {
+        Worker_& worker = workers_[i];
+        std::lock_guard<std::mutex> lock(worker.lock);
+        worker.tasks.push_back(std::move(task));
+        if (worker.tasks.size() == 1) nonEmpty_[i / 64].fetch_or(uint64_t(1) << (i % 64));
+    }
+
+    /// @brief Takes the newest task of its own deque (`own`) or the oldest of a victim's.
+    bool take_(const size_t& i, const bool& own, std::function<void()>& task) {
+        Worker_& worker = workers_[i];
+        std::lock_guard<std::mutex> lock(worker.lock);
+        if (worker.tasks.empty()) return false;
+        if (own) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        } else {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+        if (worker.tasks.empty()) nonEmpty_[i / 64].fetch_and(~(uint64_t(1) << (i % 64)));
+        return true;
+    }
+
+    /// @brief Steals from the workers in the non-empty mask, starting after `self`.
+    bool steal_(const size_t& self, std::function<void()>& task) {
+        for (size_t k = 0; k <= words_; k++) {
+            const size_t w = (self / 64 + k) % words_;
+            uint64_t x = nonEmpty_[w].load() & ~(w == self / 64 ? uint64_t(1) << (self % 64) : 0);
+            // Victims after `self` in its own word first, the ones before it on the last pass
+            if (k == 0) x &= self % 64 == 63 ? 0 : ~uint64_t(0) << (self % 64 + 1);
+            else if (k == words_) x &= (uint64_t(1) << (self % 64)) - 1;
+            for (; x; x &= x - 1) {
+                if (take_(w * 64 + ctz_(x), false, task)) return true;
+            }
+        }
+        return false;
+    }
+
+    void finish_() {
+        if (pending_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(doneMutex_);
+            done_.notify_all();
+        }
+    }
+
+    void work_(const size_t& i) {
+        who_() = {this, i};
+        Worker_& worker = workers_[i];
+        const uint64_t bit = uint64_t(1) << (i % 64);
+        std::function<void()> task;
+        for (;;) {
+            if (take_(i, true, task) || steal_(i, task)) {
+                task();
+                task = nullptr;
+                finish_();
+                continue;
+            }
+            // Publish the idle bit, then look again so a spawn in between is not missed
+            idle_[i / 64].fetch_or(bit);
+            bool work = stop_.load();
+            for (size_t w = 0; w < words_ && !work; w++) work = nonEmpty_[w].load() != 0;
+            if (work && (idle_[i / 64].fetch_and(~bit) & bit)) {
+                if (stop_.load()) return;
+                continue;
+            }
+            // Claimed by a waker (or nothing to do): wait for the permit
+            std::unique_lock<std::mutex> lock(worker.parkMutex);
+            worker.parkWake.wait(lock, [&] { return worker.permit; });
+            worker.permit = false;
+            if (stop_.load()) return;
+        }
+    }
+};
+
+#endif // FLAGFIELDEXECUTOR_HPP
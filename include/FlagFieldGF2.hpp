@@ -0,0 +1,241 @@
+/**
+ * @file FlagFieldGF2.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagGF2Matrix class.
+ * @details A matrix over GF(2) with a FlagField row per equation, where
+ * addition is `XOR` and multiplication is `AND`.
+ *
+ * - `multiply()` uses the Method of Four Russians: for each 64 rows of the
+ *   right matrix, 8 tables of all 256 XOR combinations of 8 rows are built
+ *   (one row XOR per entry: entry `m` is entry `m & (m - 1)`, already built,
+ *   XOR the row of the lowest set bit of `m`), so each output row takes 8
+ *   table XORs per 64 columns of the left matrix instead of up to 64 row
+ *   XORs. Output rows are updated a tile of columns at a time so the tables
+ *   stay in cache.
+ * - Gaussian elimination finds pivots by testing one word per row, and row
+ *   XORs start at the pivot's word since the words before it are 0.
+ * - Row XORs are plain word loops the compiler vectorizes.
+ */
+#pragma once
+#ifndef FLAGFIELDGF2_HPP
+#define FLAGFIELDGF2_HPP
+
+#include <FlagFieldVector.hpp>
+
+#include <utility>
+#include <vector>
+
+/// @brief A GF(2) matrix with a runtime number of rows and `COLS` columns.
+/// @note Example usage:
+/// ```
+/// FlagGF2Matrix<64> eqs(64);
+/// eqs[0].set(3);
+/// eqs[0].set(7);       // x3 ^ x7 = b0
+/// FlagField<64> b, x;
+/// if (eqs.solve(b, x)) {}
+/// size_t r = eqs.rank();
+/// ```
+/// @tparam COLS The number of columns (variables).
+template <size_t COLS>
+class FlagGF2Matrix {
+public:
+    using Row = FlagField<COLS, size_t, FlagCheck::Unchecked>;
+
+/// @section Constructors
+
+    /// @brief Constructs a zero matrix of `rows` rows.
+    explicit FlagGF2Matrix(const size_t& rows = 0) : rows_(rows) {}
+
+    /// @brief Makes an identity matrix of `COLS` rows.
+    static FlagGF2Matrix identity() {
+        FlagGF2Matrix m(COLS);
+        for (size_t i = 0; i < COLS; i++) m[i].set(i);
+        return m;
+    }
+
+/// @section Accessors
+
+    Row& operator[](const size_t& i) { return rows_[i]; }
+    const Row& operator[](const size_t& i) const { return rows_[i]; }
+
+    /// @brief Gets the number of rows.
+    size_t rows() const { return rows_.size(); }
+
+    /// @brief Gets the number of columns.
+    static constexpr size_t cols() { return COLS; }
+
+    /// @brief Appends a row.
+    void addRow(const Row& r) { rows_.push_back(r); }
+
+    /// @brief Returns `true` if both matrices have the same rows.
+    bool operator==(const FlagGF2Matrix& other) const {
+        if (rows() != other.rows()) return false;
+        for (size_t i = 0; i < rows(); i++) {
+            for (size_t w = 0; w < Row::numWords(); w++) {
+                if (rows_[i].word(w) != other.rows_[i].word(w)) return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const FlagGF2Matrix& other) const { return !(*this == other); }
+
+/// @section Arithmetic
+
+    /// @brief Multiplies `a * b` with the Method of Four Russians.
+    /// @note `b` must have `K` rows.
+    template <size_t K>
+    static FlagGF2Matrix multiply(const FlagGF2Matrix<K>& a, const FlagGF2Matrix& b) {
+        FlagGF2Matrix c(a.rows());
+        FlagFieldVector<COLS, size_t, FlagCheck::Unchecked> tables(8 * 256);
+        const size_t kWords = (b.rows() + 63) / 64;
+        for (size_t kw = 0; kw < kWords; kw++) {
+            // tables[g * 256 + m] = XOR of the rows of `b` at `64 * kw + 8 * g + bit` for each bit of `m`
+            for (size_t g = 0; g < 8; g++) {
+                tables[g * 256].clear();
+                for (size_t m = 1; m < 256; m++) {
+                    Row& t = tables[g * 256 + m];
+                    t = tables[g * 256 + (m & (m - 1))];
+                    const size_t k = kw * 64 + g * 8 + ctz_(m);
+                    if (k < b.rows()) xorRow_(t, b[k], 0, Row::numWords());
+                }
+            }
+            for (size_t cb = 0; cb < Row::numWords(); cb += tile) {
+                const size_t ce = cb + tile < Row::numWords() ? cb + tile : Row::numWords();
+                for (size_t i = 0; i < a.rows(); i++) {
+                    const uint64_t sel = a[i].word(kw);
+                    if (!sel) continue;
+                    for (size_t g = 0; g < 8; g++) {
+                        const size_t m = (sel >> (8 * g)) & 255;
+                        if (m) xorRow_(c[i], tables[g * 256 + m], cb, ce);
+                    }
+                }
+            }
+        }
+        return c;
+    }
+
+    /// @brief Multiplies by a column vector: `y[i] = parity(row_i & x)`.
+    template <size_t R>
+    void multiply(const Row& x, FlagField<R, size_t, FlagCheck::Unchecked>& y) const {
+        y.clear();
+        for (size_t i = 0; i < rows(); i++) {
+            uint64_t acc = 0;
+            for (size_t w = 0; w < Row::numWords(); w++) acc ^= rows_[i].word(w) & x.word(w);
+            if (parity_(acc)) y.set(i);
+        }
+    }
+
+/// @section Elimination
+
+    /// @brief Brings the matrix to row echelon form in place.
+    /// @param reduced If `true`, also clears the pivot columns above each pivot.
+    /// @return The rank.
+    size_t rowEchelon(const bool& reduced = false) {
+        return eliminate_<Rows_>(rows_, reduced, nullptr, nullptr);
+    }
+
+    /// @brief Gets the rank.
+    size_t rank() const {
+        Rows_ rows = rows_;
+        return eliminate_<Rows_>(rows, false, nullptr, nullptr);
+    }
+
+    /// @brief Inverts a square matrix.
+    /// @return `false` if the matrix is singular (or not square).
+    bool inverse(FlagGF2Matrix& out) const {
+        if (rows() != COLS) return false;
+        Rows_ rows = rows_;
+        out = identity();
+        return eliminate_(rows, true, &out.rows_, nullptr) == COLS;
+    }
+
+    /// @brief Solves `A x = b`, with bit `i` of `b` the right hand side of row `i`.
+    /// @note Free variables are set to 0.
+    /// @return `false` if the system has no solution.
+    template <size_t R, class E, class P>
+    bool solve(const FlagField<R, E, P>& b, Row& x) const {
+        Rows_ rows = rows_;
+        // The right hand side rides along as a one column matrix
+        FlagFieldVector<1, size_t, FlagCheck::Unchecked> rhs(rows.size());
+        for (size_t i = 0; i < rows.size() && i < R; i++) {
+            if ((b.word(i / 64) >> (i % 64)) & 1) rhs[i].set(0);
+        }
+        std::vector<size_t> pivots;
+        const size_t r = eliminate_(rows, true, &rhs, &pivots);
+        for (size_t i = r; i < rows.size(); i++) {
+            if (rhs[i].isSet(0)) return false;
+        }
+        x.clear();
+        for (size_t i = 0; i < r; i++) {
+            if (rhs[i].isSet(0)) x.set(pivots[i]);
+        }
+        return true;
+    }
+
+    /// @brief The number of row words updated together per table pass in `multiply()`.
+    static constexpr size_t tile = 32;
+
+/// @section Private Members
+private:
+    using Rows_ = FlagFieldVector<COLS, size_t, FlagCheck::Unchecked>;
+
+    Rows_ rows_;
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    static bool parity_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_parityll(x);
+#else
+        x ^= x >> 32; x ^= x >> 16; x ^= x >> 8; x ^= x >> 4; x ^= x >> 2; x ^= x >> 1;
+        return x & 1;
+#endif
+    }
+
+    /// @brief `dst ^= src` over words `[wb, we)`.
+    template <class R>
+    static void xorRow_(R& dst, const R& src, const size_t& wb, const size_t& we) {
+        for (size_t w = wb; w < we; w++) dst.setWord(w, dst.word(w) ^ src.word(w));
+    }
+
+    /// @brief Gaussian elimination over `rows`, applying the same row operations to `side`.
+    /// @param pivots If not null, filled with the pivot column of each of the first `rank` rows.
+    /// @return The rank.
+    template <class Side>
+    static size_t eliminate_(Rows_& rows, const bool& reduced, Side* side,
+                             std::vector<size_t>* pivots) {
+        const size_t n = rows.size();
+        size_t r = 0;
+        for (size_t c = 0; c < COLS && r < n; c++) {
+            const size_t w = c / 64;
+            const uint64_t bit = uint64_t(1) << (c % 64);
+            size_t p = r;
+            while (p < n && !(rows[p].word(w) & bit)) p++;
+            if (p == n) continue;
+            if (p != r) {
+                std::swap(rows[p], rows[r]);
+                if (side) std::swap((*side)[p], (*side)[r]);
+            }
+            const Row& pivot = rows[r];
+            for (size_t i = reduced ? 0 : r + 1; i < n; i++) {
+                if (i == r || !(rows[i].word(w) & bit)) continue;
+                xorRow_(rows[i], pivot, w, Row::numWords());
+                if (side) xorRow_((*side)[i], (*side)[r], 0, (*side)[i].numWords());
+            }
+            if (pivots) pivots->push_back(c);
+            r++;
+        }
+        return r;
+    }
+};
+
+#endif // FLAGFIELDGF2_HPP
@@ -0,0 +1,242 @@
+/**
+ * @file FlagFieldGraph.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagGraph class.
+ * @details A bit-matrix graph where each node's adjacency is a FlagField
+ * row, and BFS frontiers and visited sets are FlagFields too.
+ *
+ * BFS is direction optimizing:
+ * - Top-down steps OR the rows of every frontier node into the next
+ *   frontier, then clear visited nodes with one `AND NOT` pass.
+ * - Bottom-up steps test each unvisited node's incoming row against the
+ *   frontier, stopping at the first word that intersects.
+ * - The cheaper step is picked per level from the frontier and unvisited
+ *   node counts. Large levels are split across a FlagThreadPool by words.
+ */
+#pragma once
+#ifndef FLAGFIELDGRAPH_HPP
+#define FLAGFIELDGRAPH_HPP
+
+#include <FlagFieldVector.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <vector>
+
+/// @brief A graph of up to `N` nodes stored as an adjacency bit-matrix of FlagField rows.
+/// @note Example usage:
+/// ```
+/// FlagGraph<4096> g(numNodes);
+/// g.addEdge(0, 1);
+/// auto visited = g.bfs(0);
+/// if (g.reachable(0, 42)) {}
+/// ```
+/// @tparam N The maximum number of nodes.
+template <size_t N>
+class FlagGraph {
+public:
+    using Row = FlagField<N, size_t, FlagCheck::Unchecked>;
+
+    /// @brief The depth of nodes not reached by a BFS.
+    static constexpr uint32_t unreached = ~uint32_t(0);
+
+/// @section Constructors
+
+    /// @brief Constructs a graph of `numNodes` nodes and no edges.
+    /// @note Directed graphs also keep the transposed matrix for bottom-up steps.
+    explicit FlagGraph(const size_t& numNodes = N, const bool& directed = false)
+        : n_(numNodes < N ? numNodes : N), directed_(directed),
+          out_(n_), in_(directed ? n_ : 0) {}
+
+/// @section Graph Functions
+
+    /// @brief Adds an edge (both ways for undirected graphs).
+    void addEdge(const size_t& u, const size_t& v) {
+        out_[u].set(v);
+        if (directed_) in_[v].set(u);
+        else out_[v].set(u);
+    }
+
+    /// @brief Returns `true` if there is an edge from `u` to `v`.
+    bool hasEdge(const size_t& u, const size_t& v) const { return out_[u].isSet(v); }
+
+    /// @brief Gets the nodes `u` has an edge to.
+    const Row& neighbors(const size_t& u) const { return out_[u]; }
+
+    /// @brief Gets the number of nodes.
+    size_t numNodes() const { return n_; }
+
+    /// @brief Gets the number of edges (undirected edges count once).
+    size_t numEdges() const {
+        size_t count = 0;
+        for (const Row& r : out_) count += r.numSetFlags();
+        return directed_ ? count : (count + countSelfLoops_()) / 2;
+    }
+
+    /// @brief Splits BFS levels with at least `minWork` frontier or unvisited nodes across a pool.
+    void setThreadPool(FlagThreadPool* pool, const size_t& minWork = 1024) {
+        pool_ = pool;
+        minWork_ = minWork;
+    }
+
+    /// @brief Sets the bottom-up switch: bottom-up runs when `frontier * alpha > unvisited`.
+    void setAlpha(const size_t& alpha) { alpha_ = alpha; }
+
+/// @section Traversal Functions
+
+    /// @brief Runs a BFS from `source` following edge directions.
+    /// @param depth If not null, filled with each node's depth or `unreached`.
+    /// @return The set of nodes reached.
+    Row bfs(const size_t& source, std::vector<uint32_t>* depth = nullptr) const {
+        return bfs_(source, false, n_, depth);
+    }
+
+    /// @brief Returns `true` if `v` can be reached from `u`.
+    bool reachable(const size_t& u, const size_t& v) const {
+        return bfs_(u, false, v, nullptr).isSet(v);
+    }
+
+    /// @brief Labels the connected components (weakly connected for directed graphs).
+    /// @return The number of components.
+    size_t connectedComponents(std::vector<size_t>& labels) const {
+        labels.assign(n_, 0);
+        Row seen;
+        size_t count = 0;
+        for (size_t w = 0; w < Row::numWords(); w++) {
+            for (;;) {
+                uint64_t free = ~seen.word(w) & validMask_(w);
+                if (!free) break;
+                const size_t root = w * 64 + ctz_(free);
+                const Row comp = bfs_(root, true, n_, nullptr);
+                forEach_(comp, [&](size_t v) { labels[v] = count; });
+                seen |= comp;
+                count++;
+            }
+        }
+        return count;
+    }
+
+/// @section Private Members
+private:
+    size_t n_;
+    bool directed_;
+    FlagFieldVector<N, size_t, FlagCheck::Unchecked> out_, in_;
+    FlagThreadPool* pool_ = nullptr;
+    size_t minWork_ = 1024;
+    size_t alpha_ = 8;
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    /// @brief Gets a mask of the nodes of the graph in word `w`.
+    uint64_t validMask_(const size_t& w) const {
+        if ((w + 1) * 64 <= n_) return ~uint64_t(0);
+        if (w * 64 >= n_) return 0;
+        return (uint64_t(1) << (n_ % 64)) - 1;
+    }
+
+    size_t countSelfLoops_() const {
+        size_t count = 0;
+        for (size_t u = 0; u < n_; u++) count += out_[u].isSet(u);
+        return count;
+    }
+
+    /// @brief Calls `fn(index)` for every set flag.
+    template <class Fn>
+    static void forEach_(const Row& r, Fn&& fn) {
+        for (size_t w = 0; w < Row::numWords(); w++) {
+            for (uint64_t x = r.word(w); x; x &= x - 1) fn(w * 64 + ctz_(x));
+        }
+    }
+
+    /// @brief Runs `fn(wBegin, wEnd)` over the row words, on the pool if the level is large.
+    template <class Fn>
+    void forWords_(const size_t& work, Fn&& fn) const {
+        if (pool_ && work >= minWork_) {
+            pool_->parallelFor(Row::numWords(), fn);
+        } else {
+            fn(size_t(0), Row::numWords());
+        }
+    }
+
+    /// @brief Top-down step: `next = (OR of the frontier's rows) & ~visited`.
+    void topDown_(const Row& frontier, const Row& visited, Row& next, const bool& weak,
+                  const size_t& size) const {
+        std::vector<size_t> nodes;
+        nodes.reserve(size);
+        forEach_(frontier, [&](size_t u) { nodes.push_back(u); });
+        forWords_(size, [&](size_t wb, size_t we) {
+            for (size_t w = wb; w < we; w++) next.setWord(w, 0);
+            for (size_t u : nodes) {
+                const Row& r = out_[u];
+                for (size_t w = wb; w < we; w++) next.setWord(w, next.word(w) | r.word(w));
+                if (weak && directed_) {
+                    const Row& t = in_[u];
+                    for (size_t w = wb; w < we; w++) next.setWord(w, next.word(w) | t.word(w));
+                }
+            }
+            for (size_t w = wb; w < we; w++) next.setWord(w, next.word(w) & ~visited.word(w) & validMask_(w));
+        });
+    }
+
+    /// @brief Bottom-up step: unvisited nodes with an incoming edge from the frontier join `next`.
+    void bottomUp_(const Row& frontier, const Row& visited, Row& next, const bool& weak,
+                   const size_t& size) const {
+        const auto& incoming = directed_ ? in_ : out_;
+        forWords_(size, [&](size_t wb, size_t we) {
+            for (size_t w = wb; w < we; w++) {
+                uint64_t found = 0;
+                for (uint64_t x = ~visited.word(w) & validMask_(w); x; x &= x - 1) {
+                    const size_t v = w * 64 + ctz_(x);
+                    if (intersects_(incoming[v], frontier) ||
+                        (weak && directed_ && intersects_(out_[v], frontier))) {
+                        found |= x & (0 - x);
+                    }
+                }
+                next.setWord(w, found);
+            }
+        });
+    }
+
+    /// @brief Returns `true` at the first word where two rows share a flag.
+    static bool intersects_(const Row& a, const Row& b) {
+        for (size_t w = 0; w < Row::numWords(); w++) {
+            if (a.word(w) & b.word(w)) return true;
+        }
+        return false;
+    }
+
+    /// @brief Direction optimizing BFS, stopping early once `target` is reached.
+    Row bfs_(const size_t& source, const bool& weak, const size_t& target,
+             std::vector<uint32_t>* depth) const {
+        Row visited, frontier, next;
+        if (depth) depth->assign(n_, unreached);
+        if (source >= n_) return visited;
+        visited.set(source);
+        frontier.set(source);
+        if (depth) (*depth)[source] = 0;
+        size_t fcount = 1, vcount = 1;
+        for (uint32_t level = 1; fcount && !(target < n_ && visited.isSet(target)); level++) {
+            const size_t ucount = n_ - vcount;
+            if (fcount * alpha_ > ucount) {
+                bottomUp_(frontier, visited, next, weak, ucount);
+            } else {
+                topDown_(frontier, visited, next, weak, fcount);
+            }
+            visited |= next;
+            fcount = next.numSetFlags();
+            vcount += fcount;
+            if (depth) forEach_(next, [&](size_t v) { (*depth)[v] = level; });
+            std::swap(frontier, next);
+        }
+        return visited;
+    }
+};
+
+#endif // FLAGFIELDGRAPH_HPP
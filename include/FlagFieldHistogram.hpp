@@ -0,0 +1,274 @@
+/**
+ * @file FlagFieldHistogram.hpp
+ * @author Ray Richter
+ * @brief Per flag counts across arrays of FlagFields.
+ * @details Counts how many FlagFields have each flag set with bit-sliced
+ * vertical counters instead of testing every flag of every FlagField:
+ * - Rows are read as a stream of words, a chunk of `lanes` words (a multiple
+ *   of both 4 and the words per row) at a time.
+ * - Every 16 chunks are reduced with the Harley-Seal tree of `FlagBitmap`
+ *   to one "sixteens" word per lane, leaving the remainders in running ones,
+ *   twos, fours and eights words.
+ * - The sixteens words are added into 16 bit-sliced counter planes, which
+ *   are only spread into the 64 bit per flag counts every 65535 additions.
+ *
+ * Lanes are processed 4 words per AVX2 register when compiled with AVX2
+ * support (`__AVX2__`), and one word at a time otherwise.
+ */
+#pragma once
+#ifndef FLAGFIELDHISTOGRAM_HPP
+#define FLAGFIELDHISTOGRAM_HPP
+
+#include <FlagField.hpp>
+#include <FlagFieldBitmap.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <array>
+#include <memory>
+#include <mutex>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/// @brief Running per flag counts over FlagFields of `MAX` flags.
+/// @note Example usage:
+/// ```
+/// FlagHistogram<MAX> h;
+/// h.add(rows.data(), rows.size());
+/// uint64_t withA = h.counts()[A];
+/// ```
+/// @tparam MAX The number of flags.
+template <size_t MAX>
+class FlagHistogram {
+public:
+    /// @brief The number of words in a row.
+    static constexpr size_t words = (MAX + 63) / 64;
+    /// @brief The number of words counted side by side (the lowest multiple of 4 holding whole rows).
+    static constexpr size_t lanes = words % 4 == 0 ? words : (words % 2 == 0 ? 2 * words : 4 * words);
+    /// @brief The number of rows in a chunk of `lanes` words.
+    static constexpr size_t rowsPerChunk = lanes / words;
+
+/// @section Counting Functions
+
+    /// @brief Adds `n` FlagFields to the counts.
+    template <class E, class P>
+    void add(const FlagField<MAX, E, P>* rows, const size_t& n) {
+        count_<false>(rows, n, nullptr, 0);
+    }
+
+    /// @brief Adds `n` FlagFields to the counts, each counting `weights[i]` times.
+    /// @note Runs one pass per significant bit of the largest weight. Counts wrap modulo 2^64.
+    template <class E, class P>
+    void add(const FlagField<MAX, E, P>* rows, const size_t& n, const uint64_t* weights) {
+        uint64_t all = 0;
+        for (size_t i = 0; i < n; i++) all |= weights[i];
+        for (unsigned bit = 0; bit < 64 && (all >> bit); bit++) {
+            if ((all >> bit) & 1) count_<true>(rows, n, weights, bit);
+        }
+    }
+
+    /// @brief Adds the counts of another histogram.
+    void merge(const FlagHistogram& other) {
+        for (size_t i = 0; i < MAX; i++) counts_[i] += other.counts_[i];
+    }
+
+    /// @brief Clears the counts.
+    void clear() { counts_.fill(0); }
+
+    /// @brief Gets the number of FlagFields counted with each flag set.
+    const std::array<uint64_t, MAX>& counts() const { return counts_; }
+
+/// @section Private Members
+private:
+    std::array<uint64_t, MAX> counts_{};
+
+#ifdef __AVX2__
+    using V_ = __m256i;
+    static constexpr size_t step_ = 4;
+    static V_ load_(const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const V_*>(p)); }
+    static void store_(uint64_t* p, const V_& v) { _mm256_storeu_si256(reinterpret_cast<V_*>(p), v); }
+    static V_ and_(const V_& a, const V_& b) { return _mm256_and_si256(a, b); }
+    static V_ xor_(const V_& a, const V_& b) { return _mm256_xor_si256(a, b); }
+    static V_ zero_() { return _mm256_setzero_si256(); }
+    static bool isZero_(const V_& v) { return _mm256_testz_si256(v, v); }
+#else
+    using V_ = uint64_t;
+    static constexpr size_t step_ = 1;
+    static V_ load_(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+    static void store_(uint64_t* p, const V_& v) { *p = v; }
+    static V_ and_(const V_& a, const V_& b) { return a & b; }
+    static V_ xor_(const V_& a, const V_& b) { return a ^ b; }
+    static V_ zero_() { return 0; }
+    static bool isZero_(const V_& v) { return v == 0; }
+#endif
+    static constexpr size_t vecs_ = lanes / step_;
+
+    /// @brief Working set of one count, kept off the stack since it grows with MAX.
+    struct Scratch_ {
+        uint8_t buffer[16][lanes * 8];
+        uint64_t masks[16][lanes];
+        uint64_t spill[lanes];
+        V_ ones[vecs_], twos[vecs_], fours[vecs_], eights[vecs_], planes[16][vecs_];
+    };
+
+    static size_t ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_ctzll(x));
+#else
+        size_t n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    /// @brief Adds `(bit b of word) << shift` to the count of each flag for every lane word.
+    /// @note Counts wrap modulo 2^64, so nothing is added for shifts of 64 and over.
+    void spread_(const uint64_t* lanesWords, const unsigned& shift) {
+        if (shift >= 64) return;
+        for (size_t l = 0; l < lanes; l++) {
+            const size_t base = (l % words) * 64;
+            for (uint64_t x = lanesWords[l]; x; x &= x - 1) {
+                const size_t i = base + ctz_(x);
+                if (i < MAX) counts_[i] += uint64_t(1) << shift;
+            }
+        }
+    }
+
+    void spreadLanes_(const V_* v, const unsigned& shift, uint64_t* w) {
+        for (size_t i = 0; i < vecs_; i++) store_(w + i * step_, v[i]);
+        spread_(w, shift);
+    }
+
+    /// @brief Counts `n` rows, keeping only rows with bit `bit` of their weight set when `Weighted`.
+    template <bool Weighted, class E, class P>
+    void count_(const FlagField<MAX, E, P>* rows, const size_t& n, const uint64_t* weights,
+                const unsigned& bit) {
+        using Row = FlagField<MAX, E, P>;
+#ifdef FF_LITTLE_ENDIAN
+        constexpr bool packed = sizeof(Row) == 8 * words;
+#else
+        constexpr bool packed = false;
+#endif
+        // Value initialized, so every counter starts at zero
+        const auto scratch = std::make_unique<Scratch_>();
+        auto& buffer = scratch->buffer;
+        auto& masks = scratch->masks;
+        auto& ones = scratch->ones;
+        auto& twos = scratch->twos;
+        auto& fours = scratch->fours;
+        auto& eights = scratch->eights;
+        auto& planes = scratch->planes;
+
+        // Gets chunk `c` as raw little endian words, copying them out of unpacked rows
+        auto chunk = [&](const size_t& c, uint8_t* buf) -> const uint8_t* {
+            const Row* r = rows + c * rowsPerChunk;
+            if (packed) return reinterpret_cast<const uint8_t*>(r);
+            for (size_t k = 0; k < rowsPerChunk; k++) {
+                for (size_t w = 0; w < words; w++) {
+                    const uint64_t x = r[k].word(w);
+                    std::memcpy(buf + (k * words + w) * 8, &x, 8);
+                }
+            }
+            return buf;
+        };
+        // All 1s on the lanes of rows with the weight bit set
+        auto mask = [&](const size_t& c, uint64_t* m) {
+            for (size_t k = 0; k < rowsPerChunk; k++) {
+                const uint64_t keep = uint64_t(0) - ((weights[c * rowsPerChunk + k] >> bit) & 1);
+                for (size_t w = 0; w < words; w++) m[k * words + w] = keep;
+            }
+        };
+
+        size_t pending = 0;
+        auto flushPlanes = [&] {
+            for (size_t j = 0; j < 16; j++) {
+                spreadLanes_(planes[j], unsigned(j + 4 + bit), scratch->spill);
+                for (size_t i = 0; i < vecs_; i++) planes[j][i] = zero_();
+            }
+            pending = 0;
+        };
+
+        const size_t chunks = n / rowsPerChunk;
+        size_t c = 0;
+        for (; c + 16 <= chunks; c += 16) {
+            const uint8_t* p[16];
+            for (size_t k = 0; k < 16; k++) {
+                p[k] = chunk(c + k, buffer[k]);
+                if (Weighted) mask(c + k, masks[k]);
+            }
+            for (size_t i = 0; i < vecs_; i++) {
+                const size_t off = i * step_ * 8;
+                auto in = [&](const size_t& k) {
+                    const V_ x = load_(p[k] + off);
+                    return Weighted ? and_(x, load_(reinterpret_cast<const uint8_t*>(masks[k]) + off)) : x;
+                };
+                V_ sixteens = FlagBitmap::harleySeal16(ones[i], twos[i], fours[i], eights[i], in);
+                // Ripple the sixteens into the counter planes
+                for (size_t j = 0; j < 16 && !isZero_(sixteens); j++) {
+                    const V_ carry = and_(planes[j][i], sixteens);
+                    planes[j][i] = xor_(planes[j][i], sixteens);
+                    sixteens = carry;
+                }
+            }
+            if (++pending == 65535) flushPlanes();
+        }
+        flushPlanes();
+        spreadLanes_(ones, bit, scratch->spill);
+        spreadLanes_(twos, bit + 1, scratch->spill);
+        spreadLanes_(fours, bit + 2, scratch->spill);
+        spreadLanes_(eights, bit + 3, scratch->spill);
+
+        // Leftover rows one at a time
+        for (size_t r = c * rowsPerChunk; r < n; r++) {
+            if (Weighted && !((weights[r] >> bit) & 1)) continue;
+            for (size_t w = 0; w < words; w++) {
+                for (uint64_t x = rows[r].word(w); x; x &= x - 1) {
+                    counts_[w * 64 + ctz_(x)] += uint64_t(1) << bit;
+                }
+            }
+        }
+    }
+};
+
+/// @brief Counts how many of `n` FlagFields have each flag set.
+/// @param pool If not null, rows are split across the pool and the counts summed.
+template <size_t MAX, class E, class P>
+std::array<uint64_t, MAX> histogram(const FlagField<MAX, E, P>* rows, const size_t& n,
+                                    FlagThreadPool* pool = nullptr) {
+    FlagHistogram<MAX> total;
+    std::mutex lock;
+    auto part = [&](size_t begin, size_t end) {
+        FlagHistogram<MAX> h;
+        h.add(rows + begin, end - begin);
+        std::lock_guard<std::mutex> guard(lock);
+        total.merge(h);
+    };
+    if (pool) pool->parallelFor(n, part);
+    else part(0, n);
+    return total.counts();
+}
+
+/// @brief Sums `weights[i]` into each flag set in FlagField `i`.
+/// @param pool If not null, rows are split across the pool and the counts summed.
+template <size_t MAX, class E, class P>
+std::array<uint64_t, MAX> histogram(const FlagField<MAX, E, P>* rows, const size_t& n,
+                                    const uint64_t* weights, FlagThreadPool* pool = nullptr) {
+    FlagHistogram<MAX> total;
+    std::mutex lock;
+    auto part = [&](size_t begin, size_t end) {
+        FlagHistogram<MAX> h;
+        h.add(rows + begin, end - begin, weights + begin);
+        std::lock_guard<std::mutex> guard(lock);
+        total.merge(h);
+    };
+    if (pool) pool->parallelFor(n, part);
+    else part(0, n);
+    return total.counts();
+}
+
+#endif // FLAGFIELDHISTOGRAM_HPP
@@ -0,0 +1,246 @@
+/**
+ * @file FlagFieldMark.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagMarkBitmap class.
+ * @details A garbage collector mark bitmap with one bit per `GRANULE` bytes
+ * of heap, kept in atomic words laid out like a FlagField:
+ * - `tryMark()` is one `fetch_or`, after a plain load that skips the atomic
+ *   when the bit is already set. Exactly one of the threads marking the same
+ *   granule sees true, so marking can run on many threads.
+ * - Sweeping finds the free runs (the gaps between marked granules) a word
+ *   at a time with count trailing zeros, instead of testing every bit.
+ * - The bitmap is cleared either eagerly, word stores split across a
+ *   FlagThreadPool, or lazily: `nextEpoch()` is O(1) and each 64 word chunk
+ *   is zeroed by the first marker to touch it in the new epoch.
+ */
+#pragma once
+#ifndef FLAGFIELDMARK_HPP
+#define FLAGFIELDMARK_HPP
+
+#include <FlagField.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+/// @brief A mark bitmap over a heap of `bytes` bytes starting at `base`, one bit per `GRANULE` bytes.
+/// @note Example usage:
+/// ```
+/// FlagMarkBitmap<16> marks(heapBase, heapBytes);
+/// // Marking, on any number of threads
+/// if (marks.tryMark(object)) marks.markRange(object, sizeOf(object)), push(object);
+/// // Sweeping
+/// marks.sweep([&](void* begin, size_t bytes) { freeList.add(begin, bytes); });
+/// marks.nextEpoch();
+/// ```
+/// @tparam GRANULE The bytes per mark bit, a power of two. Default = 16.
+template <size_t GRANULE = 16>
+class FlagMarkBitmap {
+    static_assert(GRANULE > 0 && (GRANULE & (GRANULE - 1)) == 0, "GRANULE must be a power of two");
+public:
+    /// @brief The number of words zeroed together by a lazy clear.
+    static constexpr size_t chunkWords = 64;
+
+/// @section Constructors
+
+    /// @brief Constructs an unmarked bitmap over `[base, base + bytes)`.
+    FlagMarkBitmap(const void* base, const size_t& bytes)
+        : base_(reinterpret_cast<uintptr_t>(base)), granules_((bytes + GRANULE - 1) / GRANULE),
+          words_((granules_ + 63) / 64), chunks_((words_ + chunkWords - 1) / chunkWords),
+          bits_(new std::atomic<uint64_t>[words_]), epochs_(new std::atomic<uint32_t>[chunks_]) {
+        for (size_t w = 0; w < words_; w++) bits_[w].store(0, std::memory_order_relaxed);
+        for (size_t c = 0; c < chunks_; c++) epochs_[c].store(0, std::memory_order_relaxed);
+    }
+
+/// @section Marking Functions
+
+    /// @brief Marks the granule holding `p`. Safe to call from any thread.
+    /// @return True if this call marked it first.
+    bool tryMark(const void* p) { return tryMarkGranule(granule(p)); }
+
+    /// @brief Marks granule `i`. Safe to call from any thread.
+    /// @return True if this call marked it first.
+    bool tryMarkGranule(const size_t& i) {
+        const size_t w = i / 64;
+        ensure_(w / chunkWords);
+        const uint64_t bit = uint64_t(1) << (i % 64);
+        if (bits_[w].load(std::memory_order_relaxed) & bit) return false;
+        return !(bits_[w].fetch_or(bit, std::memory_order_relaxed) & bit);
+    }
+
+    /// @brief Marks every granule of `[p, p + bytes)`, e.g. a live object's extent. Safe to call from any thread.
+    void markRange(const void* p, const size_t& bytes) {
+        if (!bytes) return;
+        const size_t first = granule(p);
+        const size_t last = granule(static_cast<const char*>(p) + bytes - 1);
+        for (size_t w = first / 64; w <= last / 64; w++) {
+            ensure_(w / chunkWords);
+            uint64_t mask = ~uint64_t(0);
+            if (w == first / 64) mask &= ~uint64_t(0) << (first % 64);
+            if (w == last / 64) mask &= ~uint64_t(0) >> (63 - last % 64);
+            if ((bits_[w].load(std::memory_order_relaxed) & mask) != mask) {
+                bits_[w].fetch_or(mask, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief Marks the granules holding `n` pointers, split across a pool.
+    /// @return The number of granules this call marked first.
+    size_t markAll(const void* const* pointers, const size_t& n, FlagThreadPool* pool = nullptr) {
+        std::atomic<size_t> marked(0);
+        auto part = [&](size_t begin, size_t end) {
+            size_t mine = 0;
+            for (size_t i = begin; i < end; i++) mine += tryMark(pointers[i]);
+            marked += mine;
+        };
+        if (pool) pool->parallelFor(n, part);
+        else part(0, n);
+        return marked;
+    }
+
+/// @section Clearing Functions
+
+    /// @brief Unmarks everything now, with word stores split across a pool.
+    void clear(FlagThreadPool* pool = nullptr) {
+        auto part = [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                const size_t last = (c + 1) * chunkWords < words_ ? (c + 1) * chunkWords : words_;
+                for (size_t w = c * chunkWords; w < last; w++) bits_[w].store(0, std::memory_order_relaxed);
+                epochs_[c].store(epoch_, std::memory_order_relaxed);
+            }
+        };
+        if (pool) pool->parallelFor(chunks_, part);
+        else part(0, chunks_);
+    }
+
+    /// @brief Unmarks everything in O(1); each chunk is zeroed when next marked.
+    /// @note Not safe while other threads mark.
+    void nextEpoch() {
+        if (++epoch_ == busy_) {
+            // Wrapped: old chunk tags could look current again
+            epoch_ = 0;
+            clear();
+        }
+    }
+
+/// @section Scanning Functions
+
+    /// @brief Gets the first marked granule at or after `i`, or `granules()`.
+    size_t nextMarked(const size_t& i) const { return next_(i, false); }
+
+    /// @brief Gets the first unmarked granule at or after `i`, or `granules()`.
+    size_t nextFree(const size_t& i) const { return next_(i, true); }
+
+    /// @brief Calls `fn(begin, bytes)` for each run of unmarked granules of at least `minBytes`, in address order.
+    /// @note Not safe while other threads mark.
+    template <class Fn>
+    void sweep(Fn&& fn, const size_t& minBytes = GRANULE) const {
+        const size_t minGranules = minBytes > GRANULE ? (minBytes + GRANULE - 1) / GRANULE : 1;
+        for (size_t i = nextFree(0); i < granules_;) {
+            const size_t end = nextMarked(i);
+            if (end - i >= minGranules) fn(reinterpret_cast<void*>(base_ + i * GRANULE), (end - i) * GRANULE);
+            i = nextFree(end);
+        }
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the granule index of an address.
+    size_t granule(const void* p) const { return size_t(reinterpret_cast<uintptr_t>(p) - base_) / GRANULE; }
+
+    /// @brief Gets the number of granules.
+    size_t granules() const { return granules_; }
+
+    /// @brief Checks if the granule holding `p` is marked.
+    bool isMarked(const void* p) const {
+        const size_t i = granule(p);
+        return (word_(i / 64) >> (i % 64)) & 1;
+    }
+
+    /// @brief Gets the number of marked granules.
+    size_t marked() const {
+        size_t n = 0;
+        for (size_t w = 0; w < words_; w++) n += popcount_(word_(w));
+        return n;
+    }
+
+    /// @brief Copies the marks of granules `[first, first + MAX)` into a FlagField.
+    template <size_t MAX, class E, class P>
+    void copyTo(const size_t& first, FlagField<MAX, E, P>& out) const {
+        for (size_t k = 0; k < out.numWords(); k++) {
+            const size_t i = first + k * 64, w = i / 64, o = i % 64;
+            uint64_t x = w < words_ ? word_(w) >> o : 0;
+            if (o && w + 1 < words_) x |= word_(w + 1) << (64 - o);
+            out.setWord(k, x);
+        }
+    }
+
+/// @section Private Members
+private:
+    static constexpr uint32_t busy_ = ~uint32_t(0);
+
+    const uintptr_t base_;
+    const size_t granules_, words_, chunks_;
+    std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+    /// @brief The epoch each chunk was last zeroed in, or `busy_` while a marker zeroes it.
+    std::unique_ptr<std::atomic<uint32_t>[]> epochs_;
+    uint32_t epoch_ = 0;
+
+    /// @brief Zeroes a chunk left from an earlier epoch, or waits for the thread zeroing it.
+    void ensure_(const size_t& c) {
+        uint32_t e = epochs_[c].load(std::memory_order_acquire);
+        while (e != epoch_) {
+            if (e != busy_ && epochs_[c].compare_exchange_weak(e, busy_, std::memory_order_acquire)) {
+                const size_t last = (c + 1) * chunkWords < words_ ? (c + 1) * chunkWords : words_;
+                for (size_t w = c * chunkWords; w < last; w++) bits_[w].store(0, std::memory_order_relaxed);
+                epochs_[c].store(epoch_, std::memory_order_release);
+                return;
+            }
+            if (e == busy_) std::this_thread::yield();
+            e = epochs_[c].load(std::memory_order_acquire);
+        }
+    }
+
+    /// @brief Gets word `w`, as zero if its chunk is from an earlier epoch.
+    uint64_t word_(const size_t& w) const {
+        if (epochs_[w / chunkWords].load(std::memory_order_acquire) != epoch_) return 0;
+        return bits_[w].load(std::memory_order_relaxed);
+    }
+
+    /// @brief Gets the first granule at or after `i` that is marked (or, if `invert`, unmarked).
+    size_t next_(const size_t& i, const bool& invert) const {
+        if (i >= granules_) return granules_;
+        size_t w = i / 64;
+        uint64_t x = (invert ? ~word_(w) : word_(w)) & (~uint64_t(0) << (i % 64));
+        while (!x) {
+            if (++w == words_) return granules_;
+            x = invert ? ~word_(w) : word_(w);
+        }
+        const size_t found = w * 64 + ctz_(x);
+        return found < granules_ ? found : granules_;
+    }
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    static size_t popcount_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_popcountll(x));
+#else
+        size_t n = 0;
+        for (; x; x &= x - 1) n++;
+        return n;
+#endif
+    }
+};
+
+#endif // FLAGFIELDMARK_HPP
@@ -0,0 +1,275 @@
+/**
+ * @file FlagFieldMatch.hpp
+ * @author Ray Richter
+ * @brief Bit-parallel string matching on FlagField state.
+ * @details Both matchers keep a FlagField mask per character, with bit `i`
+ * set where the pattern holds that character, and scan the text one
+ * character at a time with word operations on a FlagField state. Patterns
+ * may be up to `MAXLEN` characters long; shifts and additions carry from
+ * word to word.
+ * - `FlagShiftOr` finds exact matches. Only the words holding a partial
+ *   match are updated, and while no partial match is longer than 64
+ *   characters the first word runs alone in a register.
+ * - `FlagMyers` finds matches with up to `k` edits (Myers' bit-vector
+ *   algorithm in Hyyrö's formulation), one 64 row block at a time with the
+ *   horizontal delta carried between blocks. Blocks whose rows are all
+ *   past `k` are skipped (Ukkonen's cutoff), so the cost depends on `k`
+ *   rather than the pattern length. While only the first block is active
+ *   it runs alone in registers.
+ */
+#pragma once
+#ifndef FLAGFIELDMATCH_HPP
+#define FLAGFIELDMATCH_HPP
+
+#include <FlagFieldVector.hpp>
+
+#include <string>
+#include <vector>
+
+/// @brief Per character masks of a pattern.
+/// @tparam MAXLEN The maximum pattern length.
+template <size_t MAXLEN>
+class FlagPatternMasks {
+public:
+    using Mask = FlagField<MAXLEN, size_t, FlagCheck::Unchecked>;
+
+    /// @brief Builds the masks of the first `len` characters of `pattern` (at most `MAXLEN`).
+    FlagPatternMasks(const char* pattern, const size_t& len)
+        : m_(len < MAXLEN ? len : MAXLEN), masks_(256) {
+        for (size_t i = 0; i < m_; i++) masks_[uint8_t(pattern[i])].set(i);
+    }
+
+    /// @brief Gets the mask of a character.
+    const Mask& operator[](const uint8_t& c) const { return masks_[c]; }
+
+    /// @brief Gets the pattern length.
+    size_t length() const { return m_; }
+
+    /// @brief Gets the number of words spanned by the pattern.
+    size_t numWords() const { return (m_ + 63) / 64; }
+
+private:
+    size_t m_;
+    FlagFieldVector<MAXLEN, size_t, FlagCheck::Unchecked> masks_;
+};
+
+/// @brief Exact matching with the Shift-Or algorithm.
+/// @note Example usage:
+/// ```
+/// FlagShiftOr<256> m("connection reset");
+/// m.search(log, logSize, [&](size_t end) { /* match in [end - 15, end] */ });
+/// ```
+/// @tparam MAXLEN The maximum pattern length.
+template <size_t MAXLEN>
+class FlagShiftOr {
+public:
+    using Mask = typename FlagPatternMasks<MAXLEN>::Mask;
+
+/// @section Constructors
+
+    FlagShiftOr(const char* pattern, const size_t& len) : masks_(pattern, len) {}
+    explicit FlagShiftOr(const std::string& pattern) : FlagShiftOr(pattern.data(), pattern.size()) {}
+
+/// @section Matching Functions
+
+    /// @brief Gets the pattern length.
+    size_t length() const { return masks_.length(); }
+
+    /// @brief Calls `fn(end)` with the index of the last character of every match.
+    template <class Fn>
+    void search(const char* text, const size_t& n, Fn&& fn) const {
+        const size_t m = masks_.length();
+        if (m == 0) return;
+        const size_t last = (m - 1) / 64;
+        const uint64_t hit = uint64_t(1) << ((m - 1) % 64);
+        if (last == 0) {
+            // One word: keep the state in a register
+            uint64_t s = ~uint64_t(0);
+            for (size_t j = 0; j < n; j++) {
+                s = (s << 1) | ~masks_[uint8_t(text[j])].word(0);
+                if (!(s & hit)) fn(j);
+            }
+            return;
+        }
+        // Bit `i` of the state is 0 while the last `i + 1` characters match the pattern's first `i + 1`.
+        // Words above `top` are all 1s and stay that way until a partial match shifts into them.
+        Mask state;
+        state.set();
+        size_t top = 0;
+        for (size_t j = 0; j < n; j++) {
+            if (top == 0) {
+                // No partial match past the first word: run it in a register until one shifts out
+                uint64_t s = state.word(0);
+                while (j < n && (s >> 63)) s = (s << 1) | ~masks_[uint8_t(text[j++])].word(0);
+                state.setWord(0, s);
+                if (j == n) break;
+            }
+            const Mask& mask = masks_[uint8_t(text[j])];
+            uint64_t carry = 0;
+            const size_t end = top < last ? top + 1 : last;
+            for (size_t w = 0; w <= end; w++) {
+                const uint64_t s = state.word(w);
+                state.setWord(w, (s << 1 | carry) | ~mask.word(w));
+                carry = s >> 63;
+            }
+            if (end > top && ~state.word(end)) top = end;
+            while (top > 0 && !~state.word(top)) top--;
+            if (!(state.word(last) & hit)) fn(j);
+        }
+    }
+
+    /// @brief Counts the matches in a text.
+    size_t count(const char* text, const size_t& n) const {
+        size_t c = 0;
+        search(text, n, [&](size_t) { c++; });
+        return c;
+    }
+
+/// @section Private Members
+private:
+    FlagPatternMasks<MAXLEN> masks_;
+};
+
+/// @brief Approximate matching with Myers' bit-vector algorithm.
+/// @note Example usage:
+/// ```
+/// FlagMyers<1024> m(pattern);
+/// m.search(log, logSize, 3, [&](size_t end, size_t edits) {});
+/// ```
+/// @tparam MAXLEN The maximum pattern length.
+template <size_t MAXLEN>
+class FlagMyers {
+public:
+    using Mask = typename FlagPatternMasks<MAXLEN>::Mask;
+
+/// @section Constructors
+
+    FlagMyers(const char* pattern, const size_t& len) : masks_(pattern, len) {}
+    explicit FlagMyers(const std::string& pattern) : FlagMyers(pattern.data(), pattern.size()) {}
+
+/// @section Matching Functions
+
+    /// @brief Gets the pattern length.
+    size_t length() const { return masks_.length(); }
+
+    /// @brief Calls `fn(end, edits)` for every text index where a match with at most `k` edits ends.
+    template <class Fn>
+    void search(const char* text, const size_t& n, const size_t& k, Fn&& fn) const {
+        const size_t m = masks_.length();
+        if (m == 0) return;
+        const size_t last = (m - 1) / 64;
+        if (last == 0) {
+            // One block: keep the state in registers
+            uint64_t p = ~uint64_t(0), q = 0;
+            const uint64_t high = uint64_t(1) << (m - 1);
+            size_t score = m;
+            for (size_t j = 0; j < n; j++) {
+                score += step_(p, q, masks_[uint8_t(text[j])].word(0), high, 0);
+                if (score <= k) fn(j, score);
+            }
+            return;
+        }
+        // Vertical deltas of the current column (+1 in `pv`, -1 in `mv`), and the bottom score of each block
+        Mask pv, mv;
+        std::vector<size_t> score(last + 1);
+        size_t y = k / 64 < last ? k / 64 : last;
+        for (size_t b = 0; b <= y; b++) {
+            pv.setWord(b, ~uint64_t(0));
+            score[b] = b * 64 + width_(b, m);
+        }
+        for (size_t j = 0; j < n; j++) {
+            int carry = 0;
+            if (y == 0) {
+                // Only the first block is active: run it in registers until the next block is needed
+                uint64_t p = pv.word(0), q = mv.word(0);
+                size_t s = score[0];
+                for (; j < n; j++) {
+                    const Mask& eq = masks_[uint8_t(text[j])];
+                    carry = step_(p, q, eq.word(0), uint64_t(1) << 63, 0);
+                    s += carry;
+                    if (s - carry <= k && ((eq.word(1) & 1) || carry < 0)) break;
+                }
+                pv.setWord(0, p);
+                mv.setWord(0, q);
+                score[0] = s;
+                if (j == n) break;
+            } else {
+                const Mask& eq = masks_[uint8_t(text[j])];
+                for (size_t b = 0; b <= y; b++) {
+                    carry = advance_(pv, mv, eq, b, width_(b, m), carry);
+                    score[b] += carry;
+                }
+            }
+            const Mask& eq = masks_[uint8_t(text[j])];
+            // Bring in the next block if its first row can reach `k`
+            if (y < last && score[y] - carry <= k && ((eq.word(y + 1) & 1) || carry < 0)) {
+                y++;
+                pv.setWord(y, ~uint64_t(0));
+                mv.setWord(y, 0);
+                const size_t prev = score[y - 1] - carry + width_(y, m);
+                carry = advance_(pv, mv, eq, y, width_(y, m), carry);
+                score[y] = prev + carry;
+            }
+            // Drop blocks where every row is past `k`
+            while (y > 0 && score[y] >= k + width_(y, m)) y--;
+            if (y == last && score[y] <= k) fn(j, score[y]);
+        }
+    }
+
+    /// @brief Counts the text indices where a match with at most `k` edits ends.
+    size_t count(const char* text, const size_t& n, const size_t& k) const {
+        size_t c = 0;
+        search(text, n, k, [&](size_t, size_t) { c++; });
+        return c;
+    }
+
+    /// @brief Gets the fewest edits turning the pattern into any substring of the text.
+    size_t bestDistance(const char* text, const size_t& n) const {
+        size_t best = length();
+        search(text, n, length(), [&](size_t, size_t d) { if (d < best) best = d; });
+        return best;
+    }
+
+/// @section Private Members
+private:
+    FlagPatternMasks<MAXLEN> masks_;
+
+    /// @brief Gets the number of pattern rows in block `b`.
+    static size_t width_(const size_t& b, const size_t& m) {
+        return (b + 1) * 64 <= m ? 64 : m - b * 64;
+    }
+
+    /// @brief Advances one block of vertical deltas by one text character.
+    /// @param p, n The +1 and -1 vertical deltas of the block.
+    /// @param eq The block's mask of the text character.
+    /// @param high The bit of the block's bottom row.
+    /// @param hin The horizontal delta entering the block's top row (-1, 0 or +1).
+    /// @return The horizontal delta leaving the block's bottom row.
+    static int step_(uint64_t& p, uint64_t& n, uint64_t eq, const uint64_t& high, const int& hin) {
+        const uint64_t xv = eq | n;
+        if (hin < 0) eq |= 1;
+        const uint64_t xh = (((eq & p) + p) ^ p) | eq;
+        uint64_t ph = n | ~(xh | p);
+        uint64_t mh = p & xh;
+        const int hout = int((ph & high) != 0) - int((mh & high) != 0);
+        ph <<= 1;
+        mh <<= 1;
+        if (hin < 0) mh |= 1;
+        else if (hin > 0) ph |= 1;
+        p = mh | ~(xv | ph);
+        n = ph & xv;
+        return hout;
+    }
+
+    /// @brief Advances block `b` of the FlagField state by one text character.
+    static int advance_(Mask& pv, Mask& mv, const Mask& peq, const size_t& b,
+                        const size_t& width, const int& hin) {
+        uint64_t p = pv.word(b), n = mv.word(b);
+        const int hout = step_(p, n, peq.word(b), uint64_t(1) << (width - 1), hin);
+        pv.setWord(b, p);
+        mv.setWord(b, n);
+        return hout;
+    }
+};
+
+#endif // FLAGFIELDMATCH_HPP
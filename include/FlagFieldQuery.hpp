@@ -0,0 +1,395 @@
+/**
+ * @file FlagFieldQuery.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagPredicate and FlagQuery classes.
+ * @details Boolean expressions over flags, compiled to scans over arrays of
+ * FlagFields.
+ *
+ * - A FlagPredicate is kept in disjunctive normal form: a list of terms, each
+ *   a (mask, value) pair matching rows where `(row & mask) == value`. `&&`,
+ *   `||` and `!` combine predicates directly in that form, dropping
+ *   contradictory and subsumed terms.
+ * - A FlagQuery stores each term as its nonzero (word, mask, value) triples,
+ *   so a row is tested one word per constrained word.
+ * - FlagFields of 1, 2, 4 or 8 bytes are tested many at a time: 32 / 16 / 8 /
+ *   4 rows per AVX2 compare when compiled with AVX2 support (`__AVX2__`), and
+ *   8 / 4 / 2 / 1 rows per 64 bit word otherwise (SWAR).
+ * - Results are written as a selection bitmap (bit `i` set if row `i`
+ *   matches), split across a FlagThreadPool in chunks of 64 rows.
+ */
+#pragma once
+#ifndef FLAGFIELDQUERY_HPP
+#define FLAGFIELDQUERY_HPP
+
+#include <FlagField.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <utility>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/// @brief A boolean expression over the flags of a `FlagField<MAX, E>`.
+/// @note Example usage:
+/// ```
+/// using P = FlagPredicate<MAX, Flags>;
+/// auto p = (P::flag(A) && P::flag(B)) || (P::flag(C) && !P::flag(D));
+/// if (p(ff)) {}
+/// ```
+/// @tparam MAX The number of flags.
+/// @tparam E The enum to set as a reference. Default = `size_t`.
+template <size_t MAX, class E = size_t>
+class FlagPredicate {
+public:
+    using Set = FlagField<MAX, size_t, FlagCheck::Unchecked>;
+    /// @brief A term matching rows where `(row & first) == second`.
+    using Term = std::pair<Set, Set>;
+
+/// @section Constructors
+
+    /// @brief Matches rows with flag `e` set.
+    static FlagPredicate flag(const E& e) {
+        FlagPredicate p;
+        Term t;
+        t.first.set(size_t(e));
+        t.second.set(size_t(e));
+        p.terms_.push_back(t);
+        return p;
+    }
+
+    /// @brief Matches every row.
+    static FlagPredicate always() {
+        FlagPredicate p;
+        p.terms_.push_back(Term());
+        return p;
+    }
+
+    /// @brief Matches no row.
+    static FlagPredicate never() { return FlagPredicate(); }
+
+    /// @brief Matches rows with every flag of `ff` set.
+    template <class P>
+    static FlagPredicate allOf(const FlagField<MAX, E, P>& ff) {
+        FlagPredicate p = always();
+        for (size_t w = 0; w < Set::numWords(); w++) {
+            p.terms_[0].first.setWord(w, ff.word(w));
+            p.terms_[0].second.setWord(w, ff.word(w));
+        }
+        return p;
+    }
+
+    /// @brief Matches rows with none of the flags of `ff` set.
+    template <class P>
+    static FlagPredicate noneOf(const FlagField<MAX, E, P>& ff) {
+        FlagPredicate p = always();
+        for (size_t w = 0; w < Set::numWords(); w++) p.terms_[0].first.setWord(w, ff.word(w));
+        return p;
+    }
+
+    /// @brief Matches rows with any of the flags of `ff` set.
+    template <class P>
+    static FlagPredicate anyOf(const FlagField<MAX, E, P>& ff) { return !noneOf(ff); }
+
+/// @section Operators
+
+    /// @brief Both predicates hold: every pair of terms is merged.
+    friend FlagPredicate operator&&(const FlagPredicate& a, const FlagPredicate& b) {
+        FlagPredicate p;
+        for (const Term& x : a.terms_) {
+            for (const Term& y : b.terms_) {
+                Term t;
+                bool conflict = false;
+                for (size_t w = 0; w < Set::numWords(); w++) {
+                    const uint64_t both = x.first.word(w) & y.first.word(w);
+                    conflict |= ((x.second.word(w) ^ y.second.word(w)) & both) != 0;
+                    t.first.setWord(w, x.first.word(w) | y.first.word(w));
+                    t.second.setWord(w, x.second.word(w) | y.second.word(w));
+                }
+                if (!conflict) p.add_(t);
+            }
+        }
+        return p;
+    }
+
+    /// @brief Either predicate holds: the terms are joined.
+    friend FlagPredicate operator||(const FlagPredicate& a, const FlagPredicate& b) {
+        FlagPredicate p = a;
+        for (const Term& t : b.terms_) p.add_(t);
+        return p;
+    }
+
+    /// @brief The predicate does not hold: `!(t1 || t2) = !t1 && !t2`, and each `!t` is an OR of negated flags.
+    friend FlagPredicate operator!(const FlagPredicate& a) {
+        FlagPredicate p = always();
+        for (const Term& t : a.terms_) {
+            FlagPredicate n;
+            for (size_t w = 0; w < Set::numWords(); w++) {
+                for (uint64_t m = t.first.word(w); m; m &= m - 1) {
+                    const uint64_t bit = m & (0 - m);
+                    Term lit;
+                    lit.first.setWord(w, bit);
+                    lit.second.setWord(w, ~t.second.word(w) & bit);
+                    n.terms_.push_back(lit);
+                }
+            }
+            p = p && n;
+        }
+        return p;
+    }
+
+/// @section Accessors
+
+    /// @brief Evaluates the predicate on one FlagField.
+    template <class P>
+    bool operator()(const FlagField<MAX, E, P>& ff) const {
+        for (const Term& t : terms_) {
+            size_t w = 0;
+            while (w < Set::numWords() && (ff.word(w) & t.first.word(w)) == t.second.word(w)) w++;
+            if (w == Set::numWords()) return true;
+        }
+        return false;
+    }
+
+    /// @brief Gets the DNF terms.
+    const std::vector<Term>& terms() const { return terms_; }
+
+/// @section Private Members
+private:
+    std::vector<Term> terms_;
+
+    /// @brief Returns `true` if every row matching `b` also matches `a`.
+    static bool covers_(const Term& a, const Term& b) {
+        for (size_t w = 0; w < Set::numWords(); w++) {
+            const uint64_t am = a.first.word(w);
+            if ((am & ~b.first.word(w)) || ((a.second.word(w) ^ b.second.word(w)) & am)) return false;
+        }
+        return true;
+    }
+
+    /// @brief Adds a term unless an existing term covers it, removing the terms it covers.
+    void add_(const Term& t) {
+        for (const Term& x : terms_) if (covers_(x, t)) return;
+        size_t keep = 0;
+        for (size_t i = 0; i < terms_.size(); i++) {
+            if (!covers_(t, terms_[i])) terms_[keep++] = terms_[i];
+        }
+        terms_.resize(keep);
+        terms_.push_back(t);
+    }
+};
+
+/// @brief A FlagPredicate compiled for scanning arrays of FlagFields.
+/// @note Example usage:
+/// ```
+/// FlagQuery<MAX, Flags> q(P::flag(A) && !P::flag(D));
+/// std::vector<uint64_t> bitmap((rows.size() + 63) / 64);
+/// q.select(rows.data(), rows.size(), bitmap.data());
+/// ```
+/// @tparam MAX The number of flags.
+/// @tparam E The enum to set as a reference. Default = `size_t`.
+template <size_t MAX, class E = size_t>
+class FlagQuery {
+public:
+/// @section Constructors
+
+    /// @brief Compiles a predicate.
+    explicit FlagQuery(const FlagPredicate<MAX, E>& p) {
+        using Set = typename FlagPredicate<MAX, E>::Set;
+        for (const auto& t : p.terms()) {
+            Term_ term;
+            for (size_t w = 0; w < Set::numWords(); w++) {
+                if (t.first.word(w)) term.push_back({w, t.first.word(w), t.second.word(w)});
+            }
+            terms_.push_back(term);
+        }
+    }
+
+/// @section Scanning Functions
+
+    /// @brief Splits scans across a pool.
+    void setThreadPool(FlagThreadPool* pool) { pool_ = pool; }
+
+    /// @brief Evaluates the query on one FlagField.
+    template <class P>
+    bool matches(const FlagField<MAX, E, P>& ff) const {
+        for (const Term_& t : terms_) {
+            size_t i = 0;
+            while (i < t.size() && (ff.word(t[i].w) & t[i].mask) == t[i].value) i++;
+            if (i == t.size()) return true;
+        }
+        return false;
+    }
+
+    /// @brief Sets bit `i` of `bitmap` if row `i` matches, for `(n + 63) / 64` words.
+    template <class P>
+    void select(const FlagField<MAX, E, P>* rows, const size_t& n, uint64_t* bitmap) const {
+        auto chunk = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i += 64) {
+                bitmap[i / 64] = selectBlock_(rows + i, end - i < 64 ? end - i : 64);
+            }
+        };
+        if (pool_) pool_->parallelFor(n, chunk, 64);
+        else chunk(0, n);
+    }
+
+    /// @brief Fills `indices` with the matching rows.
+    /// @return The number of matching rows.
+    template <class P>
+    size_t select(const FlagField<MAX, E, P>* rows, const size_t& n, std::vector<size_t>& indices) const {
+        std::vector<uint64_t> bitmap((n + 63) / 64);
+        select(rows, n, bitmap.data());
+        size_t c = 0;
+        for (uint64_t w : bitmap) c += size_t(popcount_(w));
+        indices.resize(c);
+        size_t* out = indices.data();
+        for (size_t w = 0; w < bitmap.size(); w++) {
+            for (uint64_t x = bitmap[w]; x; x &= x - 1) *out++ = w * 64 + ctz_(x);
+        }
+        return c;
+    }
+
+    /// @brief Counts the matching rows.
+    template <class P>
+    size_t count(const FlagField<MAX, E, P>* rows, const size_t& n) const {
+        std::vector<uint64_t> bitmap((n + 63) / 64);
+        select(rows, n, bitmap.data());
+        size_t c = 0;
+        for (uint64_t w : bitmap) c += size_t(popcount_(w));
+        return c;
+    }
+
+/// @section Private Members
+private:
+    struct Literal_ {
+        size_t w;
+        uint64_t mask, value;
+    };
+    using Term_ = std::vector<Literal_>;
+
+    std::vector<Term_> terms_;
+    FlagThreadPool* pool_ = nullptr;
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    static int popcount_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        int c = 0;
+        for (; x; x &= x - 1) c++;
+        return c;
+#endif
+    }
+
+    /// @brief Repeats the low `8 * L` bits of `x` across a word.
+    template <size_t L>
+    static constexpr uint64_t broadcast_(const uint64_t& x) {
+        const uint64_t lane = L == 8 ? ~uint64_t(0) : (uint64_t(1) << (8 * L % 64)) - 1;
+        uint64_t r = 0;
+        for (size_t i = 0; i < 8 / L; i++) r |= (x & lane) << (8 * L * i % 64);
+        return r;
+    }
+
+    /// @brief Matches `count` (at most 64) rows, returning one bit per row.
+    template <class P>
+    uint64_t selectBlock_(const FlagField<MAX, E, P>* rows, const size_t& count) const {
+        constexpr size_t L = sizeof(FlagField<MAX, E, P>);
+#ifdef FF_LITTLE_ENDIAN
+        constexpr bool packed = L == (MAX + 7) / 8 && (L == 1 || L == 2 || L == 4 || L == 8);
+#else
+        constexpr bool packed = false;
+#endif
+        if constexpr (packed) {
+            if (count == 64) {
+                uint64_t bits = 0;
+                for (const Term_& t : terms_) {
+                    bits |= t.empty() ? ~uint64_t(0) :
+                        matchPacked_<L>(reinterpret_cast<const uint8_t*>(rows), t[0].mask, t[0].value);
+                }
+                return bits;
+            }
+        }
+        // One literal at a time across the block, dropping a term once no row is left
+        const uint64_t all = count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+        uint64_t bits = 0;
+        for (const Term_& t : terms_) {
+            uint64_t m = all & ~bits;
+            for (size_t l = 0; l < t.size() && m; l++) {
+                const Literal_& lit = t[l];
+                uint64_t b = 0;
+                for (size_t i = 0; i < count; i++) {
+                    b |= uint64_t((rows[i].word(lit.w) & lit.mask) == lit.value) << i;
+                }
+                m &= b;
+            }
+            bits |= m;
+        }
+        return bits;
+    }
+
+    /// @brief Matches 64 rows of `L` bytes against one word term.
+    template <size_t L>
+    static uint64_t matchPacked_(const uint8_t* p, const uint64_t& mask, const uint64_t& value) {
+#ifdef __AVX2__
+        const __m256i m = _mm256_set1_epi64x(int64_t(broadcast_<L>(mask)));
+        const __m256i v = _mm256_set1_epi64x(int64_t(broadcast_<L>(value)));
+        auto eq = [&](size_t offset) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + offset));
+            const __m256i y = _mm256_and_si256(x, m);
+            if (L == 1) return _mm256_cmpeq_epi8(y, v);
+            if (L == 2) return _mm256_cmpeq_epi16(y, v);
+            if (L == 4) return _mm256_cmpeq_epi32(y, v);
+            return _mm256_cmpeq_epi64(y, v);
+        };
+        uint64_t bits = 0;
+        if (L == 1) {
+            for (size_t i = 0; i < 2; i++) bits |= uint64_t(uint32_t(_mm256_movemask_epi8(eq(32 * i)))) << (32 * i);
+        } else if (L == 2) {
+            for (size_t i = 0; i < 2; i++) {
+                // Pack two compares of 16 rows to bytes, then undo the per lane interleave
+                const __m256i b = _mm256_packs_epi16(eq(64 * i), eq(64 * i + 32));
+                const __m256i o = _mm256_permute4x64_epi64(b, 0xD8);
+                bits |= uint64_t(uint32_t(_mm256_movemask_epi8(o))) << (32 * i);
+            }
+        } else if (L == 4) {
+            for (size_t i = 0; i < 8; i++) {
+                bits |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(eq(32 * i)))) << (8 * i);
+            }
+        } else {
+            for (size_t i = 0; i < 16; i++) {
+                bits |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(eq(32 * i)))) << (4 * i);
+            }
+        }
+        return bits;
+#else
+        // SWAR: a lane's high bit is set when `(lane & mask) == value`, then the high bits are gathered with a multiply
+        constexpr size_t lanes = 8 / L;
+        constexpr uint64_t high = broadcast_<L>(uint64_t(1) << (8 * L - 1));
+        constexpr uint64_t low = ~high;
+        uint64_t gather = 0;
+        for (size_t j = 0; j < lanes; j++) gather |= uint64_t(1) << (64 - lanes - j * (8 * L - 1));
+        const uint64_t m = broadcast_<L>(mask), v = broadcast_<L>(value);
+        uint64_t bits = 0;
+        for (size_t i = 0; i < 64 / lanes; i++) {
+            uint64_t x;
+            std::memcpy(&x, p + 8 * i, 8);
+            const uint64_t y = (x & m) ^ v;
+            const uint64_t zero = ~(((y & low) + low) | y | low);
+            bits |= (((zero >> (8 * L - 1)) * gather) >> (64 - lanes)) << (lanes * i);
+        }
+        return bits;
+#endif
+    }
+};
+
+#endif // FLAGFIELDQUERY_HPP
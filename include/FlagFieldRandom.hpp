@@ -0,0 +1,197 @@
+/**
+ * @file FlagFieldRandom.hpp
+ * @author Ray Richter
+ * @brief Random FlagField generation at a target density.
+ * @details Words are filled directly from a fast PRNG instead of drawing a
+ * random number per flag:
+ * - `fillRandom()` reaches a flag probability `p` by walking the binary
+ *   expansion of `p` from its lowest set bit, combining random words with
+ *   `OR` for 1 bits and `AND` for 0 bits. A density with `b` significant
+ *   bits costs at most `b` random words per 64 flags.
+ * - `fillRandomCount()` sets exactly `k` flags with Floyd's sampling, using
+ *   the FlagField itself as the sample set.
+ *
+ * Every generator is reproducible from its seed.
+ */
+#pragma once
+#ifndef FLAGFIELDRANDOM_HPP
+#define FLAGFIELDRANDOM_HPP
+
+#include <FlagField.hpp>
+
+/// @brief SplitMix64, used to expand a single seed into generator state.
+class FlagSplitMix {
+public:
+    explicit FlagSplitMix(const uint64_t& seed) : state_(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state_;
+};
+
+/// @brief The xoshiro256** generator.
+class FlagXoshiro {
+public:
+    using result_type = uint64_t;
+
+    /// @brief Seeds the generator state from a single value.
+    explicit FlagXoshiro(const uint64_t& seed = 0) {
+        FlagSplitMix sm(seed);
+        for (uint64_t& s : s_) s = sm();
+    }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return ~uint64_t(0); }
+
+    /// @brief Returns the next 64 random bits.
+    uint64_t operator()() {
+        const uint64_t result = rotl_(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl_(s_[3], 45);
+        return result;
+    }
+
+private:
+    uint64_t s_[4];
+
+    static uint64_t rotl_(const uint64_t& x, const int& k) { return (x << k) | (x >> (64 - k)); }
+};
+
+/// @brief The wyrand generator. Smaller state than xoshiro, one multiply per word.
+class FlagWyRand {
+public:
+    using result_type = uint64_t;
+
+    explicit FlagWyRand(const uint64_t& seed = 0) : state_(seed) {}
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return ~uint64_t(0); }
+
+    /// @brief Returns the next 64 random bits.
+    uint64_t operator()() {
+        state_ += 0xA0761D6478BD642FULL;
+        const uint64_t hi = mulHi_(state_, state_ ^ 0xE7037ED1A0B428DBULL);
+        const uint64_t lo = state_ * (state_ ^ 0xE7037ED1A0B428DBULL);
+        return hi ^ lo;
+    }
+
+private:
+    uint64_t state_;
+
+    static uint64_t mulHi_(const uint64_t& a, const uint64_t& b) {
+#ifdef __SIZEOF_INT128__
+        return uint64_t((unsigned __int128)a * b >> 64);
+#else
+        const uint64_t al = a & 0xFFFFFFFF, ah = a >> 32, bl = b & 0xFFFFFFFF, bh = b >> 32;
+        const uint64_t mid = (al * bl >> 32) + (ah * bl & 0xFFFFFFFF) + al * bh;
+        return ah * bh + (ah * bl >> 32) + (mid >> 32);
+#endif
+    }
+};
+
+/// @section Random Words
+
+/// @brief Makes random words where each bit is set with probability `p`.
+/// @note `p` is rounded down to `precision` binary digits (1 - 64).
+class FlagDensity {
+public:
+    explicit FlagDensity(const double& p, const unsigned& precision = 32) {
+        bits_ = precision > 64 ? 64 : (precision == 0 ? 1 : precision);
+        if (!(p > 0)) { digits_ = 0; return; }
+        if (p >= 1) { digits_ = ~uint64_t(0); bits_ = 0; return; }
+        // Fixed point binary digits of p, walked from the least significant
+        digits_ = bits_ == 64 ? uint64_t(p * 18446744073709551616.0) :
+            uint64_t(p * double(uint64_t(1) << bits_));
+        // Trailing 0 digits would only AND into an all 0 word
+        first_ = 0;
+        while (digits_ && !((digits_ >> first_) & 1)) first_++;
+    }
+
+    /// @brief Returns a random word.
+    template <class R>
+    uint64_t operator()(R& rng) const {
+        if (bits_ == 0) return ~uint64_t(0);
+        if (digits_ == 0) return 0;
+        uint64_t w = 0;
+        for (unsigned d = first_; d < bits_; d++) {
+            w = ((digits_ >> d) & 1) ? (w | rng()) : (w & rng());
+        }
+        return w;
+    }
+
+private:
+    uint64_t digits_;
+    unsigned bits_, first_ = 0;
+};
+
+/// @brief Returns a random word where each bit is set with probability `p`.
+/// @note `p` is rounded down to `precision` binary digits (1 - 64).
+template <class R>
+uint64_t randomWord(R& rng, const double& p, const unsigned& precision = 32) {
+    return FlagDensity(p, precision)(rng);
+}
+
+/// @brief Returns a uniform random value in `[0, n)` (Lemire's multiply and reject).
+template <class R>
+uint64_t randomBelow(R& rng, const uint64_t& n) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 m = (unsigned __int128)rng() * n;
+    if (uint64_t(m) < n) {
+        const uint64_t t = (0 - n) % n;
+        while (uint64_t(m) < t) m = (unsigned __int128)rng() * n;
+    }
+    return uint64_t(m >> 64);
+#else
+    const uint64_t limit = ~uint64_t(0) - (~uint64_t(0) % n);
+    uint64_t r;
+    do { r = rng(); } while (r >= limit);
+    return r % n;
+#endif
+}
+
+/// @section FlagField Generation
+
+/// @brief Overwrites every flag, setting each with probability `p`.
+/// @note `p` is rounded down to `precision` binary digits (1 - 64).
+template <class R, size_t MAX, class E, class P>
+void fillRandom(FlagField<MAX, E, P>& ff, R& rng, const double& p, const unsigned& precision = 32) {
+    const FlagDensity density(p, precision);
+    for (size_t w = 0; w < ff.numWords(); w++) ff.setWord(w, density(rng));
+}
+
+/// @brief Overwrites every flag, setting exactly `k` uniformly chosen flags.
+/// @note Uses Floyd's sampling, sampling the cleared flags instead when `k > MAX / 2`.
+template <class R, size_t MAX, class E, class P>
+void fillRandomCount(FlagField<MAX, E, P>& ff, R& rng, size_t k) {
+    if (k > MAX) k = MAX;
+    const bool invert = k > MAX / 2;
+    if (invert) k = MAX - k;
+    FlagField<MAX, size_t, FlagCheck::Unchecked> x;
+    for (size_t j = MAX - k; j < MAX; j++) {
+        const size_t t = size_t(randomBelow(rng, j + 1));
+        x.set(x.isSet(t) ? j : t);
+    }
+    if (invert) x.toggle();
+    for (size_t w = 0; w < ff.numWords(); w++) ff.setWord(w, x.word(w));
+}
+
+/// @brief Makes a new FlagField with each flag set with probability `p`.
+template <size_t MAX, class E = size_t, class R>
+FlagField<MAX, E> randomFlagField(R& rng, const double& p) {
+    FlagField<MAX, E> x;
+    fillRandom(x, rng, p);
+    return x;
+}
+
+#endif // FLAGFIELDRANDOM_HPP
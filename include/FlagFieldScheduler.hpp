@@ -0,0 +1,219 @@
+/**
+ * @file FlagFieldScheduler.hpp
+ * @author Ray Richter
+ * @brief Constant time priority schedulers over FlagField ready bitmaps.
+ * @details `FlagPriorityScheduler` is a run queue in the style of the Linux
+ * O(1) scheduler:
+ * - One intrusive FIFO of `FlagRunNode`s per priority.
+ * - A FlagField of the priorities with a non-empty FIFO, and a summary word
+ *   of its non-zero words. The highest ready priority is two count leading
+ *   zeros away, whatever the number of queued tasks.
+ *
+ * `FlagCoreScheduler` gives each core its own run queue behind a spin lock,
+ * and publishes each core's highest ready priority in an atomic. A core with
+ * nothing to run steals from the core publishing the highest priority,
+ * reading the atomics without taking any lock.
+ */
+#pragma once
+#ifndef FLAGFIELDSCHEDULER_HPP
+#define FLAGFIELDSCHEDULER_HPP
+
+#include <FlagField.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+/// @brief The intrusive link of a schedulable task. Derive tasks from it.
+struct FlagRunNode {
+    FlagRunNode* next = nullptr;
+};
+
+/// @brief A run queue of `LEVELS` priorities, popping the highest priority first and FIFO within a priority.
+/// @note Example usage:
+/// ```
+/// struct Task : FlagRunNode { /* ... */ };
+/// FlagPriorityScheduler<256> runQueue;
+/// runQueue.push(&task, 200);
+/// Task* next = static_cast<Task*>(runQueue.pop());
+/// ```
+/// @tparam LEVELS The number of priorities, at most 4096. Higher numbers run first. Default = 256.
+template <size_t LEVELS = 256>
+class FlagPriorityScheduler {
+    static_assert(LEVELS > 0 && LEVELS <= 4096, "LEVELS must be between 1 and 4096");
+public:
+    /// @brief The priority reported by an empty scheduler.
+    static constexpr size_t none = ~size_t(0);
+
+/// @section Queue Functions
+
+    /// @brief Appends a task to the FIFO of a priority.
+    void push(FlagRunNode* node, const size_t& priority) {
+        node->next = nullptr;
+        if (tails_[priority]) tails_[priority]->next = node;
+        else {
+            heads_[priority] = node;
+            ready_.set(priority);
+            summary_ |= uint64_t(1) << (priority / 64);
+        }
+        tails_[priority] = node;
+        size_++;
+    }
+
+    /// @brief Removes the first task of the highest ready priority.
+    /// @param priority If not null, set to the task's priority.
+    /// @return The task, or null if empty.
+    FlagRunNode* pop(size_t* priority = nullptr) {
+        const size_t p = highest();
+        if (p == none) return nullptr;
+        FlagRunNode* node = heads_[p];
+        heads_[p] = node->next;
+        if (!heads_[p]) {
+            tails_[p] = nullptr;
+            ready_.clear(p);
+            if (!ready_.word(p / 64)) summary_ &= ~(uint64_t(1) << (p / 64));
+        }
+        node->next = nullptr;
+        size_--;
+        if (priority) *priority = p;
+        return node;
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the highest priority with a task, or `none`.
+    size_t highest() const {
+        if (!summary_) return none;
+        const size_t w = 63 - clz_(summary_);
+        return w * 64 + 63 - clz_(ready_.word(w));
+    }
+
+    /// @brief Gets the priorities with a task.
+    const FlagField<LEVELS, size_t, FlagCheck::Unchecked>& ready() const { return ready_; }
+
+    /// @brief Gets the number of tasks queued.
+    size_t size() const { return size_; }
+
+    /// @brief Checks if no task is queued.
+    bool empty() const { return !summary_; }
+
+/// @section Private Members
+private:
+    FlagRunNode* heads_[LEVELS] = {};
+    FlagRunNode* tails_[LEVELS] = {};
+    FlagField<LEVELS, size_t, FlagCheck::Unchecked> ready_;
+    /// @brief Bit `w` set if word `w` of `ready_` is non-zero.
+    uint64_t summary_ = 0;
+    size_t size_ = 0;
+
+    static unsigned clz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_clzll(x));
+#else
+        unsigned n = 0;
+        while (!((x << n) >> 63)) n++;
+        return n;
+#endif
+    }
+};
+
+/// @brief Per core priority run queues with work stealing. Every function is safe to call from any thread.
+/// @note Example usage:
+/// ```
+/// FlagCoreScheduler<256> scheduler(cores);
+/// scheduler.push(core, &task, 200);
+/// // On core `core`: its own highest priority task, or one stolen from the busiest core
+/// if (FlagRunNode* next = scheduler.pop(core)) run(static_cast<Task*>(next));
+/// ```
+/// @tparam LEVELS The number of priorities, at most 4096. Higher numbers run first. Default = 256.
+template <size_t LEVELS = 256>
+class FlagCoreScheduler {
+public:
+    /// @brief The priority reported by an empty core.
+    static constexpr size_t none = FlagPriorityScheduler<LEVELS>::none;
+
+    /// @brief Constructs `cores` empty run queues.
+    explicit FlagCoreScheduler(const size_t& cores) : cores_(cores ? cores : 1), queues_(new Core_[cores_]) {}
+
+/// @section Queue Functions
+
+    /// @brief Appends a task to a core's FIFO of a priority.
+    void push(const size_t& core, FlagRunNode* node, const size_t& priority) {
+        Core_& c = queues_[core];
+        lock_(c);
+        c.queue.push(node, priority);
+        publish_(c);
+    }
+
+    /// @brief Removes the highest priority task of a core, without stealing.
+    FlagRunNode* popLocal(const size_t& core, size_t* priority = nullptr) {
+        Core_& c = queues_[core];
+        if (c.top.load(std::memory_order_acquire) == 0) return nullptr;
+        lock_(c);
+        FlagRunNode* node = c.queue.pop(priority);
+        publish_(c);
+        return node;
+    }
+
+    /// @brief Removes the highest priority task of the core publishing the highest priority other than `core`.
+    FlagRunNode* steal(const size_t& core, size_t* priority = nullptr) {
+        for (;;) {
+            size_t victim = cores_, best = 0;
+            for (size_t i = 1; i < cores_; i++) {
+                const size_t v = (core + i) % cores_;
+                const size_t top = queues_[v].top.load(std::memory_order_acquire);
+                if (top > best) {
+                    best = top;
+                    victim = v;
+                }
+            }
+            if (victim == cores_) return nullptr;
+            // The victim may have been drained since; look again if so
+            if (FlagRunNode* node = popLocal(victim, priority)) return node;
+        }
+    }
+
+    /// @brief Removes the highest priority task of a core, stealing one if it has none.
+    /// @note A local task runs before a stolen one even if the stolen one has a higher priority.
+    FlagRunNode* pop(const size_t& core, size_t* priority = nullptr) {
+        if (FlagRunNode* node = popLocal(core, priority)) return node;
+        return steal(core, priority);
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the number of cores.
+    size_t cores() const { return cores_; }
+
+    /// @brief Gets the highest priority queued on a core, or `none`. Lock-free.
+    size_t highest(const size_t& core) const {
+        return queues_[core].top.load(std::memory_order_acquire) - 1;
+    }
+
+/// @section Private Members
+private:
+    /// @brief A run queue on its own cache lines.
+    struct alignas(64) Core_ {
+        std::atomic<bool> locked{false};
+        /// @brief The highest priority queued plus one, or 0 if empty.
+        std::atomic<size_t> top{0};
+        FlagPriorityScheduler<LEVELS> queue;
+    };
+
+    const size_t cores_;
+    std::unique_ptr<Core_[]> queues_;
+
+    static void lock_(Core_& c) {
+        while (c.locked.exchange(true, std::memory_order_acquire)) {
+            while (c.locked.load(std::memory_order_relaxed)) std::this_thread::yield();
+        }
+    }
+
+    /// @brief Publishes the highest priority and releases the lock.
+    static void publish_(Core_& c) {
+        c.top.store(c.queue.highest() + 1, std::memory_order_release);
+        c.locked.store(false, std::memory_order_release);
+    }
+};
+
+#endif // FLAGFIELDSCHEDULER_HPP
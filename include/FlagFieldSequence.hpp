@@ -0,0 +1,260 @@
+/**
+ * @file FlagFieldSequence.hpp
+ * @author Ray Richter
+ * @brief Sliding window anti-replay bitmaps for sequence numbers.
+ * @details `FlagSequenceWindow` remembers which of the last `WINDOW` sequence
+ * numbers were received, in a circular FlagField where sequence `s` is bit
+ * `s % WINDOW`:
+ * - Checking and marking a sequence number is one word test and set.
+ * - A sequence number past the top of the window moves the window up. The
+ *   bits of the sequence numbers scrolling out are cleared a word at a time,
+ *   with masks for the partial words at either end.
+ * - `received()` and `missing()` export the window as SACK style ranges,
+ *   found with count trailing zeros over the words.
+ *
+ * `FlagAtomicSequenceWindow` is the lock-free variant for many producers.
+ * Each atomic word holds 32 bits of the window and the 32 bit block number
+ * they belong to, so a stale word is cleared and marked with a single
+ * compare-and-swap instead of a separate clearing pass.
+ */
+#pragma once
+#ifndef FLAGFIELDSEQUENCE_HPP
+#define FLAGFIELDSEQUENCE_HPP
+
+#include <FlagField.hpp>
+
+#include <atomic>
+#include <vector>
+
+/// @brief The result of checking a sequence number against a window.
+enum class FlagSequence {
+    Accepted,   ///< New, and now marked as received
+    Duplicate,  ///< Already received
+    TooOld,     ///< Below the window
+};
+
+/// @brief A half-open range `[begin, end)` of sequence numbers.
+struct FlagSequenceRange {
+    uint64_t begin, end;
+};
+
+template <size_t WINDOW>
+class FlagAtomicSequenceWindow;
+
+/// @brief An anti-replay window over the last `WINDOW` sequence numbers.
+/// @note Example usage:
+/// ```
+/// FlagSequenceWindow<4096> window;
+/// if (window.check(message.seq) != FlagSequence::Accepted) return; // replayed or stale
+/// std::vector<FlagSequenceRange> sack = window.received();
+/// ```
+/// @tparam WINDOW The number of sequence numbers remembered, a multiple of 64. Default = 4096.
+template <size_t WINDOW = 4096>
+class FlagSequenceWindow {
+    static_assert(WINDOW > 0 && WINDOW % 64 == 0, "WINDOW must be a multiple of 64");
+public:
+    /// @brief Constructs an empty window.
+    /// @param first The first sequence number expected; anything below it is too old.
+    explicit FlagSequenceWindow(const uint64_t& first = 0) : floor_(first), top_(first) {}
+
+/// @section Check Functions
+
+    /// @brief Checks a sequence number and marks it as received.
+    FlagSequence check(const uint64_t& seq) {
+        if (seq >= top_) {
+            advance_(seq + 1);
+            mark_(seq);
+            return FlagSequence::Accepted;
+        }
+        if (seq < base()) return FlagSequence::TooOld;
+        const size_t p = size_t(seq % WINDOW);
+        const uint64_t x = bits_.word(p / 64), bit = uint64_t(1) << (p % 64);
+        if (x & bit) return FlagSequence::Duplicate;
+        bits_.setWord(p / 64, x | bit);
+        return FlagSequence::Accepted;
+    }
+
+    /// @brief Checks whether a sequence number was received, without marking it.
+    /// @return False for sequence numbers outside the window.
+    bool contains(const uint64_t& seq) const {
+        if (seq >= top_ || seq < base()) return false;
+        const size_t p = size_t(seq % WINDOW);
+        return (bits_.word(p / 64) >> (p % 64)) & 1;
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the lowest sequence number in the window.
+    uint64_t base() const { return top_ - floor_ > WINDOW ? top_ - WINDOW : floor_; }
+
+    /// @brief Gets one past the highest sequence number received.
+    uint64_t top() const { return top_; }
+
+    /// @brief Gets the received sequence numbers in the window as ranges, lowest first.
+    std::vector<FlagSequenceRange> received() const { return runs_(false); }
+
+    /// @brief Gets the missing sequence numbers in the window (below `top()`) as ranges, lowest first.
+    std::vector<FlagSequenceRange> missing() const { return runs_(true); }
+
+/// @section Private Members
+private:
+    friend class FlagAtomicSequenceWindow<WINDOW>;
+    static constexpr size_t words_ = WINDOW / 64;
+
+    uint64_t floor_, top_;
+    /// @brief Bit `s % WINDOW` for each sequence number `s` in `[base(), top())`.
+    FlagField<WINDOW, size_t, FlagCheck::Unchecked> bits_;
+
+    void mark_(const uint64_t& seq) {
+        const size_t p = size_t(seq % WINDOW);
+        bits_.setWord(p / 64, bits_.word(p / 64) | (uint64_t(1) << (p % 64)));
+    }
+
+    /// @brief Moves the top of the window up to `top`, clearing the bits of `[top_, top)`.
+    void advance_(const uint64_t& top) {
+        if (top - top_ >= WINDOW) {
+            for (size_t w = 0; w < words_; w++) bits_.setWord(w, 0);
+            top_ = top;
+            return;
+        }
+        size_t p = size_t(top_ % WINDOW), left = size_t(top - top_);
+        while (left) {
+            const size_t o = p % 64;
+            if (o == 0 && left >= 64) {
+                // Whole words, up to the end of the circle
+                size_t n = left / 64, w = p / 64;
+                if (n > words_ - w) n = words_ - w;
+                for (size_t i = 0; i < n; i++) bits_.setWord(w + i, 0);
+                p = (p + 64 * n) % WINDOW;
+                left -= 64 * n;
+                continue;
+            }
+            const size_t n = left < 64 - o ? left : 64 - o;
+            const uint64_t mask = (n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1) << o;
+            bits_.setWord(p / 64, bits_.word(p / 64) & ~mask);
+            p = (p + n) % WINDOW;
+            left -= n;
+        }
+        top_ = top;
+    }
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    /// @brief Gets the runs of set (or, if `invert`, clear) bits in `[base(), top())`.
+    std::vector<FlagSequenceRange> runs_(const bool& invert) const {
+        std::vector<FlagSequenceRange> out;
+        bool inRun = false;
+        uint64_t begin = 0;
+        for (uint64_t s = base(); s < top_;) {
+            const size_t p = size_t(s % WINDOW), o = p % 64;
+            const size_t n = top_ - s < 64 - o ? size_t(top_ - s) : 64 - o;
+            const uint64_t valid = n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+            const uint64_t x = ((invert ? ~bits_.word(p / 64) : bits_.word(p / 64)) >> o) & valid;
+            // Alternate between the next set bit (a run starts) and the next clear bit (it ends)
+            for (size_t i = 0; i < n;) {
+                const uint64_t y = ((inRun ? ~x : x) & valid) >> i;
+                if (!y) break;
+                i += ctz_(y);
+                if (inRun) out.push_back({begin, s + i});
+                else begin = s + i;
+                inRun = !inRun;
+            }
+            s += n;
+        }
+        if (inRun) out.push_back({begin, top_});
+        return out;
+    }
+};
+
+/// @brief A lock-free anti-replay window for many producers.
+/// @details Guarantees the last `WINDOW - 32` sequence numbers below the top;
+/// older ones are remembered while their 32 bit block is still in the window.
+/// @note Example usage:
+/// ```
+/// FlagAtomicSequenceWindow<4096> window;
+/// // On any thread
+/// if (window.check(message.seq) == FlagSequence::Accepted) deliver(message);
+/// ```
+/// @tparam WINDOW The number of sequence numbers remembered, a multiple of 64. Default = 4096.
+template <size_t WINDOW = 4096>
+class FlagAtomicSequenceWindow {
+    static_assert(WINDOW > 0 && WINDOW % 64 == 0, "WINDOW must be a multiple of 64");
+public:
+    /// @brief Constructs an empty window.
+    /// @param first The first sequence number expected; anything below it is too old.
+    explicit FlagAtomicSequenceWindow(const uint64_t& first = 0) : floor_(first), top_(first) {
+        // Tag every slot with the block just below `first`, so the first mark of any block replaces it
+        for (auto& slot : blocks_) slot.store(uint64_t(uint32_t(first / 32 - 1)) << 32, std::memory_order_relaxed);
+    }
+
+/// @section Check Functions
+
+    /// @brief Checks a sequence number and marks it as received. Safe to call from any thread.
+    FlagSequence check(const uint64_t& seq) {
+        const uint64_t top = top_.load(std::memory_order_acquire);
+        if (seq < floor_ || (top - floor_ > WINDOW && seq < top - WINDOW)) return FlagSequence::TooOld;
+        const uint32_t block = uint32_t(seq / 32);
+        const uint64_t bit = uint64_t(1) << (seq % 32);
+        std::atomic<uint64_t>& slot = blocks_[(seq / 32) % blockCount_];
+        uint64_t v = slot.load(std::memory_order_acquire);
+        for (;;) {
+            const int32_t age = int32_t(block - uint32_t(v >> 32));
+            if (age < 0) return FlagSequence::TooOld;
+            // A stale block is replaced, clearing its bits, in the same swap that marks `seq`
+            const uint64_t next = age > 0 ? (uint64_t(block) << 32) | bit : v | bit;
+            if (age == 0 && (v & bit)) return FlagSequence::Duplicate;
+            if (slot.compare_exchange_weak(v, next, std::memory_order_acq_rel, std::memory_order_acquire)) break;
+        }
+        uint64_t t = top;
+        while (seq >= t && !top_.compare_exchange_weak(t, seq + 1, std::memory_order_acq_rel)) {}
+        return FlagSequence::Accepted;
+    }
+
+    /// @brief Checks whether a sequence number was received, without marking it.
+    bool contains(const uint64_t& seq) const {
+        const uint64_t top = top_.load(std::memory_order_acquire);
+        if (seq < floor_ || seq >= top || (top - floor_ > WINDOW && seq < top - WINDOW)) return false;
+        const uint64_t v = blocks_[(seq / 32) % blockCount_].load(std::memory_order_acquire);
+        return uint32_t(v >> 32) == uint32_t(seq / 32) && ((v >> (seq % 32)) & 1);
+    }
+
+/// @section Accessors
+
+    /// @brief Gets one past the highest sequence number received.
+    uint64_t top() const { return top_.load(std::memory_order_acquire); }
+
+    /// @brief Copies the window into a FlagSequenceWindow, e.g. to export SACK ranges.
+    /// @note Marks made while copying may or may not be included.
+    FlagSequenceWindow<WINDOW> snapshot() const {
+        FlagSequenceWindow<WINDOW> out(floor_);
+        out.top_ = top();
+        for (uint64_t s = out.base() / 32 * 32; s < out.top_; s += 32) {
+            const uint64_t v = blocks_[(s / 32) % blockCount_].load(std::memory_order_acquire);
+            if (uint32_t(v >> 32) != uint32_t(s / 32)) continue;
+            for (uint64_t x = v & 0xFFFFFFFF; x; x &= x - 1) {
+                const uint64_t seq = s + FlagSequenceWindow<WINDOW>::ctz_(x);
+                if (seq >= out.base() && seq < out.top_) out.mark_(seq);
+            }
+        }
+        return out;
+    }
+
+/// @section Private Members
+private:
+    static constexpr size_t blockCount_ = WINDOW / 32;
+
+    const uint64_t floor_;
+    std::atomic<uint64_t> top_;
+    /// @brief Block number (high 32 bits) and received bits (low 32 bits) of sequence numbers `32 * block + i`.
+    std::atomic<uint64_t> blocks_[blockCount_];
+};
+
+#endif // FLAGFIELDSEQUENCE_HPP
@@ -0,0 +1,220 @@
+/**
+ * @file FlagFieldSignal.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagSignals class.
+ * @details Pending signal flags written from signal handlers and handled
+ * later by the main loop:
+ * - The installed handler only does a `fetch_or` of the signal's bit on an
+ *   always lock-free atomic word, and optionally a `write()` to a wake-up
+ *   file descriptor. Both are async-signal-safe: no locks, no allocation.
+ * - `dispatch()` takes every pending signal with one `exchange(0)` per word
+ *   and calls the handlers registered for them, in signal number order.
+ * - The wake-up descriptor (an eventfd on Linux, a self-pipe elsewhere)
+ *   lets the main loop block in `wait()` or its own poll instead of polling
+ *   flags.
+ *
+ * Signal dispositions are process wide, so one FlagSignals should own each
+ * signal at a time. Needs POSIX `sigaction()`.
+ */
+#pragma once
+#ifndef FLAGFIELDSIGNAL_HPP
+#define FLAGFIELDSIGNAL_HPP
+
+#include <FlagField.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <functional>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+/// @brief Pending signal flags with deferred handlers.
+/// @note Example usage:
+/// ```
+/// FlagSignals signals;
+/// signals.watch(SIGTERM, [&](int) { running = false; });
+/// signals.watch(SIGHUP, [&](int) { reloadConfig(); });
+/// while (running) {
+///     signals.wait();
+///     signals.dispatch();
+/// }
+/// ```
+class FlagSignals {
+public:
+    /// @brief The number of signal numbers tracked (0 is unused).
+    static constexpr size_t MAX = 128;
+    using Pending = FlagField<MAX, size_t, FlagCheck::Unchecked>;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "FlagSignals needs lock-free 64 bit atomics");
+    static_assert(std::atomic<int>::is_always_lock_free, "FlagSignals needs lock-free int atomics");
+
+/// @section Constructors and Deconstructors
+
+    /// @brief Constructs a set watching no signals.
+    /// @param wakeup If true, signals also wake `wait()` and make `fd()` readable.
+    explicit FlagSignals(const bool& wakeup = true) {
+        if (!wakeup) return;
+#ifdef __linux__
+        readFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (readFd_ < 0) throw std::runtime_error("[FlagSignals] - ERROR: eventfd failed!");
+        writeFd_ = readFd_;
+#else
+        int fds[2];
+        if (pipe(fds) < 0) throw std::runtime_error("[FlagSignals] - ERROR: pipe failed!");
+        for (int fd : fds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        readFd_ = fds[0];
+        writeFd_ = fds[1];
+#endif
+        wakeFd_().store(writeFd_);
+    }
+
+    FlagSignals(const FlagSignals&) = delete;
+    FlagSignals& operator=(const FlagSignals&) = delete;
+
+    /// @brief Deconstructor. Restores the previous action of every watched signal.
+    ~FlagSignals() {
+        for (int sig = 1; sig < int(MAX); sig++) {
+            if (watched_.isSet(size_t(sig))) unwatch(sig);
+        }
+        if (readFd_ < 0) return;
+        wakeFd_().store(-1);
+        close(readFd_);
+        if (writeFd_ != readFd_) close(writeFd_);
+    }
+
+/// @section Signal Functions
+
+    /// @brief Installs the flag setting handler for a signal, and registers `fn(sig)` to run on `dispatch()`.
+    void watch(const int& sig, std::function<void(int)> fn) {
+        if (sig <= 0 || size_t(sig) >= MAX) throw std::out_of_range("[FlagSignals] - ERROR: Signal out of range!");
+        handlers_[sig] = std::move(fn);
+        if (watched_.isSet(size_t(sig))) return;
+        struct sigaction action = {};
+        action.sa_handler = &FlagSignals::onSignal_;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        if (sigaction(sig, &action, &previous_[sig]) < 0) {
+            throw std::runtime_error("[FlagSignals] - ERROR: sigaction failed!");
+        }
+        watched_.set(size_t(sig));
+    }
+
+    /// @brief Restores a signal's previous action and forgets its handler. Its pending flag is kept.
+    void unwatch(const int& sig) {
+        if (sig <= 0 || size_t(sig) >= MAX || !watched_.isSet(size_t(sig))) return;
+        sigaction(sig, &previous_[sig], nullptr);
+        watched_.clear(size_t(sig));
+        handlers_[sig] = nullptr;
+    }
+
+    /// @brief Takes every pending signal and calls its handler, lowest signal number first.
+    /// @return The number of signals handled.
+    size_t dispatch() {
+        size_t n = 0;
+        for (size_t w = 0; w < words_; w++) {
+            for (uint64_t x = pending_()[w].exchange(0); x; x &= x - 1) {
+                const int sig = int(w * 64 + ctz_(x));
+                if (handlers_[sig]) handlers_[sig](sig);
+                n++;
+            }
+        }
+        return n;
+    }
+
+    /// @brief Blocks until a signal arrives, or for at most `timeoutMs` milliseconds (-1 waits forever).
+    /// @note Needs the wake-up descriptor. Returns at once if a signal is already pending.
+    /// @return True if a signal is pending.
+    bool wait(const int& timeoutMs = -1) {
+        if (readFd_ >= 0 && !anyPending_()) {
+            pollfd p = {readFd_, POLLIN, 0};
+            while (poll(&p, 1, timeoutMs) < 0 && errno == EINTR) {
+                if (anyPending_()) break;
+            }
+        }
+        drainFd_();
+        return anyPending_();
+    }
+
+/// @section Accessors
+
+    /// @brief Gets a snapshot of the pending signals without taking them.
+    Pending pending() const {
+        Pending out;
+        for (size_t w = 0; w < words_; w++) out.setWord(w, pending_()[w].load());
+        return out;
+    }
+
+    /// @brief Gets the signals watched.
+    const Pending& watched() const { return watched_; }
+
+    /// @brief Gets the descriptor readable after a signal, for the caller's own poll loop, or -1.
+    int fd() const { return readFd_; }
+
+/// @section Private Members
+private:
+    static constexpr size_t words_ = MAX / 64;
+
+    Pending watched_;
+    std::function<void(int)> handlers_[MAX];
+    struct sigaction previous_[MAX] = {};
+    int readFd_ = -1, writeFd_ = -1;
+
+    /// @brief The process wide flags the handler writes.
+    static std::atomic<uint64_t>* pending_() {
+        static std::atomic<uint64_t> pending[words_] = {};
+        return pending;
+    }
+
+    static std::atomic<int>& wakeFd_() {
+        static std::atomic<int> fd(-1);
+        return fd;
+    }
+
+    /// @brief The installed handler. Async-signal-safe.
+    static void onSignal_(int sig) {
+        const int saved = errno;
+        pending_()[sig / 64].fetch_or(uint64_t(1) << (sig % 64));
+        const int fd = wakeFd_().load();
+        if (fd >= 0) {
+            const uint64_t one = 1;
+            // A full pipe (or eventfd) already wakes the reader, so a failed write is fine
+            if (write(fd, &one, sizeof(one)) < 0) {}
+        }
+        errno = saved;
+    }
+
+    bool anyPending_() const {
+        for (size_t w = 0; w < words_; w++) {
+            if (pending_()[w].load()) return true;
+        }
+        return false;
+    }
+
+    void drainFd_() {
+        if (readFd_ < 0) return;
+        uint64_t buffer[8];
+        while (read(readFd_, buffer, sizeof(buffer)) > 0) {}
+    }
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+};
+
+#endif // FLAGFIELDSIGNAL_HPP
@@ -0,0 +1,237 @@
+/**
+ * @file FlagFieldTimer.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagTimerWheel class.
+ * @details A hierarchical timing wheel of `LEVELS` wheels of `SLOTS` slots.
+ * A timer sits in the lowest level where its expiry agrees with the current
+ * time on every higher digit, in the slot of its digit at that level.
+ *
+ * - Each level keeps a FlagField of its non-empty slots. Advancing time finds
+ *   the next non-empty slot with a find-next-set over those words instead of
+ *   ticking through empty buckets, and skips straight to it.
+ * - Slots are intrusive doubly linked lists in one node pool, so scheduling
+ *   and cancelling are O(1).
+ * - Reaching a slot on a higher level cascades its timers down a level; a
+ *   level 0 slot expires as a batch.
+ */
+#pragma once
+#ifndef FLAGFIELDTIMER_HPP
+#define FLAGFIELDTIMER_HPP
+
+#include <FlagField.hpp>
+
+#include <vector>
+
+/// @brief A hierarchical timing wheel over FlagField occupancy bitmaps.
+/// @note Example usage:
+/// ```
+/// FlagTimerWheel<> timers;
+/// const uint64_t handle = timers.schedule(now + timeout, connection);
+/// timers.cancel(handle);
+/// timers.advance(now, [&](uint64_t handle, uint64_t connection) { close(connection); });
+/// ```
+/// @tparam LEVELS The number of wheels. Default = 4.
+/// @tparam SLOTS The number of slots per wheel, a power of two of at least 64. Default = 256.
+template <size_t LEVELS = 4, size_t SLOTS = 256>
+class FlagTimerWheel {
+    static_assert(SLOTS >= 64 && (SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of two of at least 64");
+    static_assert(LEVELS > 0, "LEVELS must be at least 1");
+public:
+    /// @brief The handle no timer has.
+    static constexpr uint64_t none = ~uint64_t(0);
+
+    /// @brief Constructs an empty wheel.
+    /// @param now The current time in ticks.
+    explicit FlagTimerWheel(const uint64_t& now = 0) : now_(now), heads_(LEVELS * SLOTS + 1, end_) {}
+
+/// @section Timer Functions
+
+    /// @brief Schedules a timer. Expiries in the past expire on the next `advance()`.
+    /// @param when The expiry time in ticks.
+    /// @param data A value passed back on expiry.
+    /// @return A handle for `cancel()`.
+    uint64_t schedule(const uint64_t& when, const uint64_t& data = 0) {
+        uint32_t n;
+        if (free_ != end_) {
+            n = free_;
+            free_ = nodes_[n].next;
+        } else {
+            n = uint32_t(nodes_.size());
+            nodes_.push_back(Node_());
+        }
+        nodes_[n].when = when;
+        nodes_[n].data = data;
+        place_(n);
+        size_++;
+        return (uint64_t(nodes_[n].generation) << 32) | n;
+    }
+
+    /// @brief Cancels a timer.
+    /// @return False if the timer already expired or was cancelled.
+    bool cancel(const uint64_t& handle) {
+        const uint32_t n = uint32_t(handle);
+        if (n >= nodes_.size() || nodes_[n].generation != uint32_t(handle >> 32) || nodes_[n].slot == end_) {
+            return false;
+        }
+        unlink_(n);
+        release_(n);
+        return true;
+    }
+
+    /// @brief Advances the time to `now`, calling `fn(handle, data)` for each timer expiring, in expiry order.
+    /// @note `fn` may schedule and cancel timers; ones due by `now` expire in the same call.
+    template <class Fn>
+    void advance(const uint64_t& now, Fn&& fn) {
+        while (true) {
+            size_t level, slot;
+            uint64_t start;
+            if (!next_(level, slot, start) || start > now) break;
+            now_ = start;
+            const size_t s = level * SLOTS + slot;
+            if (level == LEVELS) {
+                // The wheel's range ended: place the timers past it again, some landing back past it
+                uint32_t n = heads_[s];
+                heads_[s] = end_;
+                while (n != end_) {
+                    const uint32_t next = nodes_[n].next;
+                    place_(n);
+                    n = next;
+                }
+                continue;
+            }
+            // Cascade a higher slot down, or expire a level 0 slot as a batch.
+            // Timers are unlinked one at a time so `fn` can cancel the rest of the slot.
+            for (uint32_t n = heads_[s]; n != end_; n = heads_[s]) {
+                unlink_(n);
+                if (level > 0) place_(n);
+                else {
+                    const uint64_t handle = (uint64_t(nodes_[n].generation) << 32) | n, data = nodes_[n].data;
+                    release_(n);
+                    fn(handle, data);
+                }
+            }
+        }
+        if (now > now_) now_ = now;
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the current time in ticks.
+    uint64_t now() const { return now_; }
+
+    /// @brief Gets the number of timers scheduled.
+    size_t size() const { return size_; }
+
+    /// @brief Gets a lower bound of the next expiry, exact when it is within `SLOTS` ticks, or `none` if empty.
+    uint64_t nextExpiry() const {
+        size_t level, slot;
+        uint64_t start;
+        return next_(level, slot, start) ? start : none;
+    }
+
+/// @section Private Members
+private:
+    static constexpr uint32_t end_ = ~uint32_t(0);
+    static constexpr size_t bits_ = SLOTS == 64 ? 6 : SLOTS == 128 ? 7 : SLOTS == 256 ? 8 : SLOTS == 512 ? 9
+                                  : SLOTS == 1024 ? 10 : SLOTS == 2048 ? 11 : SLOTS == 4096 ? 12 : 13;
+    static_assert(SLOTS <= 8192, "SLOTS must be at most 8192");
+    static constexpr size_t words_ = SLOTS / 64;
+    /// @brief The number of bits of time the wheel covers.
+    static constexpr size_t range_ = LEVELS * bits_;
+
+    struct Node_ {
+        uint64_t when = 0, data = 0;
+        uint32_t prev = end_, next = end_, generation = 0;
+        /// @brief `level * SLOTS + slot`, `LEVELS * SLOTS` past the wheel, or `end_` when free.
+        uint32_t slot = end_;
+    };
+
+    uint64_t now_;
+    size_t size_ = 0;
+    std::vector<Node_> nodes_;
+    uint32_t free_ = end_;
+    std::vector<uint32_t> heads_;
+    FlagField<SLOTS, size_t, FlagCheck::Unchecked> occupied_[LEVELS];
+
+    /// @brief Gets `level`'s digit of a time.
+    static size_t digit_(const uint64_t& t, const size_t& level) {
+        return level * bits_ >= 64 ? 0 : size_t(t >> (level * bits_)) & (SLOTS - 1);
+    }
+
+    /// @brief Links a node into the slot of its expiry, or the list past the wheel.
+    void place_(const uint32_t& n) {
+        const uint64_t when = nodes_[n].when < now_ ? now_ : nodes_[n].when;
+        size_t level = 0;
+        for (uint64_t diff = (when ^ now_) >> bits_; diff && level < LEVELS; diff >>= bits_) level++;
+        const uint32_t s = uint32_t(level * SLOTS + (level < LEVELS ? digit_(when, level) : 0));
+        nodes_[n].slot = s;
+        nodes_[n].prev = end_;
+        nodes_[n].next = heads_[s];
+        if (heads_[s] != end_) nodes_[heads_[s]].prev = n;
+        heads_[s] = n;
+        if (level < LEVELS) occupied_[level].set(s % SLOTS);
+    }
+
+    void unlink_(const uint32_t& n) {
+        Node_& node = nodes_[n];
+        if (node.prev != end_) nodes_[node.prev].next = node.next;
+        else {
+            heads_[node.slot] = node.next;
+            if (node.next == end_ && node.slot < LEVELS * SLOTS) occupied_[node.slot / SLOTS].clear(node.slot % SLOTS);
+        }
+        if (node.next != end_) nodes_[node.next].prev = node.prev;
+    }
+
+    void release_(const uint32_t& n) {
+        nodes_[n].slot = end_;
+        nodes_[n].generation++;
+        nodes_[n].next = free_;
+        free_ = n;
+        size_--;
+    }
+
+    static unsigned ctz_(const uint64_t& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!((x >> n) & 1)) n++;
+        return n;
+#endif
+    }
+
+    /// @brief Finds the first non-empty slot at or after `from` on a level, or `SLOTS`.
+    size_t findNext_(const size_t& level, const size_t& from) const {
+        if (from >= SLOTS) return SLOTS;
+        size_t w = from / 64;
+        uint64_t x = occupied_[level].word(w) & (~uint64_t(0) << (from % 64));
+        while (!x) {
+            if (++w == words_) return SLOTS;
+            x = occupied_[level].word(w);
+        }
+        return w * 64 + ctz_(x);
+    }
+
+    /// @brief Finds the earliest non-empty slot and the time it starts.
+    /// @details Level 0 holds the current slot and later ones; higher levels only hold later slots,
+    /// and every slot of a level starts before any slot of the levels above. The timers past the
+    /// wheel (level `LEVELS`) are placed again when the wheel's range ends.
+    /// @return False if there are no timers.
+    bool next_(size_t& level, size_t& slot, uint64_t& start) const {
+        for (level = 0; level < LEVELS; level++) {
+            slot = findNext_(level, digit_(now_, level) + (level > 0));
+            if (slot == SLOTS) continue;
+            const size_t shift = level * bits_;
+            const uint64_t high = shift + bits_ >= 64 ? 0 : now_ >> (shift + bits_) << (shift + bits_);
+            start = high | (uint64_t(slot) << shift);
+            return true;
+        }
+        slot = 0;
+        constexpr size_t range = range_ < 64 ? range_ : 0;
+        if (range_ >= 64 || heads_[LEVELS * SLOTS] == end_) return false;
+        start = ((now_ >> range) + 1) << range;
+        return true;
+    }
+};
+
+#endif // FLAGFIELDTIMER_HPP
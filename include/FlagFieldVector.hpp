@@ -0,0 +1,215 @@
+/**
+ * @file FlagFieldVector.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagFieldVector class.
+ * @details A contiguous, growable array of FlagFields. Since FlagFields are
+ * trivially copyable (unless `FLAGFIELD_DEBUG` is defined), copies are a
+ * single `memcpy`, growth is a `realloc` and new FlagFields are zeroed with
+ * a single `memset` instead of running a constructor per element.
+ */
+#pragma once
+#ifndef FLAGFIELDVECTOR_HPP
+#define FLAGFIELDVECTOR_HPP
+
+#include <FlagField.hpp>
+
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <utility>
+
+/// @brief A growable array of `FlagField<MAX, E, Check>`.
+/// @note Example usage:
+/// ```
+/// FlagFieldVector<MAX, Flags> v(1000000); // One million cleared FlagFields
+///
+/// v[42] += B;
+/// v.push_back(FlagField<MAX, Flags>(A, C));
+/// ```
+/// @tparam MAX The number of flags in each FlagField.
+/// @tparam E The enum to set as a reference. Default = `size_t`.
+/// @tparam Check The index validation policy. Default = `FlagCheck::Default`.
+template <size_t MAX, class E = size_t, class Check = FlagCheck::Default>
+class FlagFieldVector {
+public:
+    using value_type = FlagField<MAX, E, Check>;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+    /// @brief `true` if FlagFields can be copied, relocated and zeroed as raw bytes.
+    static constexpr bool trivial = std::is_trivially_copyable<value_type>::value;
+
+/// @section Constructors and Deconstructors
+
+    /// @brief Default constructor.
+    FlagFieldVector() = default;
+
+    /// @brief Constructs a vector of `n` cleared FlagFields.
+    explicit FlagFieldVector(const size_t& n) { resize(n); }
+
+    /// @brief Copy constructor.
+    FlagFieldVector(const FlagFieldVector& other) {
+        reserve(other.size_);
+        copy_(data_, other.data_, other.size_);
+        size_ = other.size_;
+    }
+
+    /// @brief Move constructor.
+    FlagFieldVector(FlagFieldVector&& other) noexcept { swap(other); }
+
+    /// @brief Deconstructor.
+    ~FlagFieldVector() {
+        clear();
+        std::free(data_);
+    }
+
+/// @section Assignment
+
+    /// @brief Copies another vector, reusing this vector's buffer if it is large enough.
+    FlagFieldVector& operator=(const FlagFieldVector& other) {
+        if (this == &other) return *this;
+        clear();
+        reserve(other.size_);
+        copy_(data_, other.data_, other.size_);
+        size_ = other.size_;
+        return *this;
+    }
+
+    /// @brief Takes the buffer of another vector.
+    FlagFieldVector& operator=(FlagFieldVector&& other) noexcept {
+        FlagFieldVector x(std::move(other));
+        swap(x);
+        return *this;
+    }
+
+    /// @brief Swaps the buffers of two vectors.
+    void swap(FlagFieldVector& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+/// @section Accessors
+
+    value_type& operator[](const size_t& i) { return data_[i]; }
+    const value_type& operator[](const size_t& i) const { return data_[i]; }
+
+    value_type* data() { return data_; }
+    const value_type* data() const { return data_; }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    value_type& back() { return data_[size_ - 1]; }
+    const value_type& back() const { return data_[size_ - 1]; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+/// @section Modifiers
+
+    /// @brief Grows the buffer to hold at least `n` FlagFields.
+    void reserve(const size_t& n) {
+        if (n <= capacity_) return;
+        value_type* p;
+        if constexpr (trivial) {
+            p = static_cast<value_type*>(std::realloc(data_, n * sizeof(value_type)));
+            if (!p) throw std::bad_alloc();
+        } else {
+            p = static_cast<value_type*>(std::malloc(n * sizeof(value_type)));
+            if (!p) throw std::bad_alloc();
+            copy_(p, data_, size_);
+            destroy_(data_, size_);
+            std::free(data_);
+        }
+        data_ = p;
+        capacity_ = n;
+    }
+
+    /// @brief Resizes to `n` FlagFields, new FlagFields are cleared.
+    void resize(const size_t& n) {
+        if (n > capacity_) reserve(n > 2 * capacity_ ? n : 2 * capacity_);
+        if (n > size_) {
+            zero_(data_ + size_, n - size_);
+        } else {
+            destroy_(data_ + n, size_ - n);
+        }
+        size_ = n;
+    }
+
+    /// @brief Appends a copy of a FlagField.
+    void push_back(const value_type& ff) {
+        if (size_ == capacity_) {
+            // `ff` may live in this vector's buffer
+            const value_type x = ff;
+            reserve(capacity_ ? 2 * capacity_ : 8);
+            copy_(data_ + size_++, &x, 1);
+            return;
+        }
+        copy_(data_ + size_++, &ff, 1);
+    }
+
+    /// @brief Appends `n` FlagFields copied from an array.
+    void append(const value_type* ffs, const size_t& n) {
+        if (size_ + n > capacity_) {
+            // `ffs` may point into this vector's buffer: re-base it after the reallocation
+            const std::less<const value_type*> less;
+            const bool inside = !less(ffs, data_) && less(ffs, data_ + size_);
+            const size_t offset = inside ? size_t(ffs - data_) : 0;
+            reserve(size_ + n > 2 * capacity_ ? size_ + n : 2 * capacity_);
+            if (inside) ffs = data_ + offset;
+        }
+        copy_(data_ + size_, ffs, n);
+        size_ += n;
+    }
+
+    /// @brief Removes the last FlagField.
+    void pop_back() { destroy_(data_ + --size_, 1); }
+
+    /// @brief Removes every FlagField, keeping the buffer.
+    void clear() {
+        destroy_(data_, size_);
+        size_ = 0;
+    }
+
+    /// @brief Clears every flag of every FlagField.
+    void clearAll() { zero_(data_, size_); }
+
+/// @section Private Members
+private:
+    value_type* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+    /// @brief Copy constructs `n` FlagFields into uninitialized memory.
+    static void copy_(value_type* dst, const value_type* src, const size_t& n) {
+        if (n == 0) return;
+        if constexpr (trivial) {
+            std::memcpy(static_cast<void*>(dst), src, n * sizeof(value_type));
+        } else {
+            for (size_t i = 0; i < n; i++) new (dst + i) value_type(src[i]);
+        }
+    }
+
+    /// @brief Constructs `n` cleared FlagFields into uninitialized memory.
+    static void zero_(value_type* dst, const size_t& n) {
+        if (n == 0) return;
+        if constexpr (trivial) {
+            std::memset(static_cast<void*>(dst), 0, n * sizeof(value_type));
+        } else {
+            for (size_t i = 0; i < n; i++) new (dst + i) value_type();
+        }
+    }
+
+    /// @brief Destroys `n` FlagFields.
+    static void destroy_(value_type* p, const size_t& n) {
+        if constexpr (!trivial) {
+            for (size_t i = 0; i < n; i++) p[i].~value_type();
+        }
+    }
+};
+
+#endif // FLAGFIELDVECTOR_HPP
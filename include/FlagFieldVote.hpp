@@ -0,0 +1,281 @@
+/**
+ * @file FlagFieldVote.hpp
+ * @author Ray Richter
+ * @brief Threshold and majority votes across arrays of FlagFields.
+ * @details `atLeastK()`, `majority()` and `exactlyK()` combine `n`
+ * FlagFields into one, keeping each flag set in at least (or exactly) `k`
+ * of them. The per flag counts are kept bit-sliced, with bit `j` of every
+ * flag's count in word plane `j`, so each output word costs O(n) word
+ * operations whatever `k` is:
+ * - Rows are added 16 chunks at a time with the Harley-Seal tree of
+ *   `FlagBitmap`. The tree's ones, twos, fours and eights words are
+ *   the low 4 planes, and its sixteens words ripple into the planes above.
+ * - A chunk is `lanes` words holding whole rows, counted side by side in
+ *   plain word loops the compiler vectorizes; the lanes of the same word
+ *   are summed with bit-sliced adders at the end.
+ * - The threshold is applied with a bit-sliced comparator over the planes.
+ * - With a FlagThreadPool, the rows are split across the workers and their
+ *   counters summed with the same bit-sliced adders.
+ */
+#pragma once
+#ifndef FLAGFIELDVOTE_HPP
+#define FLAGFIELDVOTE_HPP
+
+#include <FlagField.hpp>
+#include <FlagFieldBitmap.hpp>
+#include <FlagThreadPool.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// @brief Bit-sliced per flag counts over FlagFields of `MAX` flags.
+/// @note Example usage:
+/// ```
+/// FlagVoteCounter<MAX> votes;
+/// votes.add(replicas.data(), replicas.size());
+/// FlagField<MAX> healthy;
+/// votes.atLeast(2, healthy);
+/// ```
+/// @tparam MAX The number of flags.
+template <size_t MAX>
+class FlagVoteCounter {
+public:
+    /// @brief The number of words in a row.
+    static constexpr size_t words = (MAX + 63) / 64;
+    /// @brief The number of words counted side by side (the lowest multiple of 4 holding whole rows).
+    static constexpr size_t lanes = words % 4 == 0 ? words : (words % 2 == 0 ? 2 * words : 4 * words);
+    /// @brief The number of rows in a chunk of `lanes` words.
+    static constexpr size_t rowsPerChunk = lanes / words;
+
+/// @section Counting Functions
+
+    /// @brief Counts `n` FlagFields.
+    /// @param pool If not null, the rows are split across the pool and the counters merged.
+    template <class E, class P>
+    static FlagVoteCounter of(const FlagField<MAX, E, P>* rows, const size_t& n, FlagThreadPool* pool = nullptr) {
+        FlagVoteCounter total;
+        if (!pool) {
+            total.add(rows, n);
+            return total;
+        }
+        std::mutex lock;
+        pool->parallelFor(n, [&](size_t begin, size_t end) {
+            FlagVoteCounter part;
+            part.add(rows + begin, end - begin);
+            std::lock_guard<std::mutex> guard(lock);
+            total.merge(part);
+        });
+        return total;
+    }
+
+    /// @brief Adds `n` FlagFields to the counts.
+    template <class E, class P>
+    void add(const FlagField<MAX, E, P>* rows, const size_t& n) {
+        using Row = FlagField<MAX, E, P>;
+#ifdef FF_LITTLE_ENDIAN
+        constexpr bool packed = sizeof(Row) == 8 * words;
+#else
+        constexpr bool packed = false;
+#endif
+        rows_ += n;
+        grow_(width_(rows_) < 5 ? 5 : width_(rows_));
+        // Left uninitialized, since every word is written before it is read
+        const std::unique_ptr<Scratch_> scratch(new Scratch_);
+        auto& x = scratch->x;
+        auto& sixteens = scratch->sixteens;
+        auto load = [&](const size_t& c, const size_t& rowsInChunk, uint64_t* dst) {
+            const Row* r = rows + c * rowsPerChunk;
+            if (packed && rowsInChunk == rowsPerChunk) {
+                std::memcpy(dst, r, sizeof(x[0]));
+                return;
+            }
+            for (size_t k = 0; k < rowsPerChunk; k++) {
+                for (size_t w = 0; w < words; w++) dst[k * words + w] = k < rowsInChunk ? r[k].word(w) : 0;
+            }
+        };
+
+        const size_t chunks = n / rowsPerChunk;
+        size_t c = 0;
+        uint64_t* ones = plane_(0);
+        uint64_t* twos = plane_(1);
+        uint64_t* fours = plane_(2);
+        uint64_t* eights = plane_(3);
+        for (; c + 16 <= chunks; c += 16) {
+            for (size_t k = 0; k < 16; k++) load(c + k, rowsPerChunk, x[k]);
+            for (size_t l = 0; l < lanes; l++) {
+                auto in = [&](const size_t& k) { return x[k][l]; };
+                sixteens[l] = FlagBitmap::harleySeal16(ones[l], twos[l], fours[l], eights[l], in);
+            }
+            ripple_(sixteens, 4);
+        }
+        // Leftover chunks, and the leftover rows as a zero padded chunk
+        for (; c * rowsPerChunk < n; c++) {
+            const size_t left = n - c * rowsPerChunk;
+            load(c, left < rowsPerChunk ? left : rowsPerChunk, x[0]);
+            ripple_(x[0], 0);
+        }
+    }
+
+    /// @brief Adds the counts of another counter.
+    void merge(const FlagVoteCounter& other) {
+        rows_ += other.rows_;
+        grow_(other.bits_);
+        grow_(width_(rows_));
+        std::vector<uint64_t> carry(lanes, 0);
+        for (size_t j = 0; j < bits_; j++) {
+            uint64_t* p = plane_(j);
+            const uint64_t* q = j < other.bits_ ? other.plane_(j) : nullptr;
+            for (size_t l = 0; l < lanes; l++) {
+                const uint64_t b = q ? q[l] : 0;
+                const uint64_t s = p[l] ^ b;
+                const uint64_t c = (p[l] & b) | (s & carry[l]);
+                p[l] = s ^ carry[l];
+                carry[l] = c;
+            }
+        }
+    }
+
+    /// @brief Clears the counts.
+    void clear() {
+        planes_.clear();
+        bits_ = 0;
+        rows_ = 0;
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the number of FlagFields counted.
+    uint64_t rows() const { return rows_; }
+
+    /// @brief Gets the number of FlagFields counted with a flag set.
+    uint64_t count(const size_t& flag) const {
+        const std::vector<uint64_t> sums = folded_();
+        uint64_t c = 0;
+        for (size_t j = 0; j < bits_; j++) c |= ((sums[j * words + flag / 64] >> (flag % 64)) & 1) << j;
+        return c;
+    }
+
+/// @section Threshold Functions
+
+    /// @brief Sets `out` to the flags set in at least `k` of the FlagFields counted.
+    template <class E, class P>
+    void atLeast(const uint64_t& k, FlagField<MAX, E, P>& out) const { compare_(k, out, false); }
+
+    /// @brief Sets `out` to the flags set in exactly `k` of the FlagFields counted.
+    template <class E, class P>
+    void exactly(const uint64_t& k, FlagField<MAX, E, P>& out) const { compare_(k, out, true); }
+
+/// @section Private Members
+private:
+    uint64_t rows_ = 0;
+    size_t bits_ = 0;
+    /// @brief Bit `j` of the counts of lane `l` at `planes_[j * lanes + l]`.
+    std::vector<uint64_t> planes_;
+
+    /// @brief Working set of one add, kept off the stack since it grows with MAX.
+    struct Scratch_ {
+        uint64_t x[16][lanes];
+        uint64_t sixteens[lanes];
+    };
+
+    uint64_t* plane_(const size_t& j) { return planes_.data() + j * lanes; }
+    const uint64_t* plane_(const size_t& j) const { return planes_.data() + j * lanes; }
+
+    /// @brief Gets the number of bits needed to hold `x`.
+    static size_t width_(uint64_t x) {
+        size_t n = 0;
+        for (; x; x >>= 1) n++;
+        return n;
+    }
+
+    /// @brief Adds zero planes up to `bits` planes.
+    void grow_(const size_t& bits) {
+        if (bits <= bits_) return;
+        bits_ = bits;
+        planes_.resize(bits_ * lanes, 0);
+    }
+
+    /// @brief Adds one word per lane into the counts, starting at plane `from`.
+    void ripple_(uint64_t* carry, const size_t& from) {
+        for (size_t j = from; j < bits_; j++) {
+            uint64_t* p = plane_(j);
+            uint64_t any = 0;
+            for (size_t l = 0; l < lanes; l++) {
+                const uint64_t t = p[l] & carry[l];
+                p[l] ^= carry[l];
+                carry[l] = t;
+                any |= t;
+            }
+            if (!any) return;
+        }
+    }
+
+    /// @brief Sums the lanes holding the same word, giving `bits_` planes of `words` words.
+    std::vector<uint64_t> folded_() const {
+        std::vector<uint64_t> sums(bits_ * words, 0);
+        for (size_t j = 0; j < bits_; j++) {
+            for (size_t w = 0; w < words; w++) sums[j * words + w] = plane_(j)[w];
+        }
+        for (size_t l = words; l < lanes; l++) {
+            uint64_t carry = 0;
+            const size_t w = l % words;
+            for (size_t j = 0; j < bits_; j++) {
+                const uint64_t a = sums[j * words + w], b = plane_(j)[l];
+                const uint64_t s = a ^ b;
+                sums[j * words + w] = s ^ carry;
+                carry = (a & b) | (s & carry);
+            }
+        }
+        return sums;
+    }
+
+    /// @brief Compares the counts against `k` from the top plane down.
+    template <class E, class P>
+    void compare_(const uint64_t& k, FlagField<MAX, E, P>& out, const bool& exact) const {
+        const std::vector<uint64_t> sums = folded_();
+        const bool tooBig = width_(k) > bits_;
+        for (size_t w = 0; w < words; w++) {
+            // `eq`: the counts equal `k` in the planes so far; `gt`: they are already greater
+            uint64_t eq = tooBig ? 0 : ~uint64_t(0), gt = 0;
+            for (size_t j = bits_; j-- > 0;) {
+                const uint64_t c = sums[j * words + w];
+                if ((k >> j) & 1) eq &= c;
+                else {
+                    gt |= eq & c;
+                    eq &= ~c;
+                }
+            }
+            out.setWord(w, exact ? eq : (gt | eq));
+        }
+    }
+};
+
+/// @brief Gets the flags set in at least `k` of `n` FlagFields.
+/// @param pool If not null, the rows are split across the pool.
+template <size_t MAX, class E, class P>
+FlagField<MAX, E, P> atLeastK(const FlagField<MAX, E, P>* rows, const size_t& n, const uint64_t& k,
+                              FlagThreadPool* pool = nullptr) {
+    FlagField<MAX, E, P> out;
+    FlagVoteCounter<MAX>::of(rows, n, pool).atLeast(k, out);
+    return out;
+}
+
+/// @brief Gets the flags set in exactly `k` of `n` FlagFields.
+/// @param pool If not null, the rows are split across the pool.
+template <size_t MAX, class E, class P>
+FlagField<MAX, E, P> exactlyK(const FlagField<MAX, E, P>* rows, const size_t& n, const uint64_t& k,
+                              FlagThreadPool* pool = nullptr) {
+    FlagField<MAX, E, P> out;
+    FlagVoteCounter<MAX>::of(rows, n, pool).exactly(k, out);
+    return out;
+}
+
+/// @brief Gets the flags set in more than half of `n` FlagFields.
+/// @param pool If not null, the rows are split across the pool.
+template <size_t MAX, class E, class P>
+FlagField<MAX, E, P> majority(const FlagField<MAX, E, P>* rows, const size_t& n, FlagThreadPool* pool = nullptr) {
+    return atLeastK(rows, n, n / 2 + 1, pool);
+}
+
+#endif // FLAGFIELDVOTE_HPP
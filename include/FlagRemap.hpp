@@ -0,0 +1,196 @@
+/**
+ * @file FlagRemap.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagRemap class.
+ * @details Migrates FlagFields between two versions of a flag enum (flags
+ * added, removed or reordered) from a table of old -> new flag indices.
+ *
+ * The table is compiled once into per word steps:
+ * - With BMI2 (`__BMI2__`), flags moving from one source word to one
+ *   destination word in increasing order are moved together with one
+ *   `PEXT` + `PDEP` pair.
+ * - Otherwise, each source byte has a 256 entry lookup table for every
+ *   destination word it touches.
+ */
+#pragma once
+#ifndef FLAGREMAP_HPP
+#define FLAGREMAP_HPP
+
+#include <FlagField.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+/// @brief Remaps flags from `FlagField<OLD_MAX, OldE>` to `FlagField<NEW_MAX, NewE>`.
+/// @note Example usage:
+/// ```
+/// FlagRemap<OLD_MAX, OldFlags, NEW_MAX, NewFlags> remap = {
+///     { OLD_A, NEW_A }, { OLD_B, NEW_B }, // OLD_C was removed
+/// };
+///
+/// FlagField<NEW_MAX, NewFlags> migrated = remap(stored);
+/// ```
+/// @note Old flags missing from the table are dropped, new flags missing from the table are cleared.
+/// @tparam OLD_MAX The number of flags in the old layout.
+/// @tparam OldE The old flag enum.
+/// @tparam NEW_MAX The number of flags in the new layout.
+/// @tparam NewE The new flag enum.
+template <size_t OLD_MAX, class OldE, size_t NEW_MAX, class NewE>
+class FlagRemap {
+public:
+    using OldField = FlagField<OLD_MAX, OldE>;
+    using NewField = FlagField<NEW_MAX, NewE>;
+
+/// @section Constructors
+
+    /// @brief Constructs a remap from a list of `{ old, new }` flag index pairs.
+    /// @note Pairs with an out of range index are ignored.
+    FlagRemap(std::initializer_list<std::pair<OldE, NewE>> table) {
+        build_(table.begin(), table.size());
+    }
+
+    /// @brief Constructs a remap from an array of `{ old, new }` flag index pairs.
+    /// @note Pairs with an out of range index are ignored.
+    FlagRemap(const std::pair<OldE, NewE>* table, const size_t& count) {
+        build_(table, count);
+    }
+
+/// @section Migration Functions
+
+    /// @brief Makes a new FlagField in the new layout from one in the old layout.
+    NewField operator()(const OldField& old) const {
+        NewField x;
+        apply(old, x);
+        return x;
+    }
+
+    /// @brief Overwrites `out` with `old` remapped to the new layout.
+    void apply(const OldField& old, NewField& out) const {
+        std::array<uint64_t, OldField::numWords()> in;
+        std::array<uint64_t, NewField::numWords()> res;
+        for (size_t w = 0; w < in.size(); w++) in[w] = old.word(w);
+        remap_(in.data(), res.data());
+        for (size_t w = 0; w < res.size(); w++) out.setWord(w, res[w]);
+    }
+
+    /// @brief Remaps an array of `count` FlagFields.
+    void apply(const OldField* old, NewField* out, const size_t& count) const {
+        for (size_t i = 0; i < count; i++) apply(old[i], out[i]);
+    }
+
+    /// @brief Remaps `count` persisted records from their `operator*()` bytes.
+    /// @note `in` holds `count * OldField().sizeBytes()` bytes and
+    /// `out` holds `count * NewField().sizeBytes()` bytes.
+    void applyBytes(const uint8_t* in, uint8_t* out, const size_t& count) const {
+        constexpr size_t inBytes = (OLD_MAX + 7) / 8, outBytes = (NEW_MAX + 7) / 8;
+        std::array<uint64_t, OldField::numWords()> src;
+        std::array<uint64_t, NewField::numWords()> res;
+        for (size_t i = 0; i < count; i++) {
+            loadWords_(in + i * inBytes, src.data(), inBytes);
+            remap_(src.data(), res.data());
+            storeWords_(res.data(), out + i * outBytes, outBytes);
+        }
+    }
+
+    /// @brief Gets the number of word steps used per migrated FlagField.
+    size_t numSteps() const { return steps_.size(); }
+
+/// @section Private Members
+private:
+#ifdef __BMI2__
+    /// @brief Moves the `src` bits of a source word to the `dst` bits of a destination word.
+    struct Step {
+        size_t srcWord, dstWord;
+        uint64_t src, dst;
+    };
+#else
+    /// @brief Maps every value of a source byte to the bits of a destination word.
+    struct Step {
+        size_t srcByte, dstWord;
+        std::array<uint64_t, 256> lut;
+    };
+#endif
+
+    /// @brief The compiled remap steps.
+    std::vector<Step> steps_;
+
+    /// @brief Compiles the mapping table into steps.
+    void build_(const std::pair<OldE, NewE>* table, const size_t& count) {
+        std::vector<std::pair<size_t, size_t>> map;
+        for (size_t i = 0; i < count; i++) {
+            const size_t o = (size_t)table[i].first, n = (size_t)table[i].second;
+            if (o < OLD_MAX && n < NEW_MAX) map.emplace_back(o, n);
+        }
+        std::sort(map.begin(), map.end());
+#ifdef __BMI2__
+        // Split the flags moving between each pair of words into increasing chains
+        for (const auto& m : map) {
+            const size_t sw = m.first / 64, dw = m.second / 64;
+            const uint64_t sb = uint64_t(1) << (m.first % 64), db = uint64_t(1) << (m.second % 64);
+            bool placed = false;
+            for (Step& s : steps_) {
+                if (s.srcWord != sw || s.dstWord != dw) continue;
+                // The table is sorted, so the chain's bits are at or below `sb`. A flag
+                // mapped twice is already in the chain and needs a step of its own
+                if (!(s.src & sb) && s.dst < db) { s.src |= sb; s.dst |= db; placed = true; break; }
+            }
+            if (!placed) steps_.push_back({ sw, dw, sb, db });
+        }
+#else
+        for (const auto& m : map) {
+            const size_t sb = m.first / 8, dw = m.second / 64;
+            auto it = std::find_if(steps_.begin(), steps_.end(), [&](const Step& s) {
+                return s.srcByte == sb && s.dstWord == dw;
+            });
+            if (it == steps_.end()) {
+                steps_.push_back({ sb, dw, {} });
+                it = steps_.end() - 1;
+            }
+            const uint64_t db = uint64_t(1) << (m.second % 64);
+            for (size_t v = 0; v < 256; v++) {
+                if (v & (size_t(1) << (m.first % 8))) it->lut[v] |= db;
+            }
+        }
+#endif
+    }
+
+    /// @brief Remaps the words of one FlagField.
+    void remap_(const uint64_t* in, uint64_t* out) const {
+        std::fill(out, out + NewField::numWords(), uint64_t(0));
+#ifdef __BMI2__
+        for (const Step& s : steps_) {
+            out[s.dstWord] |= _pdep_u64(_pext_u64(in[s.srcWord], s.src), s.dst);
+        }
+#else
+        for (const Step& s : steps_) {
+            out[s.dstWord] |= s.lut[(in[s.srcByte / 8] >> (8 * (s.srcByte % 8))) & 0xFF];
+        }
+#endif
+    }
+
+    /// @brief Loads a persisted byte array into words.
+    static void loadWords_(const uint8_t* bytes, uint64_t* words, const size_t& n) {
+        for (size_t w = 0; w * 8 < n; w++) {
+            uint64_t v = 0;
+            for (size_t b = 0; b < 8 && w * 8 + b < n; b++) {
+                v |= uint64_t(bytes[w * 8 + b]) << (8 * b);
+            }
+            words[w] = v;
+        }
+        // Drop padding bits past the last managed flag
+        if (OLD_MAX % 64) words[(OLD_MAX - 1) / 64] &= (uint64_t(1) << (OLD_MAX % 64)) - 1;
+    }
+
+    /// @brief Stores words into a persisted byte array.
+    static void storeWords_(const uint64_t* words, uint8_t* bytes, const size_t& n) {
+        for (size_t b = 0; b < n; b++) bytes[b] = uint8_t(words[b / 8] >> (8 * (b % 8)));
+    }
+};
+
+#endif // FLAGREMAP_HPP
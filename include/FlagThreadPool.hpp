@@ -0,0 +1,177 @@
+/**
+ * @file FlagThreadPool.hpp
+ * @author Ray Richter
+ * @brief Declaration and definition of the FlagThreadPool class.
+ * @details A small fixed size thread pool used by the FlagField algorithms
+ * to split word ranges across cores. The calling thread always runs one of
+ * the chunks itself, so a pool of size 1 has no worker threads at all.
+ */
+#pragma once
+#ifndef FLAGTHREADPOOL_HPP
+#define FLAGTHREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief A fixed size pool of threads running chunked parallel loops.
+/// @note Example usage:
+/// ```
+/// FlagThreadPool pool(4);
+/// pool.parallelFor(rows, [&](size_t begin, size_t end) {
+///     for (size_t i = begin; i < end; i++) { /* ... */ }
+/// });
+/// ```
+class FlagThreadPool {
+public:
+/// @section Constructors and Deconstructors
+
+    /// @brief Constructs a pool running loops on `threads` threads, including the caller.
+    /// @note `0` uses one thread per hardware thread.
+    explicit FlagThreadPool(size_t threads = 0) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        for (size_t i = 1; i < threads; i++) {
+            workers_.emplace_back([this, i] { work_(i); });
+        }
+    }
+
+    FlagThreadPool(const FlagThreadPool&) = delete;
+    FlagThreadPool& operator=(const FlagThreadPool&) = delete;
+
+    /// @brief Deconstructor. Joins every worker.
+    ~FlagThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+/// @section Accessors
+
+    /// @brief Gets the number of threads running loops, including the caller.
+    size_t size() const { return workers_.size() + 1; }
+
+    /// @brief Gets a pool shared by the whole program, with one thread per hardware thread.
+    static FlagThreadPool& global() {
+        static FlagThreadPool pool;
+        return pool;
+    }
+
+/// @section Parallel Loops
+
+    /// @brief Splits `[0, n)` into contiguous chunks and calls `fn(begin, end)` once per chunk.
+    /// @note Blocks until every chunk is done. Chunks are aligned to `align` so
+    /// threads never share a word when `align` is 64 and indices are flags.
+    /// A `parallelFor()` of this pool from inside one of its chunks runs serially on
+    /// the calling thread. If a chunk throws, the first exception is rethrown once
+    /// every chunk has finished.
+    template <class Fn>
+    void parallelFor(const size_t& n, Fn&& fn, const size_t& align = 1) {
+        const size_t units = (n + align - 1) / align;
+        const size_t chunks = units < size() ? units : size();
+        if (chunks <= 1 || inside_() == this) {
+            if (n) fn(size_t(0), n);
+            return;
+        }
+        auto chunk = [&](size_t c) {
+            const size_t begin = units * c / chunks * align;
+            const size_t end = c + 1 == chunks ? n : units * (c + 1) / chunks * align;
+            if (begin < end) fn(begin, end);
+        };
+        run_(chunks, chunk);
+    }
+
+/// @section Private Members
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    std::function<void(size_t)> job_;
+    size_t chunks_ = 0;
+    size_t generation_ = 0;
+    size_t remaining_ = 0;
+    bool stop_ = false;
+    /// @brief The first exception thrown by a chunk of the running loop.
+    std::exception_ptr error_;
+    /// @brief Serializes loops started from different threads.
+    std::mutex run_mutex_;
+
+    /// @brief Runs `chunks` chunks, chunk 0 on the caller and the rest on workers.
+    void run_(const size_t& chunks, const std::function<void(size_t)>& job) {
+        std::lock_guard<std::mutex> running(run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = job;
+            chunks_ = chunks;
+            remaining_ = workers_.size();
+            generation_++;
+        }
+        wake_.notify_all();
+        // The workers hold references into the caller's frame: wait for them even if chunk 0 throws
+        std::exception_ptr error;
+        try {
+            Inside_ inside(this);
+            job(0);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return remaining_ == 0; });
+        job_ = nullptr;
+        if (!error) error = error_;
+        error_ = nullptr;
+        lock.unlock();
+        if (error) std::rethrow_exception(error);
+    }
+
+    /// @brief Gets the pool whose chunk the calling thread is running, if any.
+    static const FlagThreadPool*& inside_() {
+        static thread_local const FlagThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    /// @brief Marks the calling thread as running a chunk of a pool for a scope.
+    struct Inside_ {
+        const FlagThreadPool* previous;
+        explicit Inside_(const FlagThreadPool* pool) : previous(inside_()) { inside_() = pool; }
+        ~Inside_() { inside_() = previous; }
+    };
+
+    /// @brief Worker loop. Worker `i` runs chunk `i` of each loop, if there is one.
+    void work_(const size_t& i) {
+        size_t seen = 0;
+        for (;;) {
+            std::function<void(size_t)> job;
+            size_t chunks;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                job = job_;
+                chunks = chunks_;
+            }
+            std::exception_ptr error;
+            if (i < chunks) {
+                try {
+                    Inside_ inside(this);
+                    job(i);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error && !error_) error_ = error;
+            if (--remaining_ == 0) done_.notify_one();
+        }
+    }
+};
+
+#endif // FLAGTHREADPOOL_HPP
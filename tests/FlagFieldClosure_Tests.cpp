@@ -0,0 +1,102 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldClosure.hpp>
+#include <FlagFieldRandom.hpp>
+
+/// @brief Reachability by a DFS from every node, as a reference.
+std::vector<std::vector<bool>> reference_closure(const std::vector<std::vector<size_t>>& adj) {
+    const size_t n = adj.size();
+    std::vector<std::vector<bool>> reach(n, std::vector<bool>(n, false));
+    for (size_t s = 0; s < n; s++) {
+        std::vector<size_t> stack(adj[s].begin(), adj[s].end());
+        while (!stack.empty()) {
+            const size_t u = stack.back();
+            stack.pop_back();
+            if (reach[s][u]) continue;
+            reach[s][u] = true;
+            for (size_t v : adj[u]) stack.push_back(v);
+        }
+    }
+    return reach;
+}
+
+template <size_t N>
+bool matches(const FlagClosure<N>& c, const std::vector<std::vector<bool>>& reach) {
+    for (size_t u = 0; u < reach.size(); u++) {
+        for (size_t v = 0; v < reach.size(); v++) {
+            if (c.reaches(u, v) != reach[u][v]) return false;
+        }
+    }
+    return true;
+}
+
+void test_chain() {
+    std::cout << "Testing a chain with a cycle..." << std::endl;
+    FlagClosure<200> c(150);
+    for (size_t i = 0; i + 1 < 150; i++) c.addEdge(i, i + 1);
+    c.addEdge(100, 70);
+    assert(!c.reaches(0, 0));
+    c.close();
+    assert(c.closed());
+    assert(c.reaches(0, 149));
+    assert(!c.reaches(149, 0));
+    assert(c.reaches(80, 75));
+    assert(c.reaches(70, 70));
+    assert(!c.reaches(69, 69));
+    assert(c.reachableFrom(0).numSetFlags() == 149);
+}
+
+void test_random_graphs() {
+    std::cout << "Testing random graphs against a DFS..." << std::endl;
+    FlagXoshiro rng(21);
+    FlagThreadPool pool(3);
+    for (size_t round = 0; round < 4; round++) {
+        const size_t n = 300 + round * 37;
+        FlagClosure<500> c(n);
+        if (round % 2) c.setThreadPool(&pool);
+        std::vector<std::vector<size_t>> adj(n);
+        for (size_t e = 0; e < n * (round + 1) / 2; e++) {
+            const size_t u = randomBelow(rng, n), v = randomBelow(rng, n);
+            c.addEdge(u, v);
+            adj[u].push_back(v);
+        }
+        c.close();
+        assert(matches(c, reference_closure(adj)));
+    }
+}
+
+void test_incremental() {
+    std::cout << "Testing incremental edges..." << std::endl;
+    FlagXoshiro rng(22);
+    const size_t n = 250;
+    FlagClosure<256> c(n);
+    std::vector<std::vector<size_t>> adj(n);
+    c.close();
+    for (size_t e = 0; e < 300; e++) {
+        const size_t u = randomBelow(rng, n), v = randomBelow(rng, n);
+        c.addEdge(u, v);
+        adj[u].push_back(v);
+        if (e % 50 == 0) assert(matches(c, reference_closure(adj)));
+    }
+    assert(matches(c, reference_closure(adj)));
+}
+
+void run_all_tests() {
+    test_chain();
+    test_random_graphs();
+    test_incremental();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
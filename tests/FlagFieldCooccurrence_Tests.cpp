@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldCooccurrence.hpp>
+#include <FlagFieldRandom.hpp>
+
+enum Event {
+    ERROR, SHOULD_CLOSE, RETRY, IDLE, MAX_EVENT
+};
+
+template <size_t MAX>
+void check_random(const size_t& n, const uint64_t& seed) {
+    FlagXoshiro rng(seed);
+    std::vector<FlagField<MAX>> rows(n);
+    for (size_t r = 0; r < n; r++) fillRandom(rows[r], rng, (r % 5) / 4.0 * 0.5);
+    FlagCooccurrence<MAX> co;
+    co.add(rows.data(), n);
+    FlagCooccurrence<MAX> pooled;
+    FlagThreadPool pool(3);
+    pooled.add(rows.data(), n, &pool);
+    assert(co.rows() == n && pooled.rows() == n);
+    for (size_t i = 0; i < MAX; i++) {
+        for (size_t j = 0; j < MAX; j++) {
+            uint64_t expect = 0;
+            for (size_t r = 0; r < n; r++) expect += rows[r].isSet(i) && rows[r].isSet(j);
+            assert(co.count(i, j) == expect);
+            assert(pooled.count(i, j) == expect);
+        }
+    }
+}
+
+void test_counts() {
+    std::cout << "Testing pair counts against isSet loops..." << std::endl;
+    for (size_t n : {0, 1, 63, 64, 65, 1500}) {
+        check_random<7>(n, n + 1);
+        check_random<64>(n, n + 2);
+        check_random<100>(n, n + 3);
+    }
+    // Several blocks, the last one partial
+    check_random<20>(2 * FlagCooccurrence<20>::blockRows + 777, 9);
+}
+
+void test_statistics() {
+    std::cout << "Testing lift, PMI and phi..." << std::endl;
+    using Events = FlagField<MAX_EVENT, Event>;
+    std::vector<Events> rows(1000);
+    for (size_t r = 0; r < rows.size(); r++) {
+        // ERROR in 10%, always with SHOULD_CLOSE; SHOULD_CLOSE in 20%; RETRY independent at 50%
+        if (r % 10 == 0) rows[r].set(ERROR);
+        if (r % 5 == 0) rows[r].set(SHOULD_CLOSE);
+        if (r % 2 == 1) rows[r].set(RETRY);
+    }
+    FlagCooccurrence<MAX_EVENT> co;
+    co.add(rows.data(), 400);
+    co.add(rows.data() + 400, 600);
+    assert(co.count(ERROR) == 100 && co.count(SHOULD_CLOSE) == 200);
+    assert(co.count(ERROR, SHOULD_CLOSE) == 100 && co.count(SHOULD_CLOSE, ERROR) == 100);
+    assert(std::fabs(co.support(ERROR, SHOULD_CLOSE) - 0.1) < 1e-12);
+    assert(std::fabs(co.lift(ERROR, SHOULD_CLOSE) - 5.0) < 1e-12);
+    assert(std::fabs(co.pmi(ERROR, SHOULD_CLOSE) - std::log2(5.0)) < 1e-12);
+    // phi = (n c_ij - c_i c_j) / sqrt(c_i (n - c_i) c_j (n - c_j)) = 80000 / sqrt(100 * 900 * 200 * 800)
+    assert(std::fabs(co.phi(ERROR, SHOULD_CLOSE) - 80000.0 / std::sqrt(100.0 * 900 * 200 * 800)) < 1e-12);
+    // ERROR rows are all even, RETRY rows all odd
+    assert(co.count(ERROR, RETRY) == 0);
+    assert(co.lift(ERROR, RETRY) == 0.0);
+    assert(std::isinf(co.pmi(ERROR, RETRY)) && co.pmi(ERROR, RETRY) < 0);
+    // IDLE is never set
+    assert(co.lift(IDLE, ERROR) == 0.0 && co.phi(IDLE, ERROR) == 0.0);
+
+    FlagCooccurrence<MAX_EVENT> twice = co;
+    twice.merge(co);
+    assert(twice.rows() == 2000 && twice.count(ERROR, SHOULD_CLOSE) == 200);
+    twice.clear();
+    assert(twice.rows() == 0 && twice.count(ERROR) == 0);
+}
+
+void run_all_tests() {
+    test_counts();
+    test_statistics();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldCoverage.hpp>
+#include <FlagFieldRandom.hpp>
+
+const size_t edges = 4096;
+using Trace = FlagCoverageTrace<edges>;
+using Virgin = FlagCoverageVirgin<edges>;
+
+uint8_t model_bucket(const unsigned& count) {
+    if (count == 0) return 0;
+    if (count <= 3) return uint8_t(count == 3 ? 4 : count);
+    if (count <= 7) return 8;
+    if (count <= 15) return 16;
+    if (count <= 31) return 32;
+    if (count <= 127) return 64;
+    return 128;
+}
+
+// Byte by byte reference: 2 for a new edge, 1 for a new bucket only
+int model_has_new_bits(const uint8_t* trace, std::vector<uint8_t>& virgin) {
+    int result = 0;
+    for (size_t e = 0; e < edges; e++) {
+        if (!(trace[e] & virgin[e])) continue;
+        result = std::max(result, virgin[e] == 0xFF ? 2 : 1);
+        virgin[e] &= uint8_t(~trace[e]);
+    }
+    return result;
+}
+
+void random_run(FlagXoshiro& rng, Trace& trace, const size_t& hits) {
+    for (size_t k = 0; k < hits; k++) {
+        // A few hot edges take many hits, so every bucket shows up
+        const size_t edge = randomBelow(rng, 4) ? randomBelow(rng, edges) : randomBelow(rng, 16);
+        trace.hit(edge);
+    }
+}
+
+void test_classify() {
+    std::cout << "Testing hit count bucketing..." << std::endl;
+    std::unique_ptr<Trace> trace(new Trace);
+    for (unsigned c = 0; c < 256; c++) trace->counts()[c] = uint8_t(c);
+    for (unsigned c = 0; c < 256; c++) trace->counts()[edges - 1 - c] = uint8_t(c);
+    assert(trace->edges() == 2 * 255);
+    trace->classify();
+    for (unsigned c = 0; c < 256; c++) {
+        assert(trace->counts()[c] == model_bucket(c));
+        assert(trace->counts()[edges - 1 - c] == model_bucket(c));
+        assert(FlagCoverageKernels::table()[c] == model_bucket(c));
+    }
+    assert(trace->edges() == 2 * 255);
+    assert(trace->field().isSet(8 * 3 + 2) && !trace->field().isSet(8 * 3 + 1));
+    assert(trace->field().isSet(8 * 200 + 7));
+    trace->reset();
+    assert(trace->edges() == 0);
+}
+
+void test_has_new_bits() {
+    std::cout << "Testing hasNewBits against a byte loop..." << std::endl;
+    FlagXoshiro rng(1);
+    std::unique_ptr<Trace> trace(new Trace);
+    std::unique_ptr<Virgin> virgin(new Virgin);
+    std::vector<uint8_t> model(edges, 0xFF);
+    bool sawEdges = false, sawHits = false, sawNone = false;
+    for (size_t run = 0; run < 300; run++) {
+        random_run(rng, *trace, randomBelow(rng, 2) ? randomBelow(rng, 40) : randomBelow(rng, 2000));
+        std::vector<uint8_t> counts(trace->counts(), trace->counts() + edges);
+        trace->classify();
+        for (size_t e = 0; e < edges; e++) assert(trace->counts()[e] == model_bucket(counts[e]));
+        const int expected = model_has_new_bits(trace->counts(), model);
+        const FlagCoverageResult result = hasNewBits(*trace, *virgin);
+        assert(int(result) == expected);
+        sawNone |= expected == 0, sawHits |= expected == 1, sawEdges |= expected == 2;
+        assert(std::memcmp(*const_cast<Virgin::Field&>(virgin->field()), model.data(), edges) == 0);
+        assert(virgin->hasNewBits(*trace) == FlagCoverageResult::None);
+
+        // Alternate the sparse and the full reset
+        if (run % 2) trace->resetTouched();
+        else trace->reset();
+        assert(trace->edges() == 0);
+    }
+    assert(sawNone && sawHits && sawEdges);
+    size_t covered = 0;
+    for (uint8_t v : model) covered += v != 0xFF;
+    assert(virgin->coveredEdges() == covered);
+}
+
+void test_merge() {
+    std::cout << "Testing merging workers' virgin maps..." << std::endl;
+    FlagXoshiro rng(2);
+    std::unique_ptr<Trace> trace(new Trace);
+    std::unique_ptr<Virgin> global(new Virgin), a(new Virgin), b(new Virgin), both(new Virgin);
+    for (size_t run = 0; run < 50; run++) {
+        random_run(rng, *trace, randomBelow(rng, 300));
+        trace->classify();
+        (run % 2 ? *a : *b).hasNewBits(*trace);
+        both->hasNewBits(*trace);
+        trace->resetTouched();
+    }
+    assert(global->merge(*a));
+    assert(global->merge(*b));
+    assert(!global->merge(*b));
+    for (size_t w = 0; w < Virgin::Field::numWords(); w++) assert(global->field().word(w) == both->field().word(w));
+    assert(global->coveredEdges() == both->coveredEdges());
+    global->reset();
+    assert(global->coveredEdges() == 0);
+}
+
+void run_all_tests() {
+    test_classify();
+    test_has_new_bits();
+    test_merge();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
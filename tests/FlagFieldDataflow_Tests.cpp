@@ -0,0 +1,172 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldDataflow.hpp>
+#include <FlagFieldRandom.hpp>
+
+typedef enum Vars {
+    VAR_A,
+    VAR_B,
+    VAR_C,
+    VAR_D,
+    VAR_MAX
+} Vars;
+
+void test_liveness() {
+    std::cout << "Testing backward liveness..." << std::endl;
+    // 0: a = 1        -> 1
+    // 1: b = a + 1    -> 2
+    // 2: c = c + b    -> 3
+    // 3: a = b * 2    -> 1 (loop), 4
+    // 4: return c
+    FlagDataflow<VAR_MAX, FlagFlow::Backward> live(5);
+    live.addEdge(0, 1);
+    live.addEdge(1, 2);
+    live.addEdge(2, 3);
+    live.addEdge(3, 1);
+    live.addEdge(3, 4);
+    live.kill(0).set(VAR_A);
+    live.gen(1).set(VAR_A);
+    live.kill(1).set(VAR_B);
+    live.gen(2).set(VAR_C, VAR_B);
+    live.kill(2).set(VAR_C);
+    live.gen(3).set(VAR_B);
+    live.kill(3).set(VAR_A);
+    live.gen(4).set(VAR_C);
+    live.solve();
+
+    assert(live.in(0).isSet(VAR_C));
+    assert(live.in(0).numSetFlags() == 1);
+    assert(live.in(1).isSet(VAR_A, VAR_C));
+    assert(live.in(1).numSetFlags() == 2);
+    assert(live.in(2).isSet(VAR_B, VAR_C));
+    assert(live.in(2).numSetFlags() == 2);
+    assert(live.out(3).isSet(VAR_A, VAR_C));
+    assert(live.out(4).isNSet());
+}
+
+void test_available() {
+    std::cout << "Testing forward intersection (available expressions)..." << std::endl;
+    // 0 -> 1, 2
+    // 1, 2 -> 3
+    // 3 <-> 4
+    FlagDataflow<200, FlagFlow::Forward, FlagMeetIntersect> avail(5);
+    avail.addEdge(0, 1);
+    avail.addEdge(0, 2);
+    avail.addEdge(1, 3);
+    avail.addEdge(2, 3);
+    avail.addEdge(3, 4);
+    avail.addEdge(4, 3);
+    avail.gen(0).set(10);
+    avail.gen(1).set(20, 150);
+    avail.gen(2).set(150, 199);
+    avail.kill(4).set(10);
+    avail.solve();
+
+    assert(avail.out(0).isSet(10));
+    assert(avail.in(3).isSet(150));
+    assert(avail.in(3).numSetFlags() == 1);
+    assert(avail.out(4).isSet(150));
+    assert(avail.out(4).numSetFlags() == 1);
+}
+
+void test_loop_entry() {
+    std::cout << "Testing an entry block that heads a loop..." << std::endl;
+    // 0 <-> 1, with 0 the entry
+    FlagDataflow<64, FlagFlow::Forward, FlagMeetIntersect> must(2);
+    must.addEdge(0, 1);
+    must.addEdge(1, 0);
+    must.addBoundary(0);
+    must.gen(1).set(5);
+    must.solve();
+    assert(!must.in(0).isSet(5));
+    assert(must.out(1).isSet(5));
+    assert(must.in(1).isNSet());
+
+    FlagDataflow<64, FlagFlow::Forward> may(2);
+    may.addEdge(0, 1);
+    may.addEdge(1, 0);
+    may.addBoundary(0);
+    may.boundary().set(9);
+    may.gen(1).set(5);
+    may.solve();
+    assert(may.in(0).isSet(5, 9));
+    assert(may.in(0).numSetFlags() == 2);
+    assert(may.in(1).isSet(5, 9));
+
+    // Backward: 1 <-> 2, with 2 the exit
+    FlagDataflow<64, FlagFlow::Backward, FlagMeetIntersect> back(3);
+    back.addEdge(0, 1);
+    back.addEdge(1, 2);
+    back.addEdge(2, 1);
+    back.addBoundary(2);
+    back.gen(1).set(3);
+    back.solve();
+    assert(!back.out(2).isSet(3));
+    assert(back.in(1).isSet(3));
+}
+
+/// @brief Round robin solver with FlagField operators, as a reference.
+template <size_t N>
+void reference_reaching(size_t n, const std::vector<std::pair<size_t, size_t>>& edges,
+                        const std::vector<FlagField<N>>& gen, const std::vector<FlagField<N>>& kill,
+                        std::vector<FlagField<N>>& in, std::vector<FlagField<N>>& out) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b = 0; b < n; b++) {
+            in[b].clear();
+            for (const auto& e : edges) if (e.second == b) in[b] |= out[e.first];
+            FlagField<N> x = gen[b] + (in[b] - kill[b]);
+            if (x != out[b] || out[b] != x) { out[b] = x; changed = true; }
+        }
+    }
+}
+
+void test_against_reference() {
+    std::cout << "Testing forward union against a reference solver..." << std::endl;
+    const size_t n = 60;
+    FlagXoshiro rng(5);
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t b = 0; b + 1 < n; b++) edges.emplace_back(b, b + 1);
+    for (size_t i = 0; i < 40; i++) edges.emplace_back(randomBelow(rng, n), randomBelow(rng, n));
+
+    std::vector<FlagField<130>> gen(n), kill(n), in(n), out(n);
+    FlagDataflow<130, FlagFlow::Forward> reach(n);
+    for (const auto& e : edges) reach.addEdge(e.first, e.second);
+    for (size_t b = 0; b < n; b++) {
+        fillRandom(gen[b], rng, 0.05);
+        fillRandom(kill[b], rng, 0.2);
+        for (size_t w = 0; w < gen[b].numWords(); w++) {
+            reach.gen(b).setWord(w, gen[b].word(w));
+            reach.kill(b).setWord(w, kill[b].word(w));
+        }
+    }
+    reference_reaching(n, edges, gen, kill, in, out);
+    reach.solve();
+    for (size_t b = 0; b < n; b++) {
+        for (size_t w = 0; w < out[b].numWords(); w++) {
+            assert(reach.out(b).word(w) == out[b].word(w));
+            assert(reach.in(b).word(w) == in[b].word(w));
+        }
+    }
+}
+
+void run_all_tests() {
+    test_liveness();
+    test_available();
+    test_loop_entry();
+    test_against_reference();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldDirty.hpp>
+#include <FlagFieldRandom.hpp>
+
+#include <sys/mman.h>
+
+const size_t page = FlagDirtyPages::pageSize;
+
+char* map_pages(const size_t& pages) {
+    void* p = mmap(nullptr, pages * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert(p != MAP_FAILED);
+    return static_cast<char*>(p);
+}
+
+void test_barrier_runs() {
+    std::cout << "Testing barrier mode runs against a model..." << std::endl;
+    FlagXoshiro rng(1);
+    const size_t pages = 300;
+    std::vector<char> region(pages * page - 100), snapshot(region.size());
+    FlagDirtyPages tracker(region.data(), region.size());
+    assert(tracker.pages() == pages && tracker.mode() == FlagDirtyMode::Barrier);
+    for (size_t round = 0; round < 20; round++) {
+        std::vector<bool> model(pages, false);
+        for (size_t k = 0; k < 1 + randomBelow(rng, 200); k++) {
+            const size_t at = randomBelow(rng, region.size());
+            const size_t n = 1 + randomBelow(rng, region.size() - at < 3 * page ? region.size() - at : 3 * page);
+            std::memset(&region[at], int(randomBelow(rng, 256)), n);
+            tracker.markDirty(&region[at], n);
+            for (size_t i = at / page; i <= (at + n - 1) / page; i++) model[i] = true;
+        }
+        size_t dirty = 0;
+        for (size_t i = 0; i < pages; i++) {
+            assert(tracker.isDirty(&region[i * page]) == model[i]);
+            dirty += model[i];
+        }
+        assert(tracker.dirtyPages() == dirty);
+        FlagField<100> window;
+        tracker.copyTo(150, window);
+        for (size_t i = 0; i < 100; i++) assert(window.isSet(i) == model[150 + i]);
+
+        // Maximal runs, in order, ending at the region's last byte
+        std::vector<std::pair<size_t, size_t>> runs, expected;
+        for (size_t i = 0; i < pages;) {
+            if (!model[i]) {
+                i++;
+                continue;
+            }
+            size_t end = i;
+            while (end < pages && model[end]) end++;
+            expected.push_back({i * page, (end < pages ? end * page : region.size()) - i * page});
+            i = end;
+        }
+        if (round % 2) {
+            tracker.collect([&](size_t offset, size_t n) {
+                runs.push_back({offset, n});
+                std::memcpy(&snapshot[offset], &region[offset], n);
+            });
+            assert(runs == expected);
+        } else {
+            tracker.checkpoint(snapshot.data());
+        }
+        assert(tracker.dirtyPages() == 0);
+        assert(std::memcmp(region.data(), snapshot.data(), region.size()) == 0);
+    }
+}
+
+template <class Write>
+void check_faulting_mode(const FlagDirtyMode& mode, Write&& write) {
+    FlagXoshiro rng(2);
+    const size_t pages = 256;
+    char* region = map_pages(pages);
+    std::memset(region, 0, pages * page);
+    std::vector<char> snapshot(pages * page, 0);
+    {
+        FlagDirtyPages tracker(region, pages * page, mode);
+        for (size_t round = 0; round < 10; round++) {
+            std::vector<bool> model(pages, false);
+            size_t dirty = 0;
+            for (size_t k = 0; k < randomBelow(rng, 100); k++) {
+                const size_t i = randomBelow(rng, pages);
+                write(region + i * page + randomBelow(rng, page), char(1 + randomBelow(rng, 255)));
+                dirty += !model[i];
+                model[i] = true;
+            }
+            assert(tracker.dirtyPages() == dirty);
+            for (size_t i = 0; i < pages; i++) assert(tracker.isDirty(region + i * page) == model[i]);
+            assert(tracker.checkpoint(snapshot.data()) == dirty * page);
+            assert(std::memcmp(region, snapshot.data(), pages * page) == 0);
+        }
+
+        // Writers keep running through checkpoints; nothing written is lost
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> writers;
+        for (uint64_t t = 0; t < 3; t++) {
+            writers.emplace_back([&, t] {
+                FlagXoshiro local(10 + t);
+                while (!stop.load()) write(region + randomBelow(local, pages * page), char(randomBelow(local, 256)));
+            });
+        }
+        for (size_t k = 0; k < 50; k++) tracker.checkpoint(snapshot.data());
+        stop = true;
+        for (auto& t : writers) t.join();
+        tracker.checkpoint(snapshot.data());
+        assert(std::memcmp(region, snapshot.data(), pages * page) == 0);
+    }
+    // Writable again once the tracker is gone
+    region[0] = 1;
+    munmap(region, pages * page);
+}
+
+void test_protect_mode() {
+    std::cout << "Testing mprotect mode..." << std::endl;
+    check_faulting_mode(FlagDirtyMode::Protect, [](char* p, char c) { *reinterpret_cast<volatile char*>(p) = c; });
+
+    // Two regions at once share the handler
+    char* a = map_pages(4);
+    char* b = map_pages(4);
+    {
+        FlagDirtyPages ta(a, 4 * page, FlagDirtyMode::Protect), tb(b, 4 * page, FlagDirtyMode::Protect);
+        a[page] = 1;
+        b[3 * page] = 1;
+        assert(ta.dirtyPages() == 1 && ta.isDirty(a + page));
+        assert(tb.dirtyPages() == 1 && tb.isDirty(b + 3 * page));
+    }
+    munmap(a, 4 * page);
+    munmap(b, 4 * page);
+
+    bool thrown = false;
+    try {
+        FlagDirtyPages unaligned(a + 1, page, FlagDirtyMode::Protect);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void test_userfault_mode() {
+    std::cout << "Testing userfaultfd mode..." << std::endl;
+    char* probe = map_pages(1);
+    try {
+        FlagDirtyPages tracker(probe, page, FlagDirtyMode::Userfault);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Skipped: " << e.what() << std::endl;
+        munmap(probe, page);
+        return;
+    }
+    munmap(probe, page);
+    check_faulting_mode(FlagDirtyMode::Userfault, [](char* p, char c) { *reinterpret_cast<volatile char*>(p) = c; });
+}
+
+void run_all_tests() {
+    test_barrier_runs();
+    test_protect_mode();
+    test_userfault_mode();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
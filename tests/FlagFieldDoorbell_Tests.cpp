@@ -0,0 +1,82 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldDoorbell.hpp>
+#include <FlagFieldRandom.hpp>
+
+void test_single_thread() {
+    std::cout << "Testing ring and drain..." << std::endl;
+    FlagDoorbell<300> bell;
+    assert(bell.ring(200));
+    assert(!bell.ring(5));      // the consumer is already woken
+    assert(!bell.ring(200));
+    assert(!bell.ring(299));
+    assert(bell.ready().numSetFlags() == 3);
+    bell.wait();                // returns at once: rung before the call
+    std::vector<size_t> order;
+    assert(bell.drain([&](size_t s) { order.push_back(s); }) == 3);
+    assert(order == std::vector<size_t>({5, 200, 299}));
+    assert(bell.drain([&](size_t) { assert(false); }) == 0);
+    assert(bell.ring(64));
+    FlagDoorbell<300>::Sources out;
+    out.set(1);
+    assert(bell.drain(out) == 1 && out.isSet(64) && !out.isSet(1) && out.numSetFlags() == 1);
+#ifdef __linux__
+    assert(bell.fd() >= 0);
+#endif
+}
+
+void test_producers() {
+    std::cout << "Testing many producers against one consumer..." << std::endl;
+    constexpr size_t sources = 256, producers = 8, rounds = 2000;
+    FlagDoorbell<sources + 1> bell;
+    // Each producer owns sources p, p + producers, ...: it rings one and waits for it to be handled
+    std::vector<std::atomic<size_t>> handled(sources);
+    std::vector<std::atomic<size_t>> rung(sources);
+    std::atomic<bool> stop(false);
+    std::thread consumer([&] {
+        while (!stop) {
+            bell.wait();
+            bell.drain([&](size_t s) {
+                if (s == sources) stop = true;
+                else handled[s] = rung[s].load();
+            });
+        }
+    });
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            FlagXoshiro rng(p + 1);
+            for (size_t r = 1; r <= rounds; r++) {
+                const size_t s = p + producers * randomBelow(rng, sources / producers);
+                rung[s] = r;
+                bell.ring(s);
+                // A lost wake-up would hang here
+                while (handled[s] != r) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    bell.ring(sources);
+    consumer.join();
+    assert(bell.ready().numSetFlags() == 0);
+}
+
+void run_all_tests() {
+    test_single_thread();
+    test_producers();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldECS.hpp>
+#include <FlagFieldRandom.hpp>
+
+enum Component {
+    Position, Velocity, Health, Frozen, Renderable, MAX_COMPONENTS
+};
+
+using Sig = FlagField<MAX_COMPONENTS, Component>;
+
+void test_registry() {
+    std::cout << "Testing archetypes and queries..." << std::endl;
+    FlagArchetypes<MAX_COMPONENTS, Component> world;
+    const size_t movers = world.query(Sig(Position, Velocity), Sig(Frozen));
+    assert(world.query(Sig(Position, Velocity), Sig(Frozen)) == movers);
+
+    const size_t a = world.add(0, Sig(Position, Velocity));
+    world.add(1, Sig(Position, Velocity));
+    world.add(2, Sig(Position, Velocity, Frozen));
+    world.add(3, Sig(Position, Velocity, Health));
+    world.add(4, Sig(Health));
+    assert(world.numArchetypes() == 4);
+    assert(world.archetypeOf(1) == a);
+
+    // Archetypes created after the query was registered were added to it
+    assert(world.archetypes(movers).size() == 2);
+    assert(world.count(movers) == 3);
+
+    // A query registered later scans the existing archetypes
+    const size_t health = world.query(Sig(Health));
+    assert(world.count(health) == 2);
+
+    // Moving and removing entities keeps the arrays contiguous
+    world.add(0, Sig(Position, Velocity, Frozen));
+    assert(world.count(movers) == 2);
+    world.remove(3);
+    world.remove(3);
+    assert(world.count(movers) == 1);
+    assert(world.archetypeOf(3) == world.none);
+    size_t seen = 0;
+    world.forEach(movers, [&](const size_t* entities, size_t count, size_t arch) {
+        assert(arch == a && count == 1 && entities[0] == 1);
+        seen += count;
+    });
+    assert(seen == 1);
+    assert(world.entities(world.archetypeOf(2)).size() == 2);
+}
+
+void test_random_world() {
+    std::cout << "Testing a random world against per entity checks..." << std::endl;
+    constexpr size_t C = 100;
+    using S = FlagField<C>;
+    FlagXoshiro rng(61);
+    FlagArchetypes<C> world;
+    std::vector<S> sigs(3000);
+    std::vector<std::pair<S, S>> queries;
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < sigs.size(); i++) {
+        // Signatures drawn from a small pool so archetypes are shared
+        FlagXoshiro pick(randomBelow(rng, 50));
+        fillRandom(sigs[i], pick, 0.1);
+        world.add(i, sigs[i]);
+        if (i % 500 == 0) {
+            S req, exc;
+            req.set(size_t(randomBelow(rng, C)));
+            exc.set(size_t(randomBelow(rng, C)));
+            queries.emplace_back(req, exc);
+            ids.push_back(world.query(req, exc));
+        }
+    }
+    for (size_t q = 0; q < ids.size(); q++) {
+        std::vector<uint8_t> got(sigs.size(), 0);
+        world.forEach(ids[q], [&](const size_t* e, size_t n, size_t) {
+            for (size_t i = 0; i < n; i++) got[e[i]]++;
+        });
+        for (size_t i = 0; i < sigs.size(); i++) {
+            const bool match = sigs[i].isSet(queries[q].first) && sigs[i].isNSet(queries[q].second);
+            assert(got[i] == (match ? 1 : 0));
+        }
+    }
+}
+
+void run_all_tests() {
+    test_registry();
+    test_random_world();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
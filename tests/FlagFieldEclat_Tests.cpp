@@ -0,0 +1,132 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldEclat.hpp>
+#include <FlagFieldRandom.hpp>
+
+enum Alert {
+    ERROR, SHOULD_CLOSE, RETRY, TIMEOUT, DEGRADED, MAX_ALERT
+};
+
+/// @brief Finds every frequent itemset by counting all subsets of `M` flags.
+template <size_t M>
+std::vector<std::pair<uint64_t, uint64_t>> bruteForce(const std::vector<FlagField<M>>& rows,
+                                                      const uint64_t& minSupport, const size_t& maxLength) {
+    std::vector<std::pair<uint64_t, uint64_t>> out;
+    for (uint64_t set = 1; set < (uint64_t(1) << M); set++) {
+        if (size_t(__builtin_popcountll(set)) > maxLength) continue;
+        uint64_t s = 0;
+        for (const auto& r : rows) s += (r.word(0) & set) == set;
+        if (s >= minSupport && s > 0) out.emplace_back(set, s);
+    }
+    return out;
+}
+
+template <size_t M>
+void check_against_brute_force(const size_t& n, const uint64_t& minSupport, const size_t& maxLength,
+                               const uint64_t& seed) {
+    FlagXoshiro rng(seed);
+    std::vector<FlagField<M>> rows(n);
+    for (auto& r : rows) fillRandom(r, rng, 0.4);
+    FlagEclat<M> miner(rows.data(), n);
+    auto expect = bruteForce(rows, minSupport, maxLength);
+    FlagThreadPool pool(3);
+    for (FlagThreadPool* p : {(FlagThreadPool*)nullptr, &pool}) {
+        const auto got = miner.mine(minSupport, maxLength, p);
+        assert(got.size() == expect.size());
+        for (const auto& e : expect) {
+            bool found = false;
+            for (const auto& g : got) found |= g.items.word(0) == e.first && g.support == e.second;
+            assert(found);
+        }
+        // Most frequent first
+        for (size_t i = 1; i < got.size(); i++) assert(got[i - 1].support >= got[i].support);
+    }
+    for (const auto& e : expect) {
+        FlagField<M> items;
+        items.setWord(0, e.first);
+        assert(miner.support(items) == e.second);
+    }
+}
+
+void test_brute_force() {
+    std::cout << "Testing mined itemsets against all subsets..." << std::endl;
+    check_against_brute_force<10>(0, 1, 10, 1);
+    check_against_brute_force<10>(50, 1, 10, 2);
+    check_against_brute_force<10>(3000, 60, 10, 3);
+    check_against_brute_force<12>(5000, 20, 4, 4);
+    check_against_brute_force<12>(4000, 40, 12, 5);
+}
+
+void test_patterns() {
+    std::cout << "Testing planted flag combinations..." << std::endl;
+    constexpr size_t M = 100;
+    FlagXoshiro rng(65);
+    std::vector<FlagField<M>> rows(100000);
+    for (size_t r = 0; r < rows.size(); r++) {
+        fillRandom(rows[r], rng, 0.01);
+        // Flags 3, 40, 70 and 99 set together in 1 row in 10
+        if (r % 10 == 0) {
+            rows[r].set(3);
+            rows[r].set(40);
+            rows[r].set(70);
+            rows[r].set(99);
+        }
+    }
+    FlagEclat<M> miner(rows.data(), rows.size());
+    const auto sets = miner.mine(rows.size() / 20);
+    // The 15 non-empty subsets of the planted set and nothing else
+    assert(sets.size() == 15);
+    size_t full = 0;
+    for (const auto& s : sets) {
+        for (size_t f = 0; f < M; f++) {
+            if (s.items.isSet(f)) assert(f == 3 || f == 40 || f == 70 || f == 99);
+        }
+        if (s.items.numSetFlags() == 4) {
+            full++;
+            assert(s.support >= rows.size() / 10);
+        }
+    }
+    assert(full == 1);
+    assert(miner.mine(rows.size() / 20, 2).size() == 10);
+    assert(miner.mine(rows.size()).empty());
+}
+
+void test_enum() {
+    std::cout << "Testing an enum FlagField..." << std::endl;
+    using Alerts = FlagField<MAX_ALERT, Alert>;
+    std::vector<Alerts> rows(64 * 3 + 5);
+    for (size_t r = 0; r < rows.size(); r++) {
+        if (r % 2 == 0) rows[r].set(ERROR, SHOULD_CLOSE);
+        if (r % 3 == 0) rows[r].set(RETRY);
+    }
+    FlagEclat<MAX_ALERT> miner(rows.data(), rows.size());
+    assert(miner.rows() == rows.size());
+    assert(miner.support(ERROR) == 99 && miner.support(RETRY) == 66 && miner.support(TIMEOUT) == 0);
+    assert(miner.support(Alerts(ERROR, SHOULD_CLOSE, RETRY)) == 33);
+    const auto sets = miner.mine(50);
+    assert(sets.size() == 4);
+    assert(sets[0].support == 99 && sets[0].items.word(0) == 1);
+    assert(sets[1].support == 99 && sets[1].items.word(0) == 2);
+    assert(sets[2].support == 99 && sets[2].items.word(0) == 3);
+    assert(sets[3].support == 66 && sets[3].items.isSet(RETRY));
+}
+
+void run_all_tests() {
+    test_brute_force();
+    test_patterns();
+    test_enum();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
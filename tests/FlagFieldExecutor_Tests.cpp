@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldExecutor.hpp>
+#include <FlagFieldRandom.hpp>
+
+void test_external_spawns() {
+    std::cout << "Testing spawns from outside the executor..." << std::endl;
+    for (size_t workers : {1, 2, 5, 70}) {
+        FlagExecutor<> executor(workers);
+        assert(executor.size() == (workers < 64 ? workers : 64));
+        std::vector<std::atomic<int>> runs(5000);
+        for (size_t round = 0; round < 3; round++) {
+            for (auto& r : runs) executor.spawn([&r] { r++; });
+            executor.wait();
+            for (auto& r : runs) assert(r == int(round + 1));
+            assert(executor.busyWorkers().numSetFlags() == 0);
+        }
+    }
+}
+
+FlagExecutor<>* fibExecutor;
+
+void fib(const size_t n, std::atomic<size_t>& leaves) {
+    if (n < 2) {
+        leaves++;
+        return;
+    }
+    fibExecutor->spawn([n, &leaves] { fib(n - 1, leaves); });
+    fibExecutor->spawn([n, &leaves] { fib(n - 2, leaves); });
+}
+
+void test_nested_spawns() {
+    std::cout << "Testing spawns from tasks..." << std::endl;
+    FlagExecutor<> executor(4);
+    fibExecutor = &executor;
+    std::atomic<size_t> leaves(0);
+    executor.spawn([&] { fib(18, leaves); });
+    executor.wait();
+    assert(leaves == 4181);
+}
+
+void test_idle_wakeups() {
+    std::cout << "Testing wakeups of idle workers..." << std::endl;
+    FlagExecutor<128> executor(100);
+    // Let every worker park, then wake them one spawn at a time
+    for (size_t tries = 0; executor.idleWorkers().numSetFlags() != 100 && tries < 2000; tries++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(executor.idleWorkers().numSetFlags() == 100);
+    std::atomic<size_t> runs(0);
+    for (size_t i = 0; i < 200; i++) {
+        executor.spawn([&] { runs++; });
+        if (i % 3 == 0) executor.wait();
+    }
+    executor.wait();
+    assert(runs == 200);
+
+    // Tasks left at destruction still run
+    std::atomic<size_t> late(0);
+    {
+        FlagExecutor<> shortLived(3);
+        for (size_t i = 0; i < 1000; i++) shortLived.spawn([&] { late++; });
+    }
+    assert(late == 1000);
+}
+
+void run_all_tests() {
+    test_external_spawns();
+    test_nested_spawns();
+    test_idle_wakeups();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
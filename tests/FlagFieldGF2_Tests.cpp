@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldGF2.hpp>
+#include <FlagFieldRandom.hpp>
+
+template <size_t C>
+void randomize(FlagGF2Matrix<C>& m, FlagXoshiro& rng) {
+    for (size_t i = 0; i < m.rows(); i++) fillRandom(m[i], rng, 0.5);
+}
+
+/// @brief Row by row product, as a reference.
+template <size_t K, size_t C>
+FlagGF2Matrix<C> reference_multiply(const FlagGF2Matrix<K>& a, const FlagGF2Matrix<C>& b) {
+    FlagGF2Matrix<C> c(a.rows());
+    for (size_t i = 0; i < a.rows(); i++) {
+        for (size_t k = 0; k < b.rows(); k++) {
+            if (a[i].isSet(k)) c[i] ^= b[k];
+        }
+    }
+    return c;
+}
+
+void test_multiply() {
+    std::cout << "Testing Four Russians multiplication..." << std::endl;
+    FlagXoshiro rng(31);
+    FlagGF2Matrix<150> a(77);
+    FlagGF2Matrix<3000> b(150);
+    randomize(a, rng);
+    randomize(b, rng);
+    assert(FlagGF2Matrix<3000>::multiply(a, b) == reference_multiply(a, b));
+
+    FlagGF2Matrix<70> c(70);
+    randomize(c, rng);
+    assert(FlagGF2Matrix<70>::multiply(c, FlagGF2Matrix<70>::identity()) == c);
+    assert(FlagGF2Matrix<70>::multiply(FlagGF2Matrix<70>::identity(), c) == c);
+}
+
+void test_rank_and_echelon() {
+    std::cout << "Testing rank and row echelon form..." << std::endl;
+    FlagXoshiro rng(32);
+    assert(FlagGF2Matrix<100>::identity().rank() == 100);
+
+    // 40 random rows and 30 sums of them
+    FlagGF2Matrix<130> m(40);
+    randomize(m, rng);
+    const size_t r = m.rank();
+    assert(r == 40);
+    for (size_t i = 0; i < 30; i++) m.addRow(m[i] ^ m[i + 5] ^ m[39 - i]);
+    assert(m.rank() == 40);
+
+    assert(m.rowEchelon(true) == 40);
+    size_t last = 0;
+    for (size_t i = 0; i < 40; i++) {
+        // Leading ones move right and are the only ones in their column
+        size_t lead = 0;
+        while (!m[i].isSet(lead)) lead++;
+        assert(i == 0 || lead > last);
+        for (size_t j = 0; j < m.rows(); j++) assert(j == i || !m[j].isSet(lead));
+        last = lead;
+    }
+    for (size_t i = 40; i < m.rows(); i++) assert(m[i].numSetFlags() == 0);
+}
+
+void test_inverse() {
+    std::cout << "Testing inverses..." << std::endl;
+    FlagXoshiro rng(33);
+    size_t inverted = 0;
+    for (size_t round = 0; round < 10; round++) {
+        FlagGF2Matrix<100> m(100), inv;
+        randomize(m, rng);
+        if (m.inverse(inv)) {
+            inverted++;
+            assert(FlagGF2Matrix<100>::multiply(m, inv) == FlagGF2Matrix<100>::identity());
+            assert(FlagGF2Matrix<100>::multiply(inv, m) == FlagGF2Matrix<100>::identity());
+        } else {
+            assert(m.rank() < 100);
+        }
+    }
+    assert(inverted > 0);
+    FlagGF2Matrix<10> singular(10), inv;
+    assert(!singular.inverse(inv));
+}
+
+void test_solve() {
+    std::cout << "Testing linear systems..." << std::endl;
+    FlagXoshiro rng(34);
+    // Overdetermined but consistent: b = A x
+    FlagGF2Matrix<90> a(120);
+    randomize(a, rng);
+    FlagField<90, size_t, FlagCheck::Unchecked> x, y;
+    fillRandom(x, rng, 0.5);
+    FlagField<128, size_t, FlagCheck::Unchecked> b, check;
+    a.multiply(x, b);
+    assert(a.solve(b, y));
+    a.multiply(y, check);
+    assert(check == b && b == check);
+
+    // Inconsistent: two equal rows with different right hand sides
+    FlagGF2Matrix<8> e(2);
+    e[0].set(1);
+    e[1].set(1);
+    FlagField<8> rhs;
+    rhs.set(0);
+    FlagField<8, size_t, FlagCheck::Unchecked> sol;
+    assert(!e.solve(rhs, sol));
+}
+
+void run_all_tests() {
+    test_multiply();
+    test_rank_and_echelon();
+    test_inverse();
+    test_solve();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <atomic>
+#include <queue>
+#include <stdexcept>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldGraph.hpp>
+#include <FlagFieldRandom.hpp>
+
+/// @brief Plain adjacency list BFS, as a reference.
+std::vector<uint32_t> reference_bfs(const std::vector<std::vector<size_t>>& adj, size_t source) {
+    std::vector<uint32_t> depth(adj.size(), ~uint32_t(0));
+    std::queue<size_t> q;
+    depth[source] = 0;
+    q.push(source);
+    while (!q.empty()) {
+        size_t u = q.front();
+        q.pop();
+        for (size_t v : adj[u]) {
+            if (depth[v] == ~uint32_t(0)) { depth[v] = depth[u] + 1; q.push(v); }
+        }
+    }
+    return depth;
+}
+
+void test_small_graph() {
+    std::cout << "Testing a small undirected graph..." << std::endl;
+    FlagGraph<10> g;
+    g.addEdge(0, 1);
+    g.addEdge(1, 2);
+    g.addEdge(2, 3);
+    g.addEdge(5, 6);
+    g.addEdge(7, 7);
+    assert(g.hasEdge(1, 0));
+    assert(g.numEdges() == 5);
+
+    std::vector<uint32_t> depth;
+    auto visited = g.bfs(0, &depth);
+    assert(visited.numSetFlags() == 4);
+    assert(depth[3] == 3);
+    assert(depth[5] == FlagGraph<10>::unreached);
+    assert(g.reachable(3, 0));
+    assert(!g.reachable(0, 6));
+
+    std::vector<size_t> labels;
+    assert(g.connectedComponents(labels) == 6);
+    assert(labels[0] == labels[3]);
+    assert(labels[5] == labels[6]);
+    assert(labels[0] != labels[5]);
+}
+
+void test_directed_graph() {
+    std::cout << "Testing a directed graph..." << std::endl;
+    FlagGraph<100> g(70, true);
+    for (size_t i = 0; i + 1 < 70; i++) g.addEdge(i, i + 1);
+    assert(g.numEdges() == 69);
+    assert(g.reachable(0, 69));
+    assert(!g.reachable(69, 0));
+    std::vector<size_t> labels;
+    assert(g.connectedComponents(labels) == 1);
+}
+
+void test_random_graphs() {
+    std::cout << "Testing random graphs against an adjacency list BFS..." << std::endl;
+    FlagXoshiro rng(9);
+    FlagThreadPool pool(3);
+    for (size_t round = 0; round < 4; round++) {
+        const bool directed = round % 2;
+        const size_t n = 900 + round * 20;
+        FlagGraph<1000> g(n, directed);
+        if (round >= 2) g.setThreadPool(&pool, 1);
+        std::vector<std::vector<size_t>> adj(n);
+        for (size_t e = 0; e < n * 3; e++) {
+            const size_t u = randomBelow(rng, n), v = randomBelow(rng, n);
+            g.addEdge(u, v);
+            adj[u].push_back(v);
+            if (!directed) adj[v].push_back(u);
+        }
+        for (size_t s = 0; s < n; s += 97) {
+            std::vector<uint32_t> depth;
+            g.bfs(s, &depth);
+            assert(depth == reference_bfs(adj, s));
+        }
+    }
+}
+
+void test_thread_pool_edges() {
+    std::cout << "Testing thread pool exceptions and nested loops..." << std::endl;
+    FlagThreadPool pool(4);
+    for (size_t thrower = 0; thrower < 4; thrower++) {
+        std::atomic<size_t> done(0);
+        bool thrown = false;
+        try {
+            pool.parallelFor(400, [&](size_t begin, size_t end) {
+                if (begin == thrower * 100) throw std::runtime_error("chunk");
+                done += end - begin;
+            });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        // Every other chunk finished before the exception reached the caller
+        assert(thrown && done == 300);
+    }
+    std::atomic<size_t> total(0);
+    pool.parallelFor(4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            pool.parallelFor(100, [&](size_t b, size_t e) { total += e - b; });
+        }
+    });
+    assert(total == 400);
+    pool.parallelFor(10, [&](size_t b, size_t e) { total += e - b; });
+    assert(total == 410);
+}
+
+void run_all_tests() {
+    test_small_graph();
+    test_directed_graph();
+    test_random_graphs();
+    test_thread_pool_edges();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
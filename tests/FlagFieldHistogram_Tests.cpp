@@ -0,0 +1,150 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldHistogram.hpp>
+#include <FlagFieldRandom.hpp>
+
+enum Status {
+    Online, Degraded, Paused, Alerting, Muted, MAX_STATUS
+};
+
+template <size_t MAX, class E, class P>
+std::vector<uint64_t> naiveCounts(const std::vector<FlagField<MAX, E, P>>& rows,
+                                  const std::vector<uint64_t>* weights = nullptr) {
+    std::vector<uint64_t> c(MAX, 0);
+    for (size_t r = 0; r < rows.size(); r++) {
+        for (size_t i = 0; i < MAX; i++) {
+            if (rows[r].isSet(E(i))) c[i] += weights ? (*weights)[r] : 1;
+        }
+    }
+    return c;
+}
+
+template <size_t MAX>
+void check_size(const size_t& n, const uint64_t& seed) {
+    FlagXoshiro rng(seed);
+    std::vector<FlagField<MAX>> rows(n);
+    std::vector<uint64_t> weights(n);
+    for (size_t r = 0; r < n; r++) {
+        // Vary the density so every counter plane sees carries
+        fillRandom(rows[r], rng, (r % 7) / 6.0);
+        weights[r] = randomBelow(rng, 1000);
+    }
+    const auto expect = naiveCounts(rows);
+    const auto got = histogram(rows.data(), n);
+    for (size_t i = 0; i < MAX; i++) assert(got[i] == expect[i]);
+
+    const auto expectWeighted = naiveCounts(rows, &weights);
+    const auto gotWeighted = histogram(rows.data(), n, weights.data());
+    for (size_t i = 0; i < MAX; i++) assert(gotWeighted[i] == expectWeighted[i]);
+
+    FlagThreadPool pool(3);
+    const auto gotPool = histogram(rows.data(), n, &pool);
+    const auto gotPoolWeighted = histogram(rows.data(), n, weights.data(), &pool);
+    for (size_t i = 0; i < MAX; i++) {
+        assert(gotPool[i] == expect[i]);
+        assert(gotPoolWeighted[i] == expectWeighted[i]);
+    }
+}
+
+void test_counts() {
+    std::cout << "Testing counts against per flag isSet loops..." << std::endl;
+    for (size_t n : {0, 1, 15, 63, 64, 65, 1000, 5003}) {
+        check_size<8>(n, n + 1);
+        check_size<64>(n, n + 2);
+        check_size<100>(n, n + 3);
+        check_size<128>(n, n + 4);
+        check_size<192>(n, n + 5);
+        check_size<256>(n, n + 6);
+    }
+}
+
+void test_enum() {
+    std::cout << "Testing an enum FlagField and incremental adds..." << std::endl;
+    using Status_FF = FlagField<MAX_STATUS, Status>;
+    std::vector<Status_FF> rows(300);
+    for (size_t r = 0; r < rows.size(); r++) {
+        if (r % 2) rows[r].set(Online);
+        if (r % 3 == 0) rows[r].set(Alerting);
+        if (r < 10) rows[r].set(Muted);
+    }
+    FlagHistogram<MAX_STATUS> h;
+    h.add(rows.data(), 100);
+    h.add(rows.data() + 100, 200);
+    assert(h.counts()[Online] == 150);
+    assert(h.counts()[Degraded] == 0);
+    assert(h.counts()[Alerting] == 100);
+    assert(h.counts()[Muted] == 10);
+    FlagHistogram<MAX_STATUS> twice = h;
+    twice.merge(h);
+    assert(twice.counts()[Online] == 300);
+    h.clear();
+    assert(h.counts()[Online] == 0);
+}
+
+void test_counter_overflow() {
+    std::cout << "Testing counts past the counter plane capacity..." << std::endl;
+    // More than 65535 * 16 chunks, so the counter planes are flushed mid-run
+    const size_t n = 65535 * 16 * FlagHistogram<8>::rowsPerChunk + 1000;
+    std::vector<FlagField<8>> rows(n);
+    for (size_t r = 0; r < n; r++) {
+        rows[r].set(0);
+        if (r % 2) rows[r].set(7);
+    }
+    const auto got = histogram(rows.data(), n);
+    assert(got[0] == n);
+    assert(got[7] == n / 2);
+    assert(got[3] == 0);
+}
+
+void test_large_weights() {
+    std::cout << "Testing weights with high bits set..." << std::endl;
+    FlagXoshiro rng(7);
+    // Enough rows for full chunks, so the high bits reach the counter planes
+    std::vector<FlagField<128>> rows(5000);
+    std::vector<uint64_t> weights(rows.size());
+    for (size_t r = 0; r < rows.size(); r++) {
+        fillRandom(rows[r], rng, 0.5);
+        weights[r] = (r % 3 == 0 ? ~uint64_t(0) : uint64_t(1) << (40 + r % 24)) - r;
+    }
+    const auto expect = naiveCounts(rows, &weights);
+    const auto got = histogram(rows.data(), rows.size(), weights.data());
+    for (size_t i = 0; i < 128; i++) assert(got[i] == expect[i]);
+}
+
+void test_large_field() {
+    std::cout << "Testing a FlagField too large for stack scratch..." << std::endl;
+    constexpr size_t MAX = size_t(1) << 18;
+    std::vector<FlagField<MAX>> rows(40);
+    std::vector<uint64_t> weights(rows.size());
+    for (size_t r = 0; r < rows.size(); r++) {
+        for (size_t i = r; i < MAX; i += 997) rows[r].set(i);
+        weights[r] = r + 1;
+    }
+    auto h = std::make_unique<FlagHistogram<MAX>>();
+    h->add(rows.data(), rows.size(), weights.data());
+    const auto expect = naiveCounts(rows, &weights);
+    for (size_t i = 0; i < MAX; i++) assert(h->counts()[i] == expect[i]);
+}
+
+void run_all_tests() {
+    test_counts();
+    test_enum();
+    test_counter_overflow();
+    test_large_weights();
+    test_large_field();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
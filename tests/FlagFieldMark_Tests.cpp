@@ -0,0 +1,129 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldMark.hpp>
+#include <FlagFieldRandom.hpp>
+
+std::vector<std::pair<size_t, size_t>> model_runs(const std::vector<bool>& marks, const size_t& minGranules) {
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t i = 0; i < marks.size();) {
+        if (marks[i]) {
+            i++;
+            continue;
+        }
+        size_t end = i;
+        while (end < marks.size() && !marks[end]) end++;
+        if (end - i >= minGranules) runs.push_back({i, end - i});
+        i = end;
+    }
+    return runs;
+}
+
+void test_against_vector_bool() {
+    std::cout << "Testing FlagMarkBitmap against std::vector<bool>..." << std::endl;
+    FlagXoshiro rng(1);
+    alignas(16) static char heap[16 * 20000 + 48];
+    const size_t granules = 20000 + 3;
+    FlagMarkBitmap<16> marks(heap, sizeof(heap));
+    assert(marks.granules() == granules);
+    for (size_t epoch = 0; epoch < 4; epoch++) {
+        std::vector<bool> model(granules, false);
+        for (size_t k = 0; k < 3000; k++) {
+            const size_t i = randomBelow(rng, granules);
+            if (randomBelow(rng, 2)) {
+                assert(marks.tryMark(heap + 16 * i + randomBelow(rng, 16)) == !model[i]);
+                model[i] = true;
+            } else {
+                const size_t n = 1 + randomBelow(rng, 200);
+                const size_t bytes = n * 16 < sizeof(heap) - 16 * i ? n * 16 : sizeof(heap) - 16 * i;
+                marks.markRange(heap + 16 * i, bytes);
+                for (size_t j = i; j < i + (bytes + 15) / 16; j++) model[j] = true;
+            }
+        }
+        size_t count = 0;
+        for (size_t i = 0; i < granules; i++) {
+            assert(marks.isMarked(heap + 16 * i) == model[i]);
+            count += model[i];
+        }
+        assert(marks.marked() == count);
+        for (size_t k = 0; k < 200; k++) {
+            const size_t i = randomBelow(rng, granules + 5);
+            size_t m = i, f = i;
+            while (m < granules && !model[m]) m++;
+            while (f < granules && model[f]) f++;
+            assert(marks.nextMarked(i) == (m < granules ? m : granules));
+            assert(marks.nextFree(i) == (f < granules ? f : granules));
+        }
+        for (size_t minGranules : {1, 3, 70}) {
+            std::vector<std::pair<size_t, size_t>> runs;
+            marks.sweep([&](void* p, size_t bytes) {
+                runs.push_back({size_t(static_cast<char*>(p) - heap) / 16, bytes / 16});
+            }, minGranules * 16);
+            assert(runs == model_runs(model, minGranules));
+        }
+        FlagField<200> window;
+        marks.copyTo(77, window);
+        for (size_t i = 0; i < 200; i++) assert(window.isSet(i) == model[77 + i]);
+
+        // Alternate the eager and lazy clears
+        if (epoch % 2) marks.clear();
+        else marks.nextEpoch();
+        assert(marks.marked() == 0 && marks.nextMarked(0) == granules);
+    }
+}
+
+void test_parallel_marking() {
+    std::cout << "Testing marking from many threads..." << std::endl;
+    const size_t granules = 1 << 18;
+    std::vector<char> heap(16 * granules);
+    FlagMarkBitmap<16> marks(heap.data(), heap.size());
+    FlagXoshiro rng(2);
+    std::vector<const void*> pointers(100000);
+    std::vector<bool> model(granules, false);
+    size_t distinct = 0;
+    for (auto& p : pointers) {
+        const size_t i = randomBelow(rng, granules);
+        p = heap.data() + 16 * i;
+        distinct += !model[i];
+        model[i] = true;
+    }
+    FlagThreadPool pool(4);
+    for (size_t epoch = 0; epoch < 3; epoch++) {
+        // Every thread marks every pointer: each granule is won exactly once
+        std::atomic<size_t> won(0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 4; t++) {
+            threads.emplace_back([&] {
+                size_t mine = 0;
+                for (const void* p : pointers) mine += marks.tryMark(p);
+                won += mine;
+            });
+        }
+        for (auto& t : threads) t.join();
+        assert(won == distinct && marks.marked() == distinct);
+        assert(marks.markAll(pointers.data(), pointers.size(), &pool) == 0);
+        marks.nextEpoch();
+        assert(marks.markAll(pointers.data(), pointers.size(), &pool) == distinct);
+        marks.clear(&pool);
+    }
+}
+
+void run_all_tests() {
+    test_against_vector_bool();
+    test_parallel_marking();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
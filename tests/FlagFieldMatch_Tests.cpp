@@ -0,0 +1,92 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldMatch.hpp>
+#include <FlagFieldRandom.hpp>
+
+/// @brief Sellers' dynamic program: the fewest edits of the pattern ending at each text index.
+std::vector<size_t> reference_distances(const std::string& p, const std::string& t) {
+    std::vector<size_t> col(p.size() + 1), out;
+    for (size_t i = 0; i <= p.size(); i++) col[i] = i;
+    for (char c : t) {
+        size_t diag = col[0];
+        for (size_t i = 1; i <= p.size(); i++) {
+            const size_t up = col[i];
+            size_t best = diag + (p[i - 1] != c);
+            if (col[i - 1] + 1 < best) best = col[i - 1] + 1;
+            if (up + 1 < best) best = up + 1;
+            col[i] = best;
+            diag = up;
+        }
+        out.push_back(col[p.size()]);
+    }
+    return out;
+}
+
+std::string random_string(FlagXoshiro& rng, const size_t& n, const size_t& alphabet) {
+    std::string s(n, 'a');
+    for (char& c : s) c = char('a' + randomBelow(rng, alphabet));
+    return s;
+}
+
+void test_shift_or() {
+    std::cout << "Testing Shift-Or..." << std::endl;
+    FlagShiftOr<16> small("abcab");
+    std::vector<size_t> ends;
+    small.search("abcabcab", 8, [&](size_t e) { ends.push_back(e); });
+    assert((ends == std::vector<size_t>{4, 7}));
+
+    FlagXoshiro rng(41);
+    for (size_t len : {1, 63, 64, 65, 130, 300}) {
+        const std::string text = random_string(rng, 20000, 2);
+        const std::string pattern = text.substr(5000, len);
+        FlagShiftOr<512> m(pattern);
+        size_t expected = 0;
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            expected++;
+        }
+        assert(m.count(text.data(), text.size()) == expected);
+    }
+}
+
+void test_myers() {
+    std::cout << "Testing Myers..." << std::endl;
+    FlagMyers<64> small("survey");
+    assert(small.bestDistance("surgery", 7) == 2);
+    assert(small.count("a survey", 8, 0) == 1);
+
+    FlagXoshiro rng(42);
+    for (size_t len : {5, 64, 70, 128, 200}) {
+        const std::string text = random_string(rng, 3000, 4);
+        std::string pattern = text.substr(1000, len);
+        pattern[len / 2] = 'z';
+        const std::vector<size_t> d = reference_distances(pattern, text);
+        FlagMyers<256> m(pattern);
+        for (size_t k : {size_t(0), size_t(1), len / 4, len / 2}) {
+            std::vector<size_t> got(text.size(), ~size_t(0));
+            m.search(text.data(), text.size(), k, [&](size_t e, size_t edits) { got[e] = edits; });
+            for (size_t j = 0; j < text.size(); j++) {
+                assert(d[j] <= k ? got[j] == d[j] : got[j] == ~size_t(0));
+            }
+        }
+    }
+}
+
+void run_all_tests() {
+    test_shift_or();
+    test_myers();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
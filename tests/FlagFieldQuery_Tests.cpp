@@ -0,0 +1,105 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldQuery.hpp>
+#include <FlagFieldRandom.hpp>
+
+enum Flags {
+    A, B, C, D, E, F, G, H, MAX_FLAGS
+};
+
+void test_predicates() {
+    std::cout << "Testing predicate normalization..." << std::endl;
+    using P = FlagPredicate<MAX_FLAGS, Flags>;
+    const auto p = (P::flag(A) && P::flag(B)) || (P::flag(C) && !P::flag(D));
+    assert(p.terms().size() == 2);
+    assert((P::flag(A) && !P::flag(A)).terms().empty());
+    assert((P::flag(A) || (P::flag(A) && P::flag(B))).terms().size() == 1);
+    assert((P::flag(A) || !P::flag(A)).terms().size() == 2);
+
+    // Every assignment of the 8 flags against the expression
+    for (size_t x = 0; x < 256; x++) {
+        FlagField<MAX_FLAGS, Flags> ff;
+        for (size_t i = 0; i < MAX_FLAGS; i++) if ((x >> i) & 1) ff.set(Flags(i));
+        const bool a = x & 1, b = x & 2, c = x & 4, d = x & 8, e = x & 16;
+        assert(p(ff) == ((a && b) || (c && !d)));
+        assert((!p)(ff) == !((a && b) || (c && !d)));
+        assert((!(P::flag(A) || P::flag(E)) && P::flag(C))(ff) == (!(a || e) && c));
+        FlagField<MAX_FLAGS, Flags> ab(A, B);
+        assert(P::allOf(ab)(ff) == (a && b));
+        assert(P::anyOf(ab)(ff) == (a || b));
+        assert(P::noneOf(ab)(ff) == (!a && !b));
+    }
+}
+
+/// @brief A random predicate over the first `flags` flags.
+template <size_t MAX>
+FlagPredicate<MAX> random_predicate(FlagXoshiro& rng, const size_t& flags, const size_t& depth) {
+    using P = FlagPredicate<MAX>;
+    if (depth == 0) return P::flag(randomBelow(rng, flags));
+    const P a = random_predicate<MAX>(rng, flags, depth - 1), b = random_predicate<MAX>(rng, flags, depth - 1);
+    switch (randomBelow(rng, 3)) {
+        case 0: return a && b;
+        case 1: return a || b;
+        default: return !a || b;
+    }
+}
+
+template <size_t MAX>
+void check_scans(FlagXoshiro& rng, FlagThreadPool* pool) {
+    std::vector<FlagField<MAX>> rows(1000 + randomBelow(rng, 100));
+    for (auto& r : rows) fillRandom(r, rng, 0.5);
+    for (size_t round = 0; round < 20; round++) {
+        const auto p = random_predicate<MAX>(rng, MAX < 12 ? MAX : 12, 3);
+        FlagQuery<MAX> q(p);
+        q.setThreadPool(pool);
+        std::vector<size_t> indices, expected;
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (p(rows[i])) expected.push_back(i);
+            assert(q.matches(rows[i]) == p(rows[i]));
+        }
+        assert(q.select(rows.data(), rows.size(), indices) == expected.size());
+        assert(indices == expected);
+        assert(q.count(rows.data(), rows.size()) == expected.size());
+    }
+}
+
+void test_scans() {
+    std::cout << "Testing scans over arrays..." << std::endl;
+    FlagXoshiro rng(51);
+    FlagThreadPool pool(3);
+    for (FlagThreadPool* p : {static_cast<FlagThreadPool*>(nullptr), &pool}) {
+        check_scans<8>(rng, p);
+        check_scans<13>(rng, p);
+        check_scans<24>(rng, p);
+        check_scans<32>(rng, p);
+        check_scans<64>(rng, p);
+        check_scans<200>(rng, p);
+    }
+    // Flags past the first word
+    FlagQuery<200> q(FlagPredicate<200>::flag(150) && !FlagPredicate<200>::flag(3));
+    std::vector<FlagField<200>> rows(3);
+    rows[0].set(150);
+    rows[1].set(150);
+    rows[1].set(3);
+    std::vector<size_t> indices;
+    assert(q.select(rows.data(), rows.size(), indices) == 1 && indices[0] == 0);
+}
+
+void run_all_tests() {
+    test_predicates();
+    test_scans();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldRandom.hpp>
+
+void test_generators() {
+    std::cout << "Testing seeded generators..." << std::endl;
+    FlagXoshiro a(42), b(42), c(43);
+    FlagWyRand d(42), e(42);
+    for (size_t i = 0; i < 100; i++) {
+        const uint64_t x = a();
+        assert(x == b());
+        assert(x != c());
+        assert(d() == e());
+    }
+    for (size_t i = 0; i < 1000; i++) assert(randomBelow(a, 7) < 7);
+}
+
+void test_density() {
+    std::cout << "Testing fillRandom() densities..." << std::endl;
+    FlagXoshiro rng(1);
+    const double ps[] = { 0.5, 0.25, 0.1, 0.3, 0.9, 0.01 };
+    for (double p : ps) {
+        size_t count = 0;
+        FlagField<4096> ff;
+        for (size_t i = 0; i < 64; i++) {
+            fillRandom(ff, rng, p);
+            count += ff.numSetFlags();
+        }
+        const double density = double(count) / (64.0 * 4096.0);
+        std::cout << "\tp = " << p << " -> " << density << std::endl;
+        assert(density > p - 0.01 && density < p + 0.01);
+    }
+
+    FlagField<100> ff;
+    fillRandom(ff, rng, 0.0);
+    assert(ff.isNSet());
+    fillRandom(ff, rng, 1.0);
+    assert(ff.numSetFlags() == 100);
+}
+
+void test_reproducible() {
+    std::cout << "Testing reproducibility..." << std::endl;
+    FlagXoshiro r1(7), r2(7);
+    FlagField<1000> a = randomFlagField<1000>(r1, 0.37);
+    FlagField<1000> b = randomFlagField<1000>(r2, 0.37);
+    for (size_t w = 0; w < a.numWords(); w++) assert(a.word(w) == b.word(w));
+}
+
+void test_exact_count() {
+    std::cout << "Testing fillRandomCount()..." << std::endl;
+    FlagWyRand rng(3);
+    FlagField<1000> ff;
+    const size_t ks[] = { 0, 1, 10, 499, 500, 501, 999, 1000 };
+    for (size_t k : ks) {
+        fillRandomCount(ff, rng, k);
+        assert(ff.numSetFlags() == k);
+    }
+    // Every flag gets picked eventually
+    FlagField<64> seen;
+    FlagField<64> x;
+    for (size_t i = 0; i < 200; i++) {
+        fillRandomCount(x, rng, 3);
+        seen |= x;
+    }
+    assert(seen.isSet());
+}
+
+void run_all_tests() {
+    test_generators();
+    test_density();
+    test_reproducible();
+    test_exact_count();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <thread>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldScheduler.hpp>
+#include <FlagFieldRandom.hpp>
+
+struct Task : FlagRunNode {
+    size_t id = 0;
+    std::atomic<int> runs{0};
+};
+
+template <size_t LEVELS>
+void check_against_map(const uint64_t& seed) {
+    FlagXoshiro rng(seed);
+    FlagPriorityScheduler<LEVELS> queue;
+    std::map<size_t, std::deque<Task*>> model;
+    std::vector<Task> tasks(3000);
+    for (size_t i = 0; i < tasks.size(); i++) tasks[i].id = i;
+    size_t next = 0, queued = 0;
+    while (next < tasks.size() || queued) {
+        if (next < tasks.size() && (randomBelow(rng, 3) != 0 || !queued)) {
+            const size_t p = randomBelow(rng, 4) == 0 ? LEVELS - 1 : randomBelow(rng, LEVELS);
+            queue.push(&tasks[next], p);
+            model[p].push_back(&tasks[next++]);
+            queued++;
+        } else {
+            const auto top = std::prev(model.end());
+            assert(queue.highest() == top->first && queue.ready().isSet(top->first));
+            size_t p = 0;
+            assert(queue.pop(&p) == top->second.front() && p == top->first);
+            top->second.pop_front();
+            if (top->second.empty()) model.erase(top);
+            queued--;
+        }
+        assert(queue.size() == queued && queue.empty() == !queued);
+    }
+    assert(queue.pop() == nullptr && queue.highest() == queue.none);
+}
+
+void test_priority_scheduler() {
+    std::cout << "Testing FlagPriorityScheduler against a map of FIFOs..." << std::endl;
+    check_against_map<1>(1);
+    check_against_map<64>(2);
+    check_against_map<256>(3);
+    check_against_map<1000>(4);
+    check_against_map<4096>(5);
+}
+
+void test_stealing() {
+    std::cout << "Testing FlagCoreScheduler stealing..." << std::endl;
+    FlagCoreScheduler<256> scheduler(4);
+    std::vector<Task> tasks(4);
+    scheduler.push(1, &tasks[0], 10);
+    scheduler.push(2, &tasks[1], 200);
+    scheduler.push(2, &tasks[2], 5);
+    scheduler.push(0, &tasks[3], 1);
+    assert(scheduler.highest(2) == 200 && scheduler.highest(3) == scheduler.none);
+    size_t p = 0;
+    // Core 0 runs its own task first, then steals from the core with the highest priority
+    assert(scheduler.pop(0, &p) == &tasks[3] && p == 1);
+    assert(scheduler.pop(0, &p) == &tasks[1] && p == 200);
+    assert(scheduler.pop(3, &p) == &tasks[0] && p == 10);
+    assert(scheduler.popLocal(3) == nullptr);
+    assert(scheduler.steal(2) == nullptr);
+    assert(scheduler.pop(2, &p) == &tasks[2] && p == 5);
+    assert(scheduler.pop(1) == nullptr);
+}
+
+void test_concurrent() {
+    std::cout << "Testing FlagCoreScheduler across threads..." << std::endl;
+    const size_t cores = 4, perCore = 5000;
+    FlagCoreScheduler<256> scheduler(cores);
+    std::vector<Task> tasks(cores * perCore);
+    std::atomic<size_t> done(0);
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < cores; c++) {
+        threads.emplace_back([&, c] {
+            FlagXoshiro rng(c + 1);
+            // Uneven load: core 0 gets most of the work pushed to it
+            for (size_t i = 0; i < perCore; i++) {
+                const size_t target = randomBelow(rng, 4) == 0 ? c : 0;
+                scheduler.push(target, &tasks[c * perCore + i], randomBelow(rng, 256));
+                if (FlagRunNode* node = scheduler.pop(c)) {
+                    static_cast<Task*>(node)->runs++;
+                    done++;
+                }
+            }
+            while (done < tasks.size()) {
+                if (FlagRunNode* node = scheduler.pop(c)) {
+                    static_cast<Task*>(node)->runs++;
+                    done++;
+                } else std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (const auto& t : tasks) assert(t.runs == 1);
+    for (size_t c = 0; c < cores; c++) assert(scheduler.highest(c) == scheduler.none);
+}
+
+void run_all_tests() {
+    test_priority_scheduler();
+    test_stealing();
+    test_concurrent();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldSequence.hpp>
+#include <FlagFieldRandom.hpp>
+
+/// @brief The std::set window FlagSequenceWindow replaces.
+struct SetWindow {
+    uint64_t window, floor, top;
+    std::set<uint64_t> seen;
+
+    uint64_t base() const { return top - floor > window ? top - window : floor; }
+
+    FlagSequence check(const uint64_t& seq) {
+        if (seq >= top) top = seq + 1;
+        else if (seq < base()) return FlagSequence::TooOld;
+        while (!seen.empty() && *seen.begin() < base()) seen.erase(seen.begin());
+        return seen.insert(seq).second ? FlagSequence::Accepted : FlagSequence::Duplicate;
+    }
+
+    std::vector<FlagSequenceRange> runs(const bool& missing) const {
+        std::vector<FlagSequenceRange> out;
+        for (uint64_t s = base(); s < top; s++) {
+            if ((seen.count(s) == 0) != missing) continue;
+            if (!out.empty() && out.back().end == s) out.back().end++;
+            else out.push_back({s, s + 1});
+        }
+        return out;
+    }
+};
+
+bool same_ranges(const std::vector<FlagSequenceRange>& a, const std::vector<FlagSequenceRange>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].begin != b[i].begin || a[i].end != b[i].end) return false;
+    }
+    return true;
+}
+
+template <size_t WINDOW>
+void check_against_set(const uint64_t& first, const uint64_t& seed) {
+    FlagXoshiro rng(seed);
+    FlagSequenceWindow<WINDOW> window(first);
+    SetWindow model{WINDOW, first, first, {}};
+    uint64_t next = first;
+    for (size_t i = 0; i < 20000; i++) {
+        // Mostly in order with reordering and replays, and the odd jump
+        const uint64_t r = randomBelow(rng, 1000);
+        uint64_t seq;
+        if (r < 5) seq = next += randomBelow(rng, 3 * WINDOW);
+        else if (r < 100) seq = next - randomBelow(rng, 2 * WINDOW);
+        else seq = next++ + randomBelow(rng, 16);
+        if (seq < first && randomBelow(rng, 2)) seq = first + randomBelow(rng, 8);
+        assert(window.check(seq) == model.check(seq));
+        assert(window.top() == model.top && window.base() == model.base());
+        const uint64_t probe = model.top - randomBelow(rng, WINDOW + 8);
+        assert(window.contains(probe) == (probe >= model.base() && model.seen.count(probe) > 0));
+        if (i % 997 == 0) {
+            assert(same_ranges(window.received(), model.runs(false)));
+            assert(same_ranges(window.missing(), model.runs(true)));
+        }
+    }
+}
+
+void test_against_set() {
+    std::cout << "Testing FlagSequenceWindow against a std::set window..." << std::endl;
+    check_against_set<64>(0, 1);
+    check_against_set<192>(1000, 2);
+    check_against_set<4096>(0, 3);
+    check_against_set<4096>(12345, 4);
+}
+
+void test_ranges() {
+    std::cout << "Testing SACK range export..." << std::endl;
+    FlagSequenceWindow<128> window(10);
+    assert(window.received().empty() && window.missing().empty());
+    for (uint64_t s : {10, 11, 12, 20, 21, 75, 130}) assert(window.check(s) == FlagSequence::Accepted);
+    assert(window.check(11) == FlagSequence::Duplicate);
+    assert(window.check(9) == FlagSequence::TooOld);
+    assert(same_ranges(window.received(), {{10, 13}, {20, 22}, {75, 76}, {130, 131}}));
+    assert(same_ranges(window.missing(), {{13, 20}, {22, 75}, {76, 130}}));
+    // Jumping past the window forgets everything below it
+    assert(window.check(1000) == FlagSequence::Accepted);
+    assert(window.base() == 1001 - 128);
+    assert(window.check(130) == FlagSequence::TooOld);
+    assert(same_ranges(window.received(), {{1000, 1001}}));
+    assert(same_ranges(window.missing(), {{1001 - 128, 1000}}));
+}
+
+void test_atomic() {
+    std::cout << "Testing FlagAtomicSequenceWindow..." << std::endl;
+    FlagAtomicSequenceWindow<256> window(100);
+    assert(window.check(99) == FlagSequence::TooOld);
+    assert(window.check(100) == FlagSequence::Accepted);
+    assert(window.check(100) == FlagSequence::Duplicate);
+    assert(window.check(140) == FlagSequence::Accepted);
+    assert(window.contains(140) && !window.contains(139) && window.top() == 141);
+    assert(window.check(1000) == FlagSequence::Accepted);
+    assert(window.check(140) == FlagSequence::TooOld && !window.contains(140));
+    // The last WINDOW - 32 sequence numbers are always remembered
+    for (uint64_t s = 1000 - (256 - 32); s < 1000; s += 7) assert(window.check(s) == FlagSequence::Accepted);
+    for (uint64_t s = 1000 - (256 - 32); s < 1000; s += 7) assert(window.check(s) == FlagSequence::Duplicate);
+    const std::vector<FlagSequenceRange> sack = window.snapshot().received();
+    assert(sack.back().begin == 1000 && sack.back().end == 1001);
+    assert(sack.front().begin == 1000 - (256 - 32));
+
+    // Producers racing over the same sequence numbers accept each one exactly once
+    FlagAtomicSequenceWindow<4096> shared;
+    const size_t n = 4000, threads = 4;
+    std::atomic<size_t> accepted(0);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            FlagXoshiro rng(t + 7);
+            std::vector<uint64_t> seqs(n);
+            for (size_t i = 0; i < n; i++) seqs[i] = i;
+            for (size_t i = n - 1; i > 0; i--) std::swap(seqs[i], seqs[randomBelow(rng, i + 1)]);
+            size_t mine = 0;
+            for (uint64_t s : seqs) mine += shared.check(s) == FlagSequence::Accepted;
+            accepted += mine;
+        });
+    }
+    for (auto& th : pool) th.join();
+    assert(accepted == n && shared.top() == n);
+    const std::vector<FlagSequenceRange> all = shared.snapshot().received();
+    assert(all.size() == 1 && all[0].begin == 0 && all[0].end == n);
+}
+
+void run_all_tests() {
+    test_against_set();
+    test_ranges();
+    test_atomic();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldSignal.hpp>
+#include <FlagFieldRandom.hpp>
+
+void test_tight_loop() {
+    std::cout << "Testing signals raised in a tight loop..." << std::endl;
+    FlagSignals signals;
+    const int sigs[] = {SIGUSR1, SIGUSR2, SIGHUP};
+    size_t handled[3] = {};
+    std::vector<int> order;
+    for (size_t i = 0; i < 3; i++) {
+        signals.watch(sigs[i], [&, i](int sig) {
+            assert(sig == sigs[i]);
+            handled[i]++;
+            order.push_back(sig);
+        });
+    }
+    assert(signals.watched().numSetFlags() == 3);
+
+    FlagXoshiro rng(1);
+    size_t raised[3] = {}, dispatched = 0;
+    for (size_t i = 0; i < 100000; i++) {
+        // raise() runs the handler before returning, so the flag is set by now
+        const size_t k = randomBelow(rng, 3);
+        raise(sigs[k]);
+        raised[k]++;
+        assert(signals.pending().isSet(size_t(sigs[k])));
+        if (randomBelow(rng, 8) == 0) {
+            order.clear();
+            dispatched += signals.dispatch();
+            for (size_t j = 1; j < order.size(); j++) assert(order[j - 1] < order[j]);
+            assert(signals.pending().numSetFlags() == 0);
+        }
+    }
+    dispatched += signals.dispatch();
+    // Repeats of a signal before a dispatch coalesce, but every signal raised is handled
+    for (size_t k = 0; k < 3; k++) assert(handled[k] > 0 && handled[k] <= raised[k]);
+    assert(dispatched == handled[0] + handled[1] + handled[2]);
+    assert(signals.dispatch() == 0);
+}
+
+void test_wakeup() {
+    std::cout << "Testing wake-ups from another thread..." << std::endl;
+    FlagSignals signals;
+    size_t handled = 0;
+    signals.watch(SIGUSR1, [&](int) { handled++; });
+    assert(signals.fd() >= 0);
+    assert(!signals.wait(0));
+    for (size_t round = 0; round < 200; round++) {
+        std::thread sender([] { kill(getpid(), SIGUSR1); });
+        while (!signals.wait(1000)) {}
+        assert(signals.dispatch() == 1);
+        sender.join();
+    }
+    assert(handled == 200);
+    signals.unwatch(SIGUSR1);
+    assert(signals.watched().numSetFlags() == 0);
+}
+
+void run_all_tests() {
+    test_tight_loop();
+    test_wakeup();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldTimer.hpp>
+#include <FlagFieldRandom.hpp>
+
+template <size_t LEVELS, size_t SLOTS>
+void check_against_map(const uint64_t& start, const uint64_t& maxDelay, const uint64_t& seed) {
+    FlagXoshiro rng(seed);
+    FlagTimerWheel<LEVELS, SLOTS> wheel(start);
+    // handle -> effective expiry (a past expiry is due at the time it was scheduled)
+    std::map<uint64_t, uint64_t> pending;
+    std::vector<uint64_t> handles;
+    for (size_t round = 0; round < 300; round++) {
+        for (size_t i = randomBelow(rng, 40); i > 0; i--) {
+            const uint64_t now = wheel.now();
+            const uint64_t when = randomBelow(rng, 10) == 0 ? now - randomBelow(rng, now + 1) : now + randomBelow(rng, maxDelay);
+            const uint64_t h = wheel.schedule(when, when);
+            pending[h] = when < now ? now : when;
+            handles.push_back(h);
+        }
+        for (size_t i = randomBelow(rng, 8); i > 0 && !handles.empty(); i--) {
+            const uint64_t h = handles[randomBelow(rng, handles.size())];
+            assert(wheel.cancel(h) == (pending.erase(h) == 1));
+        }
+        assert(wheel.size() == pending.size());
+        uint64_t earliest = FlagTimerWheel<LEVELS, SLOTS>::none;
+        for (const auto& p : pending) earliest = p.second < earliest ? p.second : earliest;
+        assert(wheel.nextExpiry() <= earliest);
+
+        const uint64_t target = wheel.now() + randomBelow(rng, randomBelow(rng, 4) == 0 ? 4 * maxDelay : 300);
+        uint64_t last = 0;
+        wheel.advance(target, [&](uint64_t h, uint64_t) {
+            const auto it = pending.find(h);
+            assert(it != pending.end());
+            assert(wheel.now() == it->second && it->second >= last);
+            last = it->second;
+            pending.erase(it);
+        });
+        assert(wheel.now() == target);
+        for (const auto& p : pending) assert(p.second > target);
+    }
+}
+
+void test_against_map() {
+    std::cout << "Testing FlagTimerWheel against an expiry map..." << std::endl;
+    check_against_map<4, 256>(0, 100000, 1);
+    check_against_map<2, 64>(123, 3000, 2);
+    // Past the wheel's 4096 tick range
+    check_against_map<2, 64>(4000, 50000, 3);
+    check_against_map<1, 128>(0, 1000, 4);
+    check_against_map<11, 64>(~uint64_t(0) >> 2, 1000000, 5);
+}
+
+void test_callbacks() {
+    std::cout << "Testing scheduling and cancelling from callbacks..." << std::endl;
+    FlagTimerWheel<> wheel;
+    std::vector<uint64_t> fired;
+    const uint64_t a = wheel.schedule(10, 1);
+    const uint64_t b = wheel.schedule(10, 2);
+    wheel.schedule(5, 3);
+    wheel.advance(20, [&](uint64_t, uint64_t data) {
+        fired.push_back(data);
+        if (data == 3) wheel.schedule(15, 4);                   // later in this advance
+        if (data == 3) wheel.schedule(1000, 5);                 // after it
+        if (data == 1 || data == 2) wheel.cancel(data == 1 ? b : a);  // the other one of the pair
+    });
+    assert(fired.size() == 3 && fired[0] == 3 && (fired[1] == 1 || fired[1] == 2) && fired[2] == 4);
+    assert(!wheel.cancel(a) && !wheel.cancel(b));
+    assert(wheel.size() == 1 && wheel.nextExpiry() <= 1000);
+    wheel.advance(999, [&](uint64_t, uint64_t) { assert(false); });
+    assert(wheel.nextExpiry() == 1000);
+    wheel.advance(1000, [&](uint64_t, uint64_t data) { fired.push_back(data); });
+    assert(fired.back() == 5 && wheel.size() == 0);
+    assert(wheel.nextExpiry() == FlagTimerWheel<>::none);
+}
+
+void run_all_tests() {
+    test_against_map();
+    test_callbacks();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
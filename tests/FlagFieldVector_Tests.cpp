@@ -0,0 +1,107 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldVector.hpp>
+
+typedef enum StdFlags {
+    INITALIZED,
+    ERROR,
+    CLOSED,
+    SHOULD_CLOSE,
+    MINIMIZED,
+    FULLSCREEN,
+    MAX_FLAG
+} StdFlags;
+
+void test_trivially_copyable() {
+    std::cout << "Testing FlagField type traits..." << std::endl;
+    static_assert(std::is_trivially_copyable<FlagField<>>::value, "");
+    static_assert(std::is_trivially_copyable<FlagField<1020>>::value, "");
+    static_assert(std::is_trivially_destructible<FlagField<MAX_FLAG, StdFlags>>::value, "");
+    static_assert(sizeof(FlagField<100>) == 13, "");
+    FlagField<MAX_FLAG, StdFlags> a(ERROR, MINIMIZED), b;
+    std::memcpy(&b, &a, sizeof(a));
+    assert(b.isSet(ERROR, MINIMIZED));
+    assert(b.numSetFlags() == 2);
+}
+
+void test_vector_growth() {
+    std::cout << "Testing FlagFieldVector growth..." << std::endl;
+    FlagFieldVector<MAX_FLAG, StdFlags> v;
+    assert(v.empty());
+    for (size_t i = 0; i < 1000; i++) {
+        FlagField<MAX_FLAG, StdFlags> ff;
+        ff.set(StdFlags(i % MAX_FLAG));
+        v.push_back(ff);
+    }
+    assert(v.size() == 1000);
+    assert(v.capacity() >= 1000);
+    for (size_t i = 0; i < v.size(); i++) {
+        assert(v[i].isSet(StdFlags(i % MAX_FLAG)));
+        assert(v[i].numSetFlags() == 1);
+    }
+    // Push an element of the vector itself across a reallocation
+    while (v.size() < v.capacity()) v.push_back(v[0]);
+    v.push_back(v[1]);
+    assert(v.back().isSet(ERROR));
+
+    v.pop_back();
+    v.resize(10);
+    assert(v.size() == 10);
+    v.resize(5000);
+    assert(v[4999].isNSet());
+    assert(v[9].isSet(SHOULD_CLOSE));
+}
+
+void test_vector_copy() {
+    std::cout << "Testing FlagFieldVector copies..." << std::endl;
+    FlagFieldVector<300> v(100);
+    for (size_t i = 0; i < v.size(); i++) v[i].set(i, 299 - i);
+    FlagFieldVector<300> c(v);
+    assert(c.size() == 100);
+    for (size_t i = 0; i < c.size(); i++) assert(c[i].isSet(i, 299 - i));
+
+    FlagFieldVector<300> d;
+    d = c;
+    c.clearAll();
+    assert(c[50].isNSet());
+    assert(d[50].isSet(50, 249));
+
+    FlagFieldVector<300> m(std::move(d));
+    assert(m.size() == 100);
+    assert(d.size() == 0);
+    m.append(v.data(), 10);
+    assert(m.size() == 110);
+    assert(m[105].isSet(5, 294));
+
+    size_t count = 0;
+    for (const auto& ff : m) count += ff.numSetFlags();
+    assert(count == 220);
+
+    // Append a range of the vector itself across a reallocation
+    FlagFieldVector<300> self;
+    self.reserve(100);
+    self.append(v.data(), 100);
+    assert(self.capacity() == 100);
+    self.append(self.data() + 20, 80);
+    assert(self.size() == 180);
+    for (size_t i = 0; i < 80; i++) assert(self[100 + i].isSet(20 + i, 279 - i));
+}
+
+void run_all_tests() {
+    test_trivially_copyable();
+    test_vector_growth();
+    test_vector_copy();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagFieldVote.hpp>
+#include <FlagFieldRandom.hpp>
+
+enum Health {
+    Reachable, Synced, Leader, Draining, MAX_HEALTH
+};
+
+template <size_t MAX>
+void check_votes(const size_t& n, const uint64_t& seed) {
+    FlagXoshiro rng(seed);
+    std::vector<FlagField<MAX>> rows(n);
+    for (size_t r = 0; r < n; r++) fillRandom(rows[r], rng, 0.5);
+    std::vector<uint64_t> counts(MAX, 0);
+    for (const auto& r : rows) {
+        for (size_t i = 0; i < MAX; i++) counts[i] += r.isSet(i);
+    }
+    FlagThreadPool pool(3);
+    const FlagVoteCounter<MAX> votes = FlagVoteCounter<MAX>::of(rows.data(), n, &pool);
+    assert(votes.rows() == n);
+    for (size_t i = 0; i < MAX; i++) assert(votes.count(i) == counts[i]);
+    for (uint64_t k : {uint64_t(0), uint64_t(1), uint64_t(n / 3), uint64_t(n / 2), uint64_t(n / 2 + 1),
+                       uint64_t(n), uint64_t(n + 1), uint64_t(1) << 40}) {
+        const FlagField<MAX> least = atLeastK(rows.data(), n, k);
+        const FlagField<MAX> exact = exactlyK(rows.data(), n, k, &pool);
+        for (size_t i = 0; i < MAX; i++) {
+            assert(least.isSet(i) == (counts[i] >= k));
+            assert(exact.isSet(i) == (counts[i] == k));
+        }
+    }
+    const FlagField<MAX> maj = majority(rows.data(), n);
+    for (size_t i = 0; i < MAX; i++) assert(maj.isSet(i) == (2 * counts[i] > n));
+}
+
+void test_random_votes() {
+    std::cout << "Testing votes against per flag counts..." << std::endl;
+    for (size_t n : {0, 1, 3, 16, 31, 64, 65, 1001, 4099}) {
+        check_votes<7>(n, n + 1);
+        check_votes<64>(n, n + 2);
+        check_votes<100>(n, n + 3);
+        check_votes<128>(n, n + 4);
+        check_votes<192>(n, n + 5);
+    }
+}
+
+void test_replicas() {
+    std::cout << "Testing replica health votes..." << std::endl;
+    using HealthFF = FlagField<MAX_HEALTH, Health>;
+    std::vector<HealthFF> replicas = {
+        HealthFF(Reachable, Synced), HealthFF(Reachable, Leader), HealthFF(Reachable, Synced, Draining)
+    };
+    const HealthFF maj = majority(replicas.data(), replicas.size());
+    assert(maj.isSet(Reachable) && maj.isSet(Synced) && !maj.isSet(Leader) && !maj.isSet(Draining));
+    const HealthFF one = exactlyK(replicas.data(), replicas.size(), 1);
+    assert(!one.isSet(Reachable) && !one.isSet(Synced) && one.isSet(Leader) && one.isSet(Draining));
+    const HealthFF all = atLeastK(replicas.data(), replicas.size(), 3);
+    assert(all.isSet(Reachable) && !all.isSet(Synced));
+
+    // Incremental counting and merging
+    FlagVoteCounter<MAX_HEALTH> a, b;
+    a.add(replicas.data(), 2);
+    b.add(replicas.data() + 2, 1);
+    a.merge(b);
+    HealthFF out;
+    a.exactly(2, out);
+    assert(out.isSet(Synced) && !out.isSet(Reachable));
+    a.clear();
+    assert(a.rows() == 0);
+    a.atLeast(1, out);
+    assert(!out.isSet(Reachable));
+}
+
+void test_large_field() {
+    std::cout << "Testing a FlagField too large for stack scratch..." << std::endl;
+    constexpr size_t MAX = size_t(1) << 18;
+    std::vector<FlagField<MAX>> rows(33);
+    for (size_t r = 0; r < rows.size(); r++) {
+        for (size_t i = r; i < MAX; i += 1 + r % 5) rows[r].set(i);
+    }
+    std::vector<uint64_t> counts(MAX, 0);
+    for (const auto& r : rows) {
+        for (size_t i = 0; i < MAX; i++) counts[i] += r.isSet(i);
+    }
+    FlagThreadPool pool(2);
+    const auto maj = std::make_unique<FlagField<MAX>>(majority(rows.data(), rows.size(), &pool));
+    const auto ten = std::make_unique<FlagField<MAX>>(exactlyK(rows.data(), rows.size(), 10));
+    for (size_t i = 0; i < MAX; i++) {
+        assert(maj->isSet(i) == (2 * counts[i] > rows.size()));
+        assert(ten->isSet(i) == (counts[i] == 10));
+    }
+}
+
+void run_all_tests() {
+    test_random_votes();
+    test_replicas();
+    test_large_field();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}
@@ -0,0 +1,1310 @@
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagField.hpp>
+#include <FlagRemap.hpp>
+#include <FlagFieldVector.hpp>
+#include <FlagFieldRandom.hpp>
+#include <FlagFieldDataflow.hpp>
+#include <FlagFieldGraph.hpp>
+#include <FlagFieldClosure.hpp>
+#include <FlagFieldGF2.hpp>
+#include <FlagFieldMatch.hpp>
+#include <FlagFieldQuery.hpp>
+#include <FlagFieldECS.hpp>
+#include <FlagFieldHistogram.hpp>
+#include <FlagFieldCooccurrence.hpp>
+#include <FlagFieldEclat.hpp>
+#include <FlagFieldVote.hpp>
+#include <FlagFieldSequence.hpp>
+#include <FlagFieldTimer.hpp>
+#include <FlagFieldScheduler.hpp>
+#include <FlagFieldExecutor.hpp>
+#include <FlagFieldDoorbell.hpp>
+#include <FlagFieldMark.hpp>
+#include <FlagFieldDirty.hpp>
+#include <FlagFieldCoverage.hpp>
+
+#include <random>
+
+/// @brief Keeps the optimizer from removing benchmarked work.
+static volatile uint64_t sink;
+
+/// @brief Runs `fn` `iters` times and returns the elapsed time in seconds.
+template <class Fn>
+double timeIt(size_t iters, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; i++) fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// @brief Prints a benchmark result as a rate.
+void report(const char* name, double count, double seconds, const char* unit) {
+    std::cout << "\t" << name << ": " << count / seconds / 1e6 << " M" << unit << "/s ("
+        << seconds * 1e3 << " ms)" << std::endl;
+}
+
+void bench_slicing() {
+    std::cout << "Benchmarking unaligned 1 Kbit slices..." << std::endl;
+    const size_t iters = 200000;
+    FlagField<4096> src;
+    for (size_t i = 0; i < src.size(); i += 3) src.set(i);
+
+    double word = timeIt(iters, [&](size_t i) {
+        FlagField<1024> s = src.slice<13, 1024>();
+        sink = sink + s.word(i % 16);
+    });
+    report("slice<13, 1024>()", iters, word, "slices");
+
+    double loop = timeIt(iters, [&](size_t i) {
+        FlagField<1024> s;
+        for (size_t f = 0; f < 1024; f++) {
+            if (src.isSet(13 + f)) s.set(f);
+        }
+        sink = sink + s.word(i % 16);
+    });
+    report("per-flag loop", iters, loop, "slices");
+}
+
+void bench_remap() {
+    std::cout << "Benchmarking 10M record migration (128 -> 140 flags)..." << std::endl;
+    const size_t n = 10000000;
+    // Two flags removed, twelve inserted and one block of eight reordered
+    std::vector<std::pair<size_t, size_t>> table;
+    for (size_t i = 0; i < 128; i++) {
+        if (i == 20 || i == 90) continue;
+        size_t to = i < 40 ? i : i + 12;
+        if (i >= 100 && i < 108) to = 100 + 12 + (107 - i);
+        table.emplace_back(i, to);
+    }
+    FlagRemap<128, size_t, 140, size_t> remap(table.data(), table.size());
+    std::cout << "\tsteps per record: " << remap.numSteps() << std::endl;
+
+    const size_t inBytes = FlagField<128>().sizeBytes(), outBytes = FlagField<140>().sizeBytes();
+    std::vector<uint8_t> in(n * inBytes), out(n * outBytes);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (auto& b : in) { x ^= x << 13; x ^= x >> 7; x ^= x << 17; b = uint8_t(x); }
+
+    double t = timeIt(1, [&](size_t) { remap.applyBytes(in.data(), out.data(), n); });
+    report("FlagRemap::applyBytes()", n, t, "records");
+
+    const size_t m = n / 10;
+    std::vector<FlagField<128>> olds(m);
+    std::vector<FlagField<140>> news(m);
+    for (size_t i = 0; i < m; i++) std::memcpy(*olds[i], &in[i * inBytes], inBytes);
+    double loop = timeIt(1, [&](size_t) {
+        for (size_t i = 0; i < m; i++) {
+            news[i].clear();
+            for (const auto& p : table) {
+                if (olds[i].isSet(p.first)) news[i].set(p.second);
+            }
+        }
+    });
+    report("per-flag isSet/set loop", m, loop, "records");
+    sink = sink + out[n / 2] + news[m / 2].word(0);
+}
+
+template <class P>
+void bench_policy_(const char* name, const std::vector<size_t>& idxs) {
+    FlagField<1024, size_t, P> ff;
+    const size_t rounds = 2000;
+    double t = timeIt(rounds, [&](size_t) {
+        for (size_t i : idxs) ff.toggle(i);
+        for (size_t i : idxs) sink = sink + ff.isSet(i);
+    });
+    report(name, double(rounds) * idxs.size() * 2, t, "accesses");
+}
+
+void bench_policies() {
+    std::cout << "Benchmarking per-access cost of validation policies..." << std::endl;
+    std::vector<size_t> idxs(4096);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (auto& i : idxs) { x ^= x << 13; x ^= x >> 7; x ^= x << 17; i = x % 1024; }
+    bench_policy_<FlagCheck::Unchecked>("FlagCheck::Unchecked", idxs);
+    bench_policy_<FlagCheck::Ignore>("FlagCheck::Ignore", idxs);
+    bench_policy_<FlagCheck::Assert>("FlagCheck::Assert", idxs);
+    bench_policy_<FlagCheck::Throw>("FlagCheck::Throw", idxs);
+}
+
+/// @brief A FlagField with the old user-declared copy (clear, then set from other).
+struct LegacyField {
+    FlagField<128> ff;
+    LegacyField() {}
+    LegacyField(const LegacyField& other) { ff.clear(); ff.set(other.ff); }
+    LegacyField& operator=(const LegacyField& other) { ff.clear(); ff.set(other.ff); return *this; }
+    ~LegacyField() {}
+};
+
+template <class V, class T>
+void bench_vector_(const char* name, const size_t& n) {
+    V v;
+    T x;
+    double grow = timeIt(1, [&](size_t) {
+        for (size_t i = 0; i < n; i++) v.push_back(x);
+    });
+    double copy = timeIt(1, [&](size_t) {
+        V c(v);
+        sink = sink + c.size();
+    });
+    std::cout << "\t" << name << ":" << std::endl;
+    report("  push_back growth", n, grow, "fields");
+    report("  copy", n, copy, "fields");
+}
+
+void bench_vector() {
+    std::cout << "Benchmarking 10M x FlagField<128> vector growth and copy..." << std::endl;
+    const size_t n = 10000000;
+    bench_vector_<std::vector<LegacyField>, LegacyField>("std::vector (user-declared copy)", n);
+    bench_vector_<std::vector<FlagField<128>>, FlagField<128>>("std::vector (trivial copy)", n);
+    bench_vector_<FlagFieldVector<128>, FlagField<128>>("FlagFieldVector", n);
+    FlagFieldVector<128> v(n);
+    double zero = timeIt(1, [&](size_t) { v.clearAll(); });
+    report("FlagFieldVector::clearAll()", n, zero, "fields");
+    sink = sink + v[n / 2].word(0);
+}
+
+void bench_random() {
+    std::cout << "Benchmarking random FlagField<4096> generation..." << std::endl;
+    const size_t iters = 20000;
+    FlagField<4096> ff;
+    FlagXoshiro xo(1);
+    FlagWyRand wy(1);
+    const double ps[] = { 0.5, 0.1, 0.3 };
+    for (double p : ps) {
+        std::string name = "fillRandom(xoshiro, p = " + std::to_string(p).substr(0, 3) + ")";
+        double t = timeIt(iters, [&](size_t) { fillRandom(ff, xo, p); sink = sink + ff.word(0); });
+        report(name.c_str(), double(iters) * 4096, t, "bits");
+        name = "fillRandom(wyrand, p = " + std::to_string(p).substr(0, 3) + ")";
+        t = timeIt(iters, [&](size_t) { fillRandom(ff, wy, p); sink = sink + ff.word(0); });
+        report(name.c_str(), double(iters) * 4096, t, "bits");
+    }
+    double t = timeIt(iters, [&](size_t) { fillRandom(ff, xo, 0.3, 8); sink = sink + ff.word(0); });
+    report("fillRandom(xoshiro, p = 0.3, 8 digits)", double(iters) * 4096, t, "bits");
+    t = timeIt(iters, [&](size_t) { fillRandomCount(ff, xo, 410); sink = sink + ff.word(0); });
+    report("fillRandomCount(xoshiro, k = 410)", double(iters) * 4096, t, "bits");
+
+    std::mt19937_64 mt(1);
+    std::bernoulli_distribution bern(0.3);
+    t = timeIt(iters / 10, [&](size_t) {
+        ff.clear();
+        for (size_t i = 0; i < ff.size(); i++) if (bern(mt)) ff.set(i);
+        sink = sink + ff.word(0);
+    });
+    report("per-index bernoulli(mt19937_64, p = 0.3)", double(iters / 10) * 4096, t, "bits");
+}
+
+void bench_dataflow() {
+    std::cout << "Benchmarking liveness on a 10K block CFG with 4 Kbit sets..." << std::endl;
+    const size_t n = 10000;
+    constexpr size_t V = 4096;
+    FlagXoshiro rng(11);
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t b = 0; b + 1 < n; b++) {
+        edges.emplace_back(b, b + 1);
+        const uint64_t r = randomBelow(rng, 10);
+        if (r < 3 && b + 2 < n) edges.emplace_back(b, b + 2 + randomBelow(rng, 20) % (n - b - 2));
+        if (r == 3 && b > 50) edges.emplace_back(b, b - 1 - randomBelow(rng, 50));
+    }
+
+    FlagDataflow<V, FlagFlow::Backward> live(n);
+    std::vector<FlagField<V>> gen(n), kill(n);
+    for (const auto& e : edges) live.addEdge(e.first, e.second);
+    for (size_t b = 0; b < n; b++) {
+        fillRandomCount(gen[b], rng, 20);
+        fillRandomCount(kill[b], rng, 20);
+        for (size_t w = 0; w < gen[b].numWords(); w++) {
+            live.gen(b).setWord(w, gen[b].word(w));
+            live.kill(b).setWord(w, kill[b].word(w));
+        }
+    }
+    size_t evals = 0;
+    double t = timeIt(1, [&](size_t) { evals = live.solve(); });
+    std::cout << "\tFlagDataflow::solve(): " << t * 1e3 << " ms, " << evals << " transfers" << std::endl;
+
+    // Round robin over blocks with FlagField operators
+    std::vector<std::vector<size_t>> succs(n);
+    for (const auto& e : edges) succs[e.first].push_back(e.second);
+    std::vector<FlagField<V>> in(n), out(n);
+    size_t naive = 0;
+    t = timeIt(1, [&](size_t) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t b = n; b-- > 0;) {
+                out[b].clear();
+                for (size_t s : succs[b]) out[b] = out[b] | in[s];
+                FlagField<V> x = gen[b] | (out[b] - kill[b]);
+                naive++;
+                if (!(x == in[b] && in[b] == x)) { in[b] = x; changed = true; }
+            }
+        }
+    });
+    std::cout << "\toperator round robin: " << t * 1e3 << " ms, " << naive << " transfers" << std::endl;
+    for (size_t b = 0; b < n; b += 97) {
+        for (size_t w = 0; w < in[b].numWords(); w++) {
+            if (in[b].word(w) != live.in(b).word(w)) {
+                std::cout << "\tMISMATCH at block " << b << std::endl;
+                return;
+            }
+        }
+    }
+}
+
+template <size_t N>
+void bench_graph_(const size_t& degree) {
+    FlagXoshiro rng(13);
+    FlagGraph<N> g;
+    std::vector<std::vector<uint32_t>> adj(N);
+    for (size_t e = 0; e < N * degree / 2; e++) {
+        const uint32_t u = uint32_t(randomBelow(rng, N)), v = uint32_t(randomBelow(rng, N));
+        g.addEdge(u, v);
+        adj[u].push_back(v);
+        adj[v].push_back(u);
+    }
+    const size_t edges = g.numEdges();
+    const size_t sources = 16;
+    std::cout << "\t" << N << " nodes, average degree " << degree << ", " << edges << " edges" << std::endl;
+
+    double t = timeIt(sources, [&](size_t i) { sink = g.bfs(i * 977 % N).numSetFlags(); });
+    report("FlagGraph::bfs()", edges * sources, t, "edges");
+
+    std::vector<uint32_t> depth(N), queue(N);
+    t = timeIt(sources, [&](size_t i) {
+        std::fill(depth.begin(), depth.end(), ~uint32_t(0));
+        size_t head = 0, tail = 0;
+        const uint32_t s = uint32_t(i * 977 % N);
+        depth[s] = 0;
+        queue[tail++] = s;
+        while (head < tail) {
+            const uint32_t u = queue[head++];
+            for (uint32_t v : adj[u]) {
+                if (depth[v] == ~uint32_t(0)) { depth[v] = depth[u] + 1; queue[tail++] = v; }
+            }
+        }
+        sink = tail;
+    });
+    report("adjacency list BFS", edges * sources, t, "edges");
+}
+
+void bench_graph() {
+    std::cout << "Benchmarking BFS (traversed edges per second) on random graphs..." << std::endl;
+    bench_graph_<4096>(16);
+    bench_graph_<16384>(16);
+    bench_graph_<65536>(16);
+    bench_graph_<16384>(256);
+}
+
+/// @brief A build graph where every node depends on 3 of the 4096 nodes before it.
+template <class G>
+void buildGraph_(G& g, const size_t& n, FlagXoshiro& rng) {
+    for (size_t i = 1; i < n; i++) {
+        for (size_t d = 0; d < 3; d++) g.addEdge(i, i - 1 - randomBelow(rng, i < 4096 ? i : 4096));
+    }
+}
+
+template <size_t N>
+void bench_closure_(const bool& baselines) {
+    FlagXoshiro rng(17);
+    std::unique_ptr<FlagClosure<N>> c(new FlagClosure<N>());
+    buildGraph_(*c, N, rng);
+    double t = timeIt(1, [&](size_t) { c->close(); });
+    size_t reach = 0;
+    for (size_t i = 0; i < N; i++) reach += c->reachableFrom(i).numSetFlags();
+    std::cout << "\t" << N << " nodes, " << reach / N << " reachable per node" << std::endl;
+    std::cout << "\t\tFlagClosure::close(): " << t * 1e3 << " ms" << std::endl;
+
+    const size_t adds = 100;
+    t = timeIt(adds, [&](size_t) { c->addEdge(randomBelow(rng, N), randomBelow(rng, N)); });
+    std::cout << "\t\tFlagClosure::addEdge() after close: " << t * 1e6 / adds << " us/edge" << std::endl;
+    if (!baselines) return;
+
+    // Unblocked Warshall over the same rows
+    rng = FlagXoshiro(17);
+    FlagFieldVector<N, size_t, FlagCheck::Unchecked> rows(N);
+    struct { decltype(rows)& r; void addEdge(size_t u, size_t v) { r[u].set(v); } } adder{rows};
+    buildGraph_(adder, N, rng);
+    t = timeIt(1, [&](size_t) {
+        for (size_t k = 0; k < N; k++) {
+            for (size_t i = 0; i < N; i++) {
+                if (rows[i].isSet(k)) rows[i] |= rows[k];
+            }
+        }
+    });
+    std::cout << "\t\tunblocked row Warshall: " << t * 1e3 << " ms" << std::endl;
+
+    // Scalar Floyd-Warshall over bools
+    rng = FlagXoshiro(17);
+    std::vector<uint8_t> m(N * N, 0);
+    struct { std::vector<uint8_t>& m; void addEdge(size_t u, size_t v) { m[u * N + v] = 1; } } madder{m};
+    buildGraph_(madder, N, rng);
+    t = timeIt(1, [&](size_t) {
+        for (size_t k = 0; k < N; k++) {
+            for (size_t i = 0; i < N; i++) {
+                if (!m[i * N + k]) continue;
+                for (size_t j = 0; j < N; j++) m[i * N + j] |= m[k * N + j];
+            }
+        }
+    });
+    std::cout << "\t\tscalar bool Floyd-Warshall: " << t * 1e3 << " ms" << std::endl;
+}
+
+void bench_closure() {
+    std::cout << "Benchmarking transitive closure of build graphs (3 dependencies per node)..." << std::endl;
+    bench_closure_<4096>(true);
+    bench_closure_<16384>(false);
+    bench_closure_<65536>(false);
+}
+
+void bench_gf2() {
+    std::cout << "Benchmarking 4096x4096 GF(2) matrices..." << std::endl;
+    constexpr size_t N = 4096;
+    FlagXoshiro rng(19);
+    FlagGF2Matrix<N> a(N), b(N);
+    for (size_t i = 0; i < N; i++) {
+        fillRandom(a[i], rng, 0.5);
+        fillRandom(b[i], rng, 0.5);
+    }
+
+    FlagGF2Matrix<N> c;
+    double t = timeIt(1, [&](size_t) { c = FlagGF2Matrix<N>::multiply(a, b); });
+    std::cout << "\tFour Russians multiply: " << t * 1e3 << " ms" << std::endl;
+
+    // Row by row XORs through FlagField operators
+    FlagGF2Matrix<N> naive(N);
+    t = timeIt(1, [&](size_t) {
+        for (size_t i = 0; i < N; i++) {
+            for (size_t k = 0; k < N; k++) {
+                if (a[i].isSet(k)) naive[i] ^= b[k];
+            }
+        }
+    });
+    std::cout << "\trow XOR multiply: " << t * 1e3 << " ms" << (naive == c ? "" : " MISMATCH") << std::endl;
+
+    size_t r = 0;
+    t = timeIt(1, [&](size_t) { r = a.rank(); });
+    std::cout << "\trank(): " << t * 1e3 << " ms (rank " << r << ")" << std::endl;
+
+    FlagGF2Matrix<N> e = a;
+    t = timeIt(1, [&](size_t) { r = e.rowEchelon(true); });
+    std::cout << "\trowEchelon(reduced): " << t * 1e3 << " ms" << std::endl;
+
+    FlagGF2Matrix<N> inv;
+    bool ok = false;
+    t = timeIt(1, [&](size_t) { ok = a.inverse(inv); });
+    std::cout << "\tinverse(): " << t * 1e3 << " ms" << (ok ? "" : " (singular)") << std::endl;
+
+    FlagField<N, size_t, FlagCheck::Unchecked> x, rhs;
+    fillRandom(x, rng, 0.5);
+    a.multiply(x, rhs);
+    t = timeIt(1, [&](size_t) { ok = a.solve(rhs, x); });
+    std::cout << "\tsolve(): " << t * 1e3 << " ms" << (ok ? "" : " (no solution)") << std::endl;
+}
+
+void bench_match() {
+    std::cout << "Benchmarking pattern scans over 16 MB of text..." << std::endl;
+    FlagXoshiro rng(23);
+    std::string text(16 << 20, ' ');
+    for (char& c : text) c = "abcdefghijklmnopqrstuvwxyz "[randomBelow(rng, 27)];
+    const double mb = double(text.size()) / 1e6;
+
+    for (size_t len : {16, 128, 1024}) {
+        std::string pattern = text.substr(text.size() / 2, len);
+        pattern[len / 3] = '#';
+        const size_t k = len / 16;
+        std::cout << "\tpattern of " << len << " characters, k = " << k << std::endl;
+
+        FlagShiftOr<1024> shiftOr(pattern);
+        double t = timeIt(1, [&](size_t) { sink = shiftOr.count(text.data(), text.size()); });
+        std::cout << "\t\tFlagShiftOr: " << mb / t << " MB/s" << std::endl;
+
+        t = timeIt(1, [&](size_t) {
+            size_t c = 0;
+            for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) c++;
+            sink = c;
+        });
+        std::cout << "\t\tstd::string::find: " << mb / t << " MB/s" << std::endl;
+
+        FlagMyers<1024> myers(pattern);
+        size_t hits = 0;
+        t = timeIt(1, [&](size_t) { hits = myers.count(text.data(), text.size(), k); });
+        std::cout << "\t\tFlagMyers: " << mb / t << " MB/s (" << hits << " matches)" << std::endl;
+
+        // Sellers' dynamic program over a slice of the text
+        const size_t slice = (1 << 24) / len;
+        t = timeIt(1, [&](size_t) {
+            std::vector<size_t> col(len + 1);
+            for (size_t i = 0; i <= len; i++) col[i] = i;
+            size_t c = 0;
+            for (size_t j = 0; j < slice; j++) {
+                size_t diag = col[0];
+                for (size_t i = 1; i <= len; i++) {
+                    const size_t up = col[i];
+                    size_t best = diag + (pattern[i - 1] != text[j]);
+                    if (col[i - 1] + 1 < best) best = col[i - 1] + 1;
+                    if (up + 1 < best) best = up + 1;
+                    col[i] = best;
+                    diag = up;
+                }
+                c += col[len] <= k;
+            }
+            sink = c;
+        });
+        std::cout << "\t\tdynamic programming: " << double(slice) / 1e6 / t << " MB/s" << std::endl;
+    }
+}
+
+template <size_t MAX>
+void bench_query_(const size_t& n) {
+    FlagXoshiro rng(29);
+    std::vector<FlagField<MAX>> rows(n);
+    for (auto& r : rows) fillRandom(r, rng, 0.5);
+    std::cout << "\t" << n / 1000000 << "M records of FlagField<" << MAX << ">" << std::endl;
+
+    // (A and B) or (C and not D)
+    using P = FlagPredicate<MAX>;
+    FlagQuery<MAX> q((P::flag(1) && P::flag(5)) || (P::flag(2) && !P::flag(MAX - 1)));
+    std::vector<uint64_t> bitmap((n + 63) / 64);
+    double t = timeIt(1, [&](size_t) { q.select(rows.data(), n, bitmap.data()); });
+    report("FlagQuery::select() bitmap", double(n), t, "rows");
+
+    std::vector<size_t> indices;
+    t = timeIt(1, [&](size_t) { sink = q.select(rows.data(), n, indices); });
+    report("FlagQuery::select() indices", double(n), t, "rows");
+
+    t = timeIt(1, [&](size_t) {
+        size_t c = 0;
+        for (size_t i = 0; i < n; i++) {
+            const auto& r = rows[i];
+            c += (r.isSet(1) && r.isSet(5)) || (r.isSet(2) && !r.isSet(MAX - 1));
+        }
+        sink = c;
+    });
+    report("isSet() per row", double(n), t, "rows");
+}
+
+void bench_query() {
+    std::cout << "Benchmarking compiled predicate scans..." << std::endl;
+    bench_query_<8>(100000000);
+    bench_query_<32>(100000000);
+    bench_query_<128>(20000000);
+}
+
+void bench_ecs() {
+    std::cout << "Benchmarking ECS queries over 1M entities in 500 archetypes..." << std::endl;
+    constexpr size_t C = 64;
+    const size_t entities = 1000000, archetypes = 500, queries = 16;
+    FlagXoshiro rng(37);
+    std::vector<FlagField<C>> pool(archetypes), sigs(entities);
+    for (auto& p : pool) fillRandom(p, rng, 0.125);
+    for (auto& s : sigs) s = pool[randomBelow(rng, archetypes)];
+    std::vector<std::pair<FlagField<C>, FlagField<C>>> qs(queries);
+    for (auto& q : qs) {
+        q.first.set(size_t(randomBelow(rng, C)));
+        q.first.set(size_t(randomBelow(rng, C)));
+        q.second.set(size_t(randomBelow(rng, C)));
+    }
+
+    FlagArchetypes<C> world;
+    double t = timeIt(1, [&](size_t) { for (size_t e = 0; e < entities; e++) world.add(e, sigs[e]); });
+    std::cout << "\tadd() 1M entities: " << t * 1e3 << " ms (" << world.numArchetypes() << " archetypes)" << std::endl;
+
+    std::vector<size_t> ids(queries);
+    t = timeIt(queries, [&](size_t q) { ids[q] = world.query(qs[q].first, qs[q].second); });
+    std::cout << "\tquery() setup: " << t * 1e6 / queries << " us/query" << std::endl;
+
+    const size_t frames = 20;
+    size_t matched = 0;
+    t = timeIt(frames, [&](size_t) {
+        uint64_t sum = 0;
+        matched = 0;
+        for (size_t q : ids) {
+            world.forEach(q, [&](const size_t* e, size_t n, size_t) {
+                for (size_t i = 0; i < n; i++) sum += e[i];
+                matched += n;
+            });
+        }
+        sink = sum;
+    });
+    std::cout << "\tcached query iteration: " << t * 1e3 / frames << " ms/frame (" << matched << " entities)" << std::endl;
+
+    t = timeIt(frames, [&](size_t) {
+        uint64_t sum = 0;
+        for (const auto& q : qs) {
+            for (size_t e = 0; e < entities; e++) {
+                if (sigs[e].isSet(q.first) && sigs[e].isNSet(q.second)) sum += e;
+            }
+        }
+        sink = sum;
+    });
+    std::cout << "\tisSet() scan per query: " << t * 1e3 / frames << " ms/frame" << std::endl;
+}
+
+void bench_histogram() {
+    std::cout << "Benchmarking per flag histograms of 10M FlagField<128>..." << std::endl;
+    constexpr size_t N = 128;
+    const size_t n = 10000000;
+    FlagXoshiro rng(41);
+    std::vector<FlagField<N>> rows(n);
+    for (auto& r : rows) fillRandom(r, rng, 0.25);
+    std::vector<uint64_t> weights(n);
+    for (auto& w : weights) w = randomBelow(rng, 256);
+
+    std::array<uint64_t, N> counts{};
+    double t = timeIt(3, [&](size_t) { counts = histogram(rows.data(), n); });
+    report("histogram()", 3 * n, t, "rows");
+    t = timeIt(3, [&](size_t) { counts = histogram(rows.data(), n, weights.data()); });
+    report("histogram() weighted (8 bit)", 3 * n, t, "rows");
+    t = timeIt(3, [&](size_t) { counts = histogram(rows.data(), n, &FlagThreadPool::global()); });
+    report("histogram() on the thread pool", 3 * n, t, "rows");
+    sink = counts[0];
+
+    t = timeIt(1, [&](size_t) {
+        std::array<uint64_t, N> c{};
+        for (size_t r = 0; r < n; r++) {
+            for (size_t i = 0; i < N; i++) c[i] += rows[r].isSet(i);
+        }
+        sink = c[0];
+    });
+    report("isSet() loop", n, t, "rows");
+}
+
+void bench_cooccurrence() {
+    std::cout << "Benchmarking co-occurrence of 128 flags over 50M rows..." << std::endl;
+    constexpr size_t N = 128;
+    const size_t n = 50000000;
+    FlagXoshiro rng(43);
+    std::vector<FlagField<N>> rows(n);
+    for (auto& r : rows) fillRandom(r, rng, 0.125);
+
+    FlagCooccurrence<N> co;
+    double t = timeIt(1, [&](size_t) { co.add(rows.data(), n); });
+    report("FlagCooccurrence::add()", n, t, "rows");
+    FlagCooccurrence<N> pooled;
+    t = timeIt(1, [&](size_t) { pooled.add(rows.data(), n, &FlagThreadPool::global()); });
+    report("FlagCooccurrence::add() on the thread pool", n, t, "rows");
+    sink = co.count(1, 2) + pooled.count(3, 4);
+
+    // Per row pair enumeration over the set flags, on 1M rows
+    const size_t m = 1000000;
+    std::vector<uint64_t> counts(N * N, 0);
+    t = timeIt(1, [&](size_t) {
+        size_t set[N];
+        for (size_t r = 0; r < m; r++) {
+            size_t k = 0;
+            for (size_t i = 0; i < N; i++) {
+                if (rows[r].isSet(i)) set[k++] = i;
+            }
+            for (size_t a = 0; a < k; a++) {
+                for (size_t b = a; b < k; b++) counts[set[a] * N + set[b]]++;
+            }
+        }
+    });
+    report("per row pair loop", m, t, "rows");
+    sink = counts[N + 2];
+}
+
+/// @brief Level-wise Apriori with horizontal subset tests, as a baseline for FlagEclat.
+template <size_t N>
+size_t apriori(const std::vector<FlagField<N>>& rows, const size_t& n, const uint64_t& minSupport) {
+    using Set = FlagField<N, size_t, FlagCheck::Unchecked>;
+    constexpr size_t W = Set::numWords();
+    auto key = [](const Set& s) {
+        uint64_t h = 0;
+        for (size_t w = 0; w < W; w++) h = (h ^ s.word(w)) * 0x9E3779B97F4A7C15ULL;
+        return h;
+    };
+    auto same = [](const Set& a, const Set& b) {
+        for (size_t w = 0; w < W; w++) {
+            if (a.word(w) != b.word(w)) return false;
+        }
+        return true;
+    };
+    auto highest = [](const Set& s) {
+        for (size_t w = W; w-- > 0;) {
+            if (s.word(w)) return w * 64 + 63 - size_t(__builtin_clzll(s.word(w)));
+        }
+        return size_t(0);
+    };
+    std::vector<Set> level;
+    for (size_t i = 0; i < N; i++) {
+        Set s;
+        s.set(i);
+        level.push_back(s);
+    }
+    size_t found = 0;
+    while (!level.empty()) {
+        // Count the candidates with one pass over the rows
+        std::vector<uint64_t> support(level.size(), 0);
+        for (size_t r = 0; r < n; r++) {
+            for (size_t c = 0; c < level.size(); c++) {
+                bool all = true;
+                for (size_t w = 0; w < W && all; w++) all = (rows[r].word(w) & level[c].word(w)) == level[c].word(w);
+                support[c] += all;
+            }
+        }
+        std::vector<Set> frequent;
+        std::unordered_map<uint64_t, std::vector<size_t>> index;
+        for (size_t c = 0; c < level.size(); c++) {
+            if (support[c] >= minSupport) {
+                index[key(level[c])].push_back(frequent.size());
+                frequent.push_back(level[c]);
+            }
+        }
+        found += frequent.size();
+        auto isFrequent = [&](const Set& s) {
+            const auto it = index.find(key(s));
+            if (it == index.end()) return false;
+            for (size_t f : it->second) {
+                if (same(frequent[f], s)) return true;
+            }
+            return false;
+        };
+        // Join sets differing only in their highest flag, then prune by every subset one smaller
+        std::vector<Set> next;
+        for (size_t a = 0; a < frequent.size(); a++) {
+            Set prefix = frequent[a];
+            const size_t ha = highest(prefix);
+            prefix.clear(ha);
+            for (size_t b = a + 1; b < frequent.size(); b++) {
+                Set other = frequent[b];
+                const size_t hb = highest(other);
+                other.clear(hb);
+                if (ha == hb || !same(prefix, other)) continue;
+                Set cand = frequent[a];
+                cand.set(hb);
+                bool ok = true;
+                for (size_t w = 0; w < W && ok; w++) {
+                    for (uint64_t x = cand.word(w); x && ok; x &= x - 1) {
+                        Set sub = cand;
+                        sub.clear(w * 64 + size_t(__builtin_ctzll(x)));
+                        ok = isFrequent(sub);
+                    }
+                }
+                if (ok) next.push_back(cand);
+            }
+        }
+        level.swap(next);
+    }
+    return found;
+}
+
+void bench_eclat() {
+    std::cout << "Benchmarking frequent itemset mining over 10M FlagField<128>..." << std::endl;
+    constexpr size_t N = 128;
+    const size_t n = 10000000, patterns = 20;
+    FlagXoshiro rng(47);
+    // Each row has 2% noise flags plus one of 20 planted 8 flag patterns, each flag kept 90% of the time
+    std::vector<std::vector<size_t>> planted(patterns);
+    for (auto& p : planted) {
+        for (size_t k = 0; k < 8; k++) p.push_back(size_t(randomBelow(rng, N)));
+    }
+    std::vector<FlagField<N>> rows(n);
+    for (auto& r : rows) {
+        fillRandom(r, rng, 0.02);
+        for (size_t f : planted[randomBelow(rng, patterns)]) {
+            if (randomBelow(rng, 10)) r.set(f);
+        }
+    }
+    const double minFraction = 0.01;
+
+    std::unique_ptr<FlagEclat<N>> miner;
+    double t = timeIt(1, [&](size_t) { miner.reset(new FlagEclat<N>(rows.data(), n)); });
+    report("FlagEclat transpose", n, t, "rows");
+    size_t found = 0;
+    t = timeIt(1, [&](size_t) { found = miner->mine(uint64_t(n * minFraction)).size(); });
+    std::cout << "\tFlagEclat::mine() 10M rows: " << t * 1e3 << " ms (" << found << " itemsets)" << std::endl;
+    t = timeIt(1, [&](size_t) { found = miner->mine(uint64_t(n * minFraction), N, &FlagThreadPool::global()).size(); });
+    std::cout << "\tFlagEclat::mine() on the thread pool: " << t * 1e3 << " ms" << std::endl;
+
+    // Apriori on a subset, against Eclat on the same subset
+    const size_t m = 200000;
+    t = timeIt(1, [&](size_t) {
+        FlagEclat<N> small(rows.data(), m);
+        found = small.mine(uint64_t(m * minFraction)).size();
+    });
+    std::cout << "\tFlagEclat 200K rows: " << t * 1e3 << " ms (" << found << " itemsets)" << std::endl;
+    t = timeIt(1, [&](size_t) { found = apriori(rows, m, uint64_t(m * minFraction)); });
+    std::cout << "\tApriori 200K rows: " << t * 1e3 << " ms (" << found << " itemsets)" << std::endl;
+}
+
+void bench_vote() {
+    std::cout << "Benchmarking k-of-N votes over FlagField<256>..." << std::endl;
+    constexpr size_t N = 256;
+    FlagXoshiro rng(47);
+    for (size_t n : {3, 31, 1001}) {
+        std::vector<FlagField<N>> rows(n);
+        for (auto& r : rows) fillRandom(r, rng, 0.5);
+        const size_t iters = 3000000 / n;
+        const std::string tag = " (N = " + std::to_string(n) + ")";
+        FlagField<N> out;
+        double t = timeIt(iters, [&](size_t) { out = majority(rows.data(), n); });
+        report(("majority()" + tag).c_str(), iters, t, "votes");
+        t = timeIt(iters, [&](size_t i) { out = exactlyK(rows.data(), n, i % (n + 1)); });
+        report(("exactlyK()" + tag).c_str(), iters, t, "votes");
+        sink = out.word(0);
+        if (n > 100) {
+            t = timeIt(iters, [&](size_t) { out = majority(rows.data(), n, &FlagThreadPool::global()); });
+            report(("majority() on the thread pool" + tag).c_str(), iters, t, "votes");
+        }
+        t = timeIt(iters, [&](size_t) {
+            FlagField<N> maj;
+            for (size_t i = 0; i < N; i++) {
+                size_t c = 0;
+                for (size_t r = 0; r < n; r++) c += rows[r].isSet(i);
+                if (2 * c > n) maj.set(i);
+            }
+            out = maj;
+        });
+        report(("isSet() counting loop" + tag).c_str(), iters, t, "votes");
+        sink = out.word(0);
+    }
+}
+
+void bench_sequence() {
+    std::cout << "Benchmarking anti-replay checks over a 4096 sequence window..." << std::endl;
+    // Mostly in order, with reordering within 64 and 10% replays
+    const size_t n = 10000000;
+    FlagXoshiro rng(53);
+    std::vector<uint64_t> seqs(n);
+    for (size_t i = 0; i < n; i++) {
+        seqs[i] = randomBelow(rng, 10) == 0 && i > 0 ? seqs[randomBelow(rng, i) / 2 + i / 2] : i + randomBelow(rng, 64);
+    }
+
+    size_t accepted = 0;
+    double t = timeIt(1, [&](size_t) {
+        FlagSequenceWindow<4096> window;
+        for (uint64_t s : seqs) accepted += window.check(s) == FlagSequence::Accepted;
+    });
+    report("FlagSequenceWindow::check()", n, t, "checks");
+    t = timeIt(1, [&](size_t) {
+        FlagAtomicSequenceWindow<4096> window;
+        for (uint64_t s : seqs) accepted += window.check(s) == FlagSequence::Accepted;
+    });
+    report("FlagAtomicSequenceWindow::check()", n, t, "checks");
+    t = timeIt(1, [&](size_t) {
+        std::set<uint64_t> seen;
+        uint64_t top = 0;
+        for (uint64_t s : seqs) {
+            if (s >= top) top = s + 1;
+            else if (top > 4096 && s < top - 4096) continue;
+            while (top > 4096 && !seen.empty() && *seen.begin() < top - 4096) seen.erase(seen.begin());
+            accepted += seen.insert(s).second;
+        }
+    });
+    report("std::set window", n, t, "checks");
+    sink = accepted;
+}
+
+void bench_timer() {
+    std::cout << "Benchmarking 1M timers with mixed durations..." << std::endl;
+    // Millisecond ticks: 10% under 100 ms, 60% under 30 s, 30% under 5 min; half cancelled before expiry
+    const size_t n = 1000000;
+    FlagXoshiro rng(59);
+    std::vector<uint64_t> when(n);
+    std::vector<bool> cancelled(n);
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t r = randomBelow(rng, 10);
+        when[i] = 1 + randomBelow(rng, r == 0 ? 100 : r < 7 ? 30000 : 300000);
+        cancelled[i] = randomBelow(rng, 2);
+    }
+    const uint64_t end = 300001;
+
+    size_t fired = 0;
+    std::vector<uint64_t> handles(n);
+    FlagTimerWheel<> wheel;
+    double t = timeIt(1, [&](size_t) {
+        for (size_t i = 0; i < n; i++) handles[i] = wheel.schedule(when[i], i);
+    });
+    report("FlagTimerWheel::schedule()", n, t, "timers");
+    double total = t;
+    t = timeIt(1, [&](size_t) {
+        for (size_t i = 0; i < n; i++) {
+            if (cancelled[i]) wheel.cancel(handles[i]);
+        }
+    });
+    report("FlagTimerWheel::cancel()", n / 2, t, "timers");
+    total += t;
+    t = timeIt(1, [&](size_t) {
+        for (uint64_t now = 1; now <= end; now++) wheel.advance(now, [&](uint64_t, uint64_t) { fired++; });
+    });
+    report("FlagTimerWheel::advance() every tick", n / 2, t, "expiries");
+    total += t;
+    report("FlagTimerWheel total", n, total, "timers");
+
+    using Entry = std::pair<uint64_t, size_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    std::vector<bool> dead(n);
+    t = timeIt(1, [&](size_t) {
+        for (size_t i = 0; i < n; i++) heap.push({when[i], i});
+    });
+    report("std::priority_queue push", n, t, "timers");
+    total = t;
+    t = timeIt(1, [&](size_t) {
+        // Cancelling from a heap is lazy: mark, and skip on pop
+        for (size_t i = 0; i < n; i++) dead[i] = cancelled[i];
+    });
+    total += t;
+    t = timeIt(1, [&](size_t) {
+        for (uint64_t now = 1; now <= end; now++) {
+            while (!heap.empty() && heap.top().first <= now) {
+                fired += !dead[heap.top().second];
+                heap.pop();
+            }
+        }
+    });
+    report("std::priority_queue pop every tick", n / 2, t, "expiries");
+    total += t;
+    report("std::priority_queue total", n, total, "timers");
+    sink = fired;
+}
+
+void bench_scheduler() {
+    std::cout << "Benchmarking 256 level priority run queues, 1000 tasks queued..." << std::endl;
+    const size_t tasks = 1000, iters = 10000000;
+    FlagXoshiro rng(61);
+    std::vector<FlagRunNode> nodes(tasks);
+    std::vector<size_t> priorities(1 << 16);
+    for (auto& p : priorities) p = randomBelow(rng, 256);
+    const size_t mask = priorities.size() - 1;
+
+    // Steady state: pop the highest task and push it back at another priority
+    size_t sum = 0;
+    FlagPriorityScheduler<256> queue;
+    for (size_t i = 0; i < tasks; i++) queue.push(&nodes[i], priorities[i]);
+    double t = timeIt(iters, [&](size_t i) {
+        size_t p = 0;
+        FlagRunNode* node = queue.pop(&p);
+        if (!node) return;
+        sum += p;
+        queue.push(node, priorities[i & mask]);
+    });
+    report("FlagPriorityScheduler pop + push", iters, t, "ops");
+
+    FlagCoreScheduler<256> cores(4);
+    for (size_t i = 0; i < tasks; i++) cores.push(i % 4, &nodes[i], priorities[i]);
+    t = timeIt(iters, [&](size_t i) {
+        size_t p = 0;
+        FlagRunNode* node = cores.pop(i % 4, &p);
+        if (!node) return;
+        sum += p;
+        cores.push(i % 4, node, priorities[i & mask]);
+    });
+    report("FlagCoreScheduler pop + push", iters, t, "ops");
+
+    // The isSet() scan it replaces
+    FlagField<256> ready;
+    std::vector<std::deque<FlagRunNode*>> fifos(256);
+    for (size_t i = 0; i < tasks; i++) {
+        fifos[priorities[i]].push_back(&nodes[i]);
+        ready.set(priorities[i]);
+    }
+    t = timeIt(iters, [&](size_t i) {
+        size_t p = 255;
+        while (!ready.isSet(p)) p--;
+        FlagRunNode* node = fifos[p].front();
+        fifos[p].pop_front();
+        if (fifos[p].empty()) ready.clear(p);
+        sum += p;
+        const size_t q = priorities[i & mask];
+        fifos[q].push_back(node);
+        ready.set(q);
+    });
+    report("isSet() scan + std::deque", iters, t, "ops");
+    sink = sum;
+}
+
+/// @brief A thread pool waking workers with a condition variable broadcast, as FlagExecutor replaces.
+class CondVarPool {
+public:
+    explicit CondVarPool(const size_t& threads) {
+        for (size_t i = 0; i < threads; i++) workers_.emplace_back([this] { work_(); });
+    }
+    ~CondVarPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+    template <class Fn>
+    void spawn(Fn&& fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace_back(std::forward<Fn>(fn));
+            pending_++;
+        }
+        wake_.notify_all();
+    }
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+    }
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    std::deque<std::function<void()>> tasks_;
+    size_t pending_ = 0;
+    bool stop_ = false;
+
+    void work_() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+            std::function<void()> task = std::move(tasks_.front());
+            tasks_.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+            if (--pending_ == 0) done_.notify_all();
+        }
+    }
+};
+
+template <class Pool>
+void bench_pool(const char* name, const size_t& threads) {
+    // Bursts of small tasks, each recording the time from spawn to start
+    const size_t bursts = 200, perBurst = 500, n = bursts * perBurst;
+    std::vector<double> latency(n);
+    Pool pool(threads);
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t b = 0; b < bursts; b++) {
+        for (size_t i = b * perBurst; i < (b + 1) * perBurst; i++) {
+            const auto spawned = std::chrono::steady_clock::now();
+            pool.spawn([&latency, i, spawned] {
+                latency[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - spawned).count();
+                uint64_t x = i;
+                for (size_t k = 0; k < 200; k++) x = x * 6364136223846793005ULL + 1;
+                sink = x;
+            });
+        }
+        pool.wait();
+    }
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::sort(latency.begin(), latency.end());
+    std::cout << "\t" << name << " (" << threads << " threads): " << n / t / 1e6 << " Mtasks/s, p50 "
+        << latency[n / 2] * 1e6 << " us, p99 " << latency[n * 99 / 100] * 1e6 << " us, p99.9 "
+        << latency[n * 999 / 1000] * 1e6 << " us" << std::endl;
+}
+
+void bench_executor() {
+    std::cout << "Benchmarking task throughput and spawn to start latency..." << std::endl;
+    for (size_t threads : {1, 2, 4, 8, 16, 64}) {
+        bench_pool<FlagExecutor<>>("FlagExecutor", threads);
+        bench_pool<CondVarPool>("condition variable pool", threads);
+    }
+}
+
+void bench_doorbell() {
+    std::cout << "Benchmarking event notification from many producers, 1024 sources..." << std::endl;
+    constexpr size_t sources = 1024;
+    const size_t events = 2000000;
+    for (size_t producers : {1, 2, 4, 8, 16, 32}) {
+        const size_t each = events / producers;
+        size_t wakeups = 0, rings = 0, handled = 0;
+        std::atomic<size_t> rang(0);
+        double t = timeIt(1, [&](size_t) {
+            FlagDoorbell<sources + 1> bell;
+            std::thread consumer([&] {
+                for (bool stop = false; !stop;) {
+                    bell.wait();
+                    wakeups++;
+                    handled += bell.drain([&](size_t s) { stop |= s == sources; });
+                }
+            });
+            std::vector<std::thread> threads;
+            for (size_t p = 0; p < producers; p++) {
+                threads.emplace_back([&, p] {
+                    FlagXoshiro rng(p + 1);
+                    size_t mine = 0;
+                    for (size_t i = 0; i < each; i++) mine += bell.ring(randomBelow(rng, sources));
+                    rang += mine;
+                });
+            }
+            for (auto& th : threads) th.join();
+            bell.ring(sources);
+            consumer.join();
+            rings = rang;
+        });
+        std::cout << "\tFlagDoorbell (" << producers << " producers): " << each * producers / t / 1e6
+            << " Mevents/s, " << rings << " eventfd writes, " << wakeups << " wake-ups, "
+            << handled << " dispatches" << std::endl;
+
+        wakeups = 0;
+        size_t notifies = 0;
+        t = timeIt(1, [&](size_t) {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::deque<size_t> queue;
+            std::thread consumer([&] {
+                std::unique_lock<std::mutex> lock(mutex);
+                for (bool stop = false; !stop;) {
+                    ready.wait(lock, [&] { return !queue.empty(); });
+                    wakeups++;
+                    while (!queue.empty()) {
+                        stop |= queue.front() == sources;
+                        queue.pop_front();
+                    }
+                }
+            });
+            std::vector<std::thread> threads;
+            std::atomic<size_t> notified(0);
+            for (size_t p = 0; p < producers; p++) {
+                threads.emplace_back([&, p] {
+                    FlagXoshiro rng(p + 1);
+                    for (size_t i = 0; i < each; i++) {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            queue.push_back(randomBelow(rng, sources));
+                        }
+                        ready.notify_one();
+                    }
+                    notified += each;
+                });
+            }
+            for (auto& th : threads) th.join();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(sources);
+            }
+            ready.notify_one();
+            consumer.join();
+            notifies = notified + 1;
+        });
+        std::cout << "\tmutex queue (" << producers << " producers): " << each * producers / t / 1e6
+            << " Mevents/s, " << notifies << " notifies, " << wakeups << " wake-ups" << std::endl;
+    }
+}
+
+// Mark bitmap of a 4 GB heap model at 16 byte granules (256M bits, 32 MB of
+// bitmap; the heap itself is never touched) against std::vector<bool>:
+// random marking on one thread and on the pool, sweeping at several
+// liveness levels, and clearing eagerly against the O(1) epoch flip.
+void bench_mark() {
+    const size_t heapBytes = size_t(4) << 30, granules = heapBytes / 16;
+    const void* base = reinterpret_cast<const void*>(uintptr_t(1) << 40);
+    const size_t marks = 4 << 20;
+    std::vector<const void*> pointers(marks);
+    std::vector<size_t> indices(marks);
+    FlagXoshiro rng(73);
+    for (size_t i = 0; i < marks; i++) {
+        indices[i] = randomBelow(rng, granules);
+        pointers[i] = static_cast<const char*>(base) + indices[i] * 16;
+    }
+    FlagMarkBitmap<16> bitmap(base, heapBytes);
+    std::vector<bool> model(granules);
+    FlagThreadPool& pool = FlagThreadPool::global();
+
+    double t = timeIt(1, [&](size_t) {
+        size_t n = 0;
+        for (size_t i : indices) {
+            if (!model[i]) model[i] = true, n++;
+        }
+        sink = n;
+    });
+    report("mark vector<bool>", marks, t, "marks");
+    t = timeIt(1, [&](size_t) {
+        size_t n = 0;
+        for (const void* p : pointers) n += bitmap.tryMark(p);
+        sink = n;
+    });
+    report("mark tryMark", marks, t, "marks");
+    bitmap.clear();
+    t = timeIt(1, [&](size_t) { sink = bitmap.markAll(pointers.data(), marks, &pool); });
+    report("mark markAll (pool)", marks, t, "marks");
+
+    for (double live : {0.01, 0.1, 0.5}) {
+        // Objects of 1 to 8 granules, laid out end to end, live with probability `live`
+        std::fill(model.begin(), model.end(), false);
+        bitmap.nextEpoch();
+        for (size_t i = 0; i < granules;) {
+            const size_t n = 1 + randomBelow(rng, 8);
+            if (double(randomBelow(rng, 1 << 20)) < live * (1 << 20)) {
+                for (size_t j = i; j < i + n && j < granules; j++) model[j] = true;
+                bitmap.markRange(static_cast<const char*>(base) + i * 16, n * 16);
+            }
+            i += n;
+        }
+        const std::string suffix = " " + std::to_string(int(live * 100)) + "% live";
+        t = timeIt(1, [&](size_t) {
+            size_t runs = 0, bytes = 0;
+            for (size_t i = 0; i < granules;) {
+                if (model[i]) {
+                    i++;
+                    continue;
+                }
+                size_t end = i;
+                while (end < granules && !model[end]) end++;
+                runs++;
+                bytes += (end - i) * 16;
+                i = end;
+            }
+            sink = runs + bytes;
+        });
+        report(("sweep vector<bool>" + suffix).c_str(), granules, t, "granules");
+        t = timeIt(1, [&](size_t) {
+            size_t runs = 0, bytes = 0;
+            bitmap.sweep([&](void*, size_t n) { runs++, bytes += n; });
+            sink = runs + bytes;
+        });
+        report(("sweep FlagMarkBitmap" + suffix).c_str(), granules, t, "granules");
+    }
+
+    t = timeIt(1, [&](size_t) { std::fill(model.begin(), model.end(), false); });
+    report("clear vector<bool>", granules, t, "granules");
+    t = timeIt(1, [&](size_t) { bitmap.clear(); });
+    report("clear FlagMarkBitmap", granules, t, "granules");
+    t = timeIt(1, [&](size_t) { bitmap.clear(&pool); });
+    report("clear FlagMarkBitmap (pool)", granules, t, "granules");
+    t = timeIt(1000, [&](size_t) { bitmap.nextEpoch(); });
+    report("clear nextEpoch", 1000, t, "clears");
+    t = timeIt(1, [&](size_t) {
+        size_t n = 0;
+        for (const void* p : pointers) n += bitmap.tryMark(p);
+        sink = n;
+    });
+    report("mark tryMark after nextEpoch", marks, t, "marks");
+}
+
+// Incremental checkpoints of a 256 MB region against copying all of it, at
+// 1%, 10% and 50% of random pages dirty. Barrier mode times the checkpoint
+// alone; the faulting modes also time the writes, as each first write to a
+// page takes a fault, and the checkpoint write protects the runs again.
+void bench_dirty() {
+    const size_t pages = 65536, bytes = pages * FlagDirtyPages::pageSize;
+    char* region = static_cast<char*>(mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    std::vector<char> snapshot(bytes, 0);
+    std::memset(region, 1, bytes);
+    double t = timeIt(1, [&](size_t) { std::memcpy(snapshot.data(), region, bytes); });
+    report("dirty full copy", double(bytes), t, "B");
+
+    FlagXoshiro rng(74);
+    for (FlagDirtyMode mode : {FlagDirtyMode::Barrier, FlagDirtyMode::Protect, FlagDirtyMode::Userfault}) {
+        const char* name = mode == FlagDirtyMode::Barrier ? "barrier" : mode == FlagDirtyMode::Protect ? "mprotect" : "userfaultfd";
+        std::unique_ptr<FlagDirtyPages> tracker;
+        try {
+            tracker.reset(new FlagDirtyPages(region, bytes, mode));
+        } catch (const std::exception& e) {
+            std::cout << "\t" << name << " skipped: " << e.what() << "\n";
+            continue;
+        }
+        for (double rate : {0.01, 0.1, 0.5}) {
+            std::vector<size_t> dirty;
+            for (size_t i = 0; i < pages; i++) {
+                if (double(randomBelow(rng, 1 << 20)) < rate * (1 << 20)) dirty.push_back(i);
+            }
+            const std::string suffix = std::string(" ") + name + " " + std::to_string(int(rate * 100)) + "% dirty";
+            t = timeIt(1, [&](size_t) {
+                for (size_t i : dirty) {
+                    char* p = region + i * FlagDirtyPages::pageSize;
+                    *reinterpret_cast<volatile char*>(p) = char(i);
+                    if (mode == FlagDirtyMode::Barrier) tracker->markDirty(p);
+                }
+            });
+            report(("dirty writes" + suffix).c_str(), double(dirty.size()), t, "pages");
+            size_t copied = 0;
+            t = timeIt(1, [&](size_t) { copied = tracker->checkpoint(snapshot.data()); });
+            report(("dirty checkpoint" + suffix).c_str(), double(copied), t, "B");
+        }
+    }
+    munmap(region, bytes);
+}
+
+// Fuzzer runs per second on a 64 KB coverage map, each run hitting 300
+// random edges: bucket, check against the virgin map, reset. The baseline is
+// the byte by byte loop with a 256 entry bucket table and a full memset.
+void bench_coverage() {
+    const size_t edges = 65536, runs = 20000, hits = 300;
+    FlagXoshiro rng(75);
+    std::vector<uint32_t> trail(hits * 64);
+    for (auto& e : trail) e = uint32_t(randomBelow(rng, edges));
+
+    const auto& table = FlagCoverageKernels::table();
+    std::vector<uint8_t> counts(edges), virginBytes(edges, 0xFF);
+    size_t found = 0;
+    double t = timeIt(runs, [&](size_t r) {
+        const uint32_t* run = &trail[(r % 64) * hits];
+        for (size_t k = 0; k < hits; k++) counts[run[k]]++;
+        int result = 0;
+        for (size_t e = 0; e < edges; e++) {
+            const uint8_t c = table[counts[e]];
+            if (c & virginBytes[e]) {
+                result = std::max(result, virginBytes[e] == 0xFF ? 2 : 1);
+                virginBytes[e] &= uint8_t(~c);
+            }
+        }
+        found += result != 0;
+        std::memset(counts.data(), 0, edges);
+    });
+    sink = found;
+    report("coverage byte loop", runs, t, "runs");
+
+    std::unique_ptr<FlagCoverageTrace<>> trace(new FlagCoverageTrace<>);
+    std::unique_ptr<FlagCoverageVirgin<>> virgin(new FlagCoverageVirgin<>), global(new FlagCoverageVirgin<>);
+    for (bool sparse : {false, true}) {
+        virgin->reset();
+        found = 0;
+        t = timeIt(runs, [&](size_t r) {
+            const uint32_t* run = &trail[(r % 64) * hits];
+            for (size_t k = 0; k < hits; k++) trace->hit(run[k]);
+            trace->classify();
+            found += hasNewBits(*trace, *virgin) != FlagCoverageResult::None;
+            if (sparse) trace->resetTouched();
+            else trace->reset();
+        });
+        sink = found;
+        report(sparse ? "coverage FlagCoverage (resetTouched)" : "coverage FlagCoverage (memset)", runs, t, "runs");
+    }
+    t = timeIt(1000, [&](size_t) { sink = global->merge(*virgin); });
+    report("coverage merge", 1000, t, "merges");
+}
+
+int main(int argc, char** argv) {
+    const std::string only = argc > 1 ? argv[1] : "";
+    auto run = [&](const char* name, void (*fn)()) {
+        if (only.empty() || only == name) fn();
+    };
+    run("slicing", bench_slicing);
+    run("remap", bench_remap);
+    run("policies", bench_policies);
+    run("vector", bench_vector);
+    run("random", bench_random);
+    run("dataflow", bench_dataflow);
+    run("graph", bench_graph);
+    run("closure", bench_closure);
+    run("gf2", bench_gf2);
+    run("match", bench_match);
+    run("query", bench_query);
+    run("ecs", bench_ecs);
+    run("histogram", bench_histogram);
+    run("cooccurrence", bench_cooccurrence);
+    run("eclat", bench_eclat);
+    run("vote", bench_vote);
+    run("sequence", bench_sequence);
+    run("timer", bench_timer);
+    run("scheduler", bench_scheduler);
+    run("executor", bench_executor);
+    run("doorbell", bench_doorbell);
+    run("mark", bench_mark);
+    run("dirty", bench_dirty);
+    run("coverage", bench_coverage);
+    return 0;
+}
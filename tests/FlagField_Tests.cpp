@@ -545,12 +545,115 @@ void test_bytefield_conversion() {
     }
 }
 
+void test_slicing() {
+    std::cout << "Testing slicing, concatenation and resizing..." << std::endl;
+    {   std::cout << "Testing word access" << std::endl;
+        FlagField<100> ff(0, 63, 64, 99);
+        assert(ff.numWords() == 2);
+        assert(ff.word(0) == ((uint64_t(1) << 63) | 1));
+        assert(ff.word(1) == ((uint64_t(1) << 35) | 1));
+        ff.setWord(1, ~uint64_t(0));
+        assert(ff.isSet(64, 99));
+        assert(ff.word(1) == (uint64_t(1) << 36) - 1);
+        assert(ff.numSetFlags() == 38);
+    }
+    {   std::cout << "Testing slice()" << std::endl;
+        FlagField<1020> ff(3, 13, 76, 500, 1019);
+        FlagField<1000> s = ff.slice<13, 1000>();
+        assert(s.isSet(0, 63, 487));
+        assert(s.numSetFlags() == 3);
+        FlagField<8> s2 = ff.slice<1012, 8>();
+        assert(s2.isSet(7));
+        assert(s2.numSetFlags() == 1);
+
+        FlagField<1020> r = ff.slice(13, 64);
+        assert(r.isSet(0, 63));
+        assert(r.numSetFlags() == 2);
+        r = ff.slice(76, 424);
+        assert(r.isSet(0));
+        assert(r.numSetFlags() == 1);
+        r = ff.slice(76, 425);
+        assert(r.isSet(0, 424));
+        assert(r.numSetFlags() == 2);
+        r = ff.slice(0, 0);
+        assert(r.isNSet());
+    }
+    {   std::cout << "Testing concat()" << std::endl;
+        FlagField<MAX_FLAG, StdFlags> a(INITALIZED, FULLSCREEN), b(ERROR);
+        FlagField<MAX_FLAG * 2> c = concat(a, b);
+        assert(c.isSet(INITALIZED, FULLSCREEN, MAX_FLAG + ERROR));
+        assert(c.numSetFlags() == 3);
+
+        FlagField<100> d(0, 99);
+        FlagField<200> e = concat(d, d);
+        assert(e.isSet(0, 99, 100, 199));
+        assert(e.numSetFlags() == 4);
+    }
+    {   std::cout << "Testing resize()" << std::endl;
+        FlagField<MAX_FLAG, StdFlags> a(ERROR, FULLSCREEN);
+        FlagField<4, StdFlags> small = a.resize<4>();
+        assert(small.isSet(ERROR));
+        assert(small.numSetFlags() == 1);
+        FlagField<300, StdFlags> big = a.resize<300>();
+        assert(big.isSet(ERROR, FULLSCREEN));
+        assert(big.numSetFlags() == 2);
+    }
+    {   std::cout << "Testing insertAt()" << std::endl;
+        FlagField<256> ff;
+        ff.set();
+        FlagField<70> ins(0, 69);
+        ff.insertAt(60, ins);
+        assert(ff.isSet(59, 60, 129, 130));
+        assert(ff.isNSet(61, 100, 128));
+        assert(ff.numSetFlags() == 256 - 68);
+    }
+}
+
+void test_check_policies() {
+    std::cout << "Testing validation policies..." << std::endl;
+    {   std::cout << "Testing FlagCheck::Ignore" << std::endl;
+        FlagField<10, size_t, FlagCheck::Ignore> ff;
+        ff.set(3, 10, 100);
+        assert(ff.isSet(3));
+        assert(ff.isSet(10) == false);
+        assert(ff.numSetFlags() == 1);
+    }
+    {   std::cout << "Testing FlagCheck::Throw" << std::endl;
+        FlagField<10, size_t, FlagCheck::Throw> ff;
+        bool thrown = false;
+        try { ff.set(10); } catch (const std::out_of_range&) { thrown = true; }
+        assert(thrown);
+        assert(ff.isNSet());
+        ff.set(9);
+        assert(ff.isSet(9));
+    }
+    {   std::cout << "Testing policy conversions" << std::endl;
+        FlagField<MAX_FLAG, StdFlags, FlagCheck::Throw> checked(ERROR, FULLSCREEN);
+        FlagField<MAX_FLAG, StdFlags, FlagCheck::Unchecked> unchecked = checked;
+        assert(unchecked.isSet(ERROR, FULLSCREEN));
+        assert(unchecked.numSetFlags() == 2);
+
+        assert(checked.inRange(CLOSED));
+        auto copy = checked.as<FlagCheck::Unchecked>();
+        copy.set(CLOSED);
+        assert(copy.isSet(ERROR, FULLSCREEN, CLOSED));
+        assert(!checked.isSet(CLOSED));
+        checked = copy;
+        assert(checked.isSet(CLOSED));
+
+        FlagField<MAX_FLAG * 2, size_t, FlagCheck::Throw> both = concat(checked, unchecked);
+        assert(both.numSetFlags() == 5);
+    }
+}
+
 void run_all_tests() {
     test_constructors();
     test_functions();
     test_unary_operators();
     test_binary_operators();
     test_bytefield_conversion();
+    test_slicing();
+    test_check_policies();
     std::cout << "All tests passed!" << std::endl;
 }
 
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+
+#define FLAGFIELD_NO_VALIDATE
+#include <FlagRemap.hpp>
+
+typedef enum FlagsV1 {
+    V1_INITALIZED,
+    V1_ERROR,
+    V1_CLOSED,
+    V1_SHOULD_CLOSE,
+    V1_UNUSED,
+    V1_MINIMIZED,
+    V1_MAX
+} FlagsV1;
+
+typedef enum FlagsV2 {
+    V2_ERROR,
+    V2_INITALIZED,
+    V2_CLOSED,
+    V2_SHOULD_CLOSE,
+    V2_MINIMIZED,
+    V2_FULLSCREEN,
+    V2_MAX
+} FlagsV2;
+
+void test_small_remap() {
+    std::cout << "Testing small enum remap..." << std::endl;
+    FlagRemap<V1_MAX, FlagsV1, V2_MAX, FlagsV2> remap = {
+        { V1_INITALIZED, V2_INITALIZED },
+        { V1_ERROR, V2_ERROR },
+        { V1_CLOSED, V2_CLOSED },
+        { V1_SHOULD_CLOSE, V2_SHOULD_CLOSE },
+        { V1_MINIMIZED, V2_MINIMIZED },
+    };
+    FlagField<V1_MAX, FlagsV1> old(V1_INITALIZED, V1_UNUSED, V1_MINIMIZED);
+    FlagField<V2_MAX, FlagsV2> x = remap(old);
+    std::cout << "\t" << old << " -> " << x << std::endl;
+    assert(x.isSet(V2_INITALIZED, V2_MINIMIZED));
+    assert(x.isNSet(V2_ERROR, V2_FULLSCREEN));
+    assert(x.numSetFlags() == 2);
+
+    old.set();
+    x = remap(old);
+    assert(x.numSetFlags() == 5);
+    assert(x.isNSet(V2_FULLSCREEN));
+}
+
+void test_large_remap() {
+    std::cout << "Testing large remap with reordering across words..." << std::endl;
+    // Reverse 200 flags into a 300 flag layout, shifted up by 50
+    std::vector<std::pair<size_t, size_t>> table;
+    for (size_t i = 0; i < 200; i++) table.emplace_back(i, 249 - i);
+    FlagRemap<200, size_t, 300, size_t> remap(table.data(), table.size());
+
+    FlagField<200> old;
+    for (size_t i = 0; i < 200; i += 7) old.set(i);
+    FlagField<300> x = remap(old);
+    for (size_t i = 0; i < 200; i++) assert(old.isSet(i) == x.isSet(249 - i));
+    assert(x.numSetFlags() == old.numSetFlags());
+}
+
+void test_batch_remap() {
+    std::cout << "Testing batch remap of persisted bytes..." << std::endl;
+    std::vector<std::pair<size_t, size_t>> table;
+    for (size_t i = 0; i < 70; i++) table.emplace_back(i, i < 35 ? i + 1 : i + 10);
+    FlagRemap<70, size_t, 90, size_t> remap(table.data(), table.size());
+
+    const size_t n = 100;
+    std::vector<FlagField<70>> olds(n);
+    for (size_t i = 0; i < n; i++) olds[i].set(i % 70, (i * 13) % 70);
+    std::vector<uint8_t> in(n * olds[0].sizeBytes());
+    for (size_t i = 0; i < n; i++) {
+        std::memcpy(&in[i * olds[0].sizeBytes()], *olds[i], olds[i].sizeBytes());
+    }
+
+    std::vector<FlagField<90>> outs(n);
+    std::vector<uint8_t> out(n * outs[0].sizeBytes());
+    remap.applyBytes(in.data(), out.data(), n);
+    remap.apply(olds.data(), outs.data(), n);
+    for (size_t i = 0; i < n; i++) {
+        assert(std::memcmp(&out[i * outs[i].sizeBytes()], *outs[i], outs[i].sizeBytes()) == 0);
+        for (size_t f = 0; f < 70; f++) {
+            assert(olds[i].isSet(f) == outs[i].isSet(f < 35 ? f + 1 : f + 10));
+        }
+        assert(outs[i].numSetFlags() == olds[i].numSetFlags());
+    }
+}
+
+void test_one_to_many_remap() {
+    std::cout << "Testing one flag mapped to several..." << std::endl;
+    // A -> X, A -> Z, B -> Y, with A and B set
+    const std::pair<size_t, size_t> small[] = { {0, 0}, {0, 2}, {1, 1} };
+    FlagRemap<2, size_t, 4, size_t> remap(small, 3);
+    FlagField<2> old(0, 1);
+    FlagField<4> x = remap(old);
+    std::cout << "\t" << old << " -> " << x << std::endl;
+    assert(x.isSet(0, 1, 2) && !x.isSet(3) && x.numSetFlags() == 3);
+
+    // Every flag fanned out three times, across words
+    std::vector<std::pair<size_t, size_t>> table;
+    for (size_t i = 0; i < 100; i++) {
+        table.emplace_back(i, i);
+        table.emplace_back(i, 299 - i);
+        table.emplace_back(i, 100 + (i * 37) % 100);
+    }
+    FlagRemap<100, size_t, 300, size_t> fan(table.data(), table.size());
+    FlagField<100> wide;
+    for (size_t i = 0; i < 100; i += 3) wide.set(i);
+    FlagField<300> y = fan(wide);
+    for (size_t i = 0; i < 100; i++) {
+        assert(y.isSet(i) == wide.isSet(i));
+        assert(y.isSet(299 - i) == wide.isSet(i));
+        assert(y.isSet(100 + (i * 37) % 100) == wide.isSet(i));
+    }
+    assert(y.numSetFlags() == 3 * wide.numSetFlags());
+}
+
+void run_all_tests() {
+    test_small_remap();
+    test_large_remap();
+    test_batch_remap();
+    test_one_to_many_remap();
+    std::cout << "All tests passed!" << std::endl;
+}
+
+int main() {
+#if defined(__BMI2__) && (defined(__GNUC__) || defined(__clang__))
+    // The FlagRemap_BMI2_Tests build: skip on CPUs without PEXT/PDEP
+    if (!__builtin_cpu_supports("bmi2")) {
+        std::cout << "Skipped: the CPU lacks BMI2" << std::endl;
+        return 0;
+    }
+#endif
+    auto start = std::chrono::system_clock::now();
+    run_all_tests();
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Elapsed time: " << elapsed.count() << " microseconds" << std::endl;
+    return 0;
+}